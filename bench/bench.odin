@@ -0,0 +1,440 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// Generates synthetic C headers of different sizes and measures how long every phase of runic
+// takes for them. The scaling exponent between two sizes shows how a phase grows with the size
+// of the headers (1 = linear, 2 = quadratic).
+package bench
+
+import "core:flags"
+import "core:fmt"
+import "core:math"
+import "core:os"
+import "core:path/filepath"
+import "core:slice"
+import "core:strconv"
+import "core:strings"
+import "core:time"
+import cppcdg "root:cpp/codegen"
+import odincdg "root:odin/codegen"
+import "root:runic"
+
+Phase :: enum {
+    Parse,
+    Visit,
+    Postprocess,
+    Preprocess,
+    Cross,
+    Bindings,
+    Serialize,
+}
+
+PHASE_NAMES :: [Phase]string {
+    .Parse       = "parse",
+    .Visit       = "visit",
+    .Postprocess = "postprocess",
+    .Preprocess  = "to_preprocess",
+    .Cross       = "cross",
+    .Bindings    = "bindings",
+    .Serialize   = "serialize",
+}
+
+BENCH_PLATFORMS :: [?]runic.Platform {
+    {.Linux, .x86_64},
+    {.Windows, .x86_64},
+    {.Macos, .arm64},
+    {.Linux, .arm64},
+    {.Windows, .x86},
+    {.Macos, .x86_64},
+    {.Linux, .x86},
+    {.Linux, .arm32},
+}
+
+DEFAULT_SIZES :: "1000,5000,20000,50000,100000,200000"
+DEFAULT_PLATFORMS :: "1,4"
+DEFAULT_OUT_DIR :: "build/bench"
+
+// Exponents above this are reported as likely quadratic
+SUSPICIOUS_EXPONENT :: 1.5
+
+Result :: struct {
+    size:      int,
+    plats:     int,
+    durations: [Phase]time.Duration,
+}
+
+main :: proc() {
+    args: struct {
+        sizes:
+        string `args:"name=sizes" usage:"Comma separated amounts of declarations (default: 1000,5000,20000,50000,100000,200000)"`,
+        platforms:
+        string `args:"name=platforms" usage:"Comma separated amounts of platforms (default: 1,4)"`,
+        mix:
+        string `args:"name=mix" usage:"Relative amount of every kind of declaration (default: structs=3,unions=1,enums=1,typedefs=2,func_ptrs=1,anons=1,macros=2,functions=3)"`,
+        out_dir:
+        string `args:"name=out-dir" usage:"Directory into which the headers and runes are generated (default: build/bench)"`,
+        header_only:
+        bool `args:"name=header-only" usage:"Only generate the headers and runes without measuring"`,
+    }
+    flags.parse_or_exit(&args, os.args, .Unix)
+
+    if len(args.sizes) == 0 do args.sizes = DEFAULT_SIZES
+    if len(args.platforms) == 0 do args.platforms = DEFAULT_PLATFORMS
+    if len(args.mix) == 0 do args.mix = DEFAULT_MIX
+    if len(args.out_dir) == 0 do args.out_dir = DEFAULT_OUT_DIR
+
+    sizes := parse_int_list(args.sizes)
+    plat_counts := parse_int_list(args.platforms)
+    if sizes == nil || plat_counts == nil {
+        fmt.eprintln(
+            "sizes and platforms need to be comma separated positive integers",
+        )
+        os.exit(1)
+    }
+    for count in plat_counts {
+        if count > len(BENCH_PLATFORMS) {
+            fmt.eprintfln(
+                "at most {} platforms are supported",
+                len(BENCH_PLATFORMS),
+            )
+            os.exit(1)
+        }
+    }
+
+    mix, mix_ok := parse_mix(args.mix)
+    if !mix_ok {
+        fmt.eprintfln("invalid mix \"{}\"", args.mix)
+        os.exit(1)
+    }
+
+    out_dir := args.out_dir
+    if !filepath.is_abs(out_dir) {
+        cwd := os.get_current_directory()
+        out_dir = filepath.join({cwd, out_dir})
+    }
+    if !os.is_dir(out_dir) {
+        if err := os.make_directory(out_dir); err != nil {
+            fmt.eprintfln("failed to create \"{}\": {}", out_dir, err)
+            os.exit(1)
+        }
+    }
+
+    results := make([dynamic]Result)
+
+    for size in sizes {
+        header_name := fmt.aprintf("bench_{}.h", size)
+        if !write_header_file(
+            filepath.join({out_dir, header_name}),
+            counts_from_mix(size, mix),
+        ) {
+            os.exit(1)
+        }
+
+        for plat_count in plat_counts {
+            rune_file_name := filepath.join(
+                {out_dir, fmt.aprintf("bench_{}_{}.yml", size, plat_count)},
+            )
+            if !write_rune_file(
+                rune_file_name,
+                header_name,
+                size,
+                plat_count,
+            ) {
+                os.exit(1)
+            }
+
+            if args.header_only do continue
+
+            fmt.eprintfln(
+                "Measuring {} declarations on {} platforms ...",
+                size,
+                plat_count,
+            )
+            result, ok := measure(rune_file_name)
+            if !ok do os.exit(1)
+            result.size = size
+            result.plats = plat_count
+
+            append(&results, result)
+            free_all(context.temp_allocator)
+        }
+    }
+
+    if !args.header_only do print_results(results[:])
+}
+
+// Runs all phases of runic on the rune and measures the time of every phase
+measure :: proc(rune_file_name: string) -> (result: Result, ok: bool) {
+    rune_file, os_err := os.open(rune_file_name)
+    if os_err != nil {
+        fmt.eprintfln("failed to open \"{}\": {}", rune_file_name, os_err)
+        return
+    }
+    defer os.close(rune_file)
+
+    rune, rune_err := runic.parse_rune(
+        os.stream_from_handle(rune_file),
+        rune_file_name,
+    )
+    defer runic.rune_destroy(&rune)
+    if rune_err != nil {
+        fmt.eprintfln("failed to parse rune: {}", rune_err)
+        return
+    }
+
+    from := rune.from.(runic.From)
+    to := rune.to.(runic.To)
+
+    runestones := make([dynamic]runic.Runestone, context.temp_allocator)
+    file_paths := make([dynamic]string, context.temp_allocator)
+    defer for &rs in runestones {
+        runic.runestone_destroy(&rs)
+    }
+
+    start: time.Tick = ---
+    for plat in rune.platforms {
+        p: cppcdg.Parser
+        defer cppcdg.parser_destroy(&p)
+        if err := cppcdg.parser_init(&p, plat, rune_file_name, from);
+           err != nil {
+            fmt.eprintfln("failed to initialize parser: {}", err)
+            return
+        }
+
+        start = time.tick_now()
+        if err := cppcdg.parser_parse(&p); err != nil {
+            fmt.eprintfln("failed to parse: {}", err)
+            return
+        }
+        result.durations[.Parse] += time.tick_since(start)
+
+        start = time.tick_now()
+        rs, rs_err := cppcdg.parser_runestone(&p)
+        if rs_err != nil {
+            fmt.eprintfln("failed to create runestone: {}", rs_err)
+            runic.runestone_destroy(&rs)
+            return
+        }
+        result.durations[.Visit] += time.tick_since(start)
+
+        start = time.tick_now()
+        runic.from_postprocess_runestone(&rs, from)
+        result.durations[.Postprocess] += time.tick_since(start)
+
+        start = time.tick_now()
+        serialized: strings.Builder
+        strings.builder_init(&serialized, context.temp_allocator)
+        runic.write_runestone(
+            rs,
+            strings.to_writer(&serialized),
+            rune_file_name,
+        )
+        result.durations[.Serialize] += time.tick_since(start)
+
+        append(&runestones, rs)
+        append(&file_paths, fmt.tprintf("/{}.{}", plat.os, plat.arch))
+    }
+
+    start = time.tick_now()
+    for &rs in runestones {
+        runic.to_preprocess_runestone(&rs, to, odincdg.ODIN_RESERVED)
+    }
+    result.durations[.Preprocess] = time.tick_since(start)
+
+    start = time.tick_now()
+    rc, rc_err := runic.cross_the_runes(
+        file_paths[:],
+        runestones[:],
+        to.extern.sources,
+    )
+    if rc_err != nil {
+        fmt.eprintfln("failed to cross the runes: {}", rc_err)
+        return
+    }
+    defer runic.runecross_destroy(&rc, len(runestones) > 1)
+    result.durations[.Cross] = time.tick_since(start)
+
+    start = time.tick_now()
+    bindings: strings.Builder
+    strings.builder_init(&bindings, context.temp_allocator)
+    if err := odincdg.generate_bindings(
+        rc,
+        to,
+        rune.platforms,
+        strings.to_writer(&bindings),
+        runic.relative_to_file(rune_file_name, to.out, context.temp_allocator),
+    ); err != nil {
+        fmt.eprintfln("failed to generate bindings: {}", err)
+        return
+    }
+    result.durations[.Bindings] = time.tick_since(start)
+
+    ok = true
+    return
+}
+
+print_results :: proc(results: []Result) {
+    phase_names := PHASE_NAMES
+
+    fmt.println()
+    fmt.printf("{:>8s} {:>6s}", "size", "plats")
+    for name in phase_names {
+        fmt.printf(" {:>13s}", name)
+    }
+    fmt.println()
+
+    for r in results {
+        fmt.printf("{:>8d} {:>6d}", r.size, r.plats)
+        for d in r.durations {
+            fmt.printf(" {:>11.2f}ms", time.duration_milliseconds(d))
+        }
+        fmt.println()
+    }
+
+    // Scaling exponents between consecutive sizes with the same amount of platforms
+    fmt.println("\nScaling exponents (1 = linear, 2 = quadratic):")
+    fmt.printf("{:>17s} {:>6s}", "sizes", "plats")
+    for name in phase_names {
+        fmt.printf(" {:>13s}", name)
+    }
+    fmt.println()
+
+    suspicious: [dynamic]string
+    defer delete(suspicious)
+
+    for r, idx in results {
+        prev_idx := -1
+        #reverse for other, p_idx in results[:idx] {
+            if other.plats == r.plats {
+                prev_idx = p_idx
+                break
+            }
+        }
+        if prev_idx == -1 do continue
+        prev := results[prev_idx]
+
+        fmt.printf(
+            "{:>17s} {:>6d}",
+            fmt.tprintf("{}->{}", prev.size, r.size),
+            r.plats,
+        )
+        for phase in Phase {
+            exp := scaling_exponent(
+                prev.size,
+                prev.durations[phase],
+                r.size,
+                r.durations[phase],
+            )
+            mark := " "
+            if exp > SUSPICIOUS_EXPONENT {
+                mark = "!"
+                append(
+                    &suspicious,
+                    fmt.tprintf(
+                        "{} ({} -> {} declarations, {} platforms): {:.2f}",
+                        phase_names[phase],
+                        prev.size,
+                        r.size,
+                        r.plats,
+                        exp,
+                    ),
+                )
+            }
+            fmt.printf(" {:>12.2f}{}", exp, mark)
+        }
+        fmt.println()
+    }
+
+    if len(suspicious) != 0 {
+        fmt.println("\nPhases that grow faster than linear:")
+        for s in suspicious {
+            fmt.println("  ", s)
+        }
+    }
+}
+
+scaling_exponent :: proc(
+    size_a: int,
+    dur_a: time.Duration,
+    size_b: int,
+    dur_b: time.Duration,
+) -> f64 {
+    if size_a == size_b || dur_a <= 0 || dur_b <= 0 do return 0
+    dur_ratio := f64(dur_b) / f64(dur_a)
+    size_ratio := f64(size_b) / f64(size_a)
+    return math.ln(dur_ratio) / math.ln(size_ratio)
+}
+
+write_header_file :: proc(file_name: string, counts: [DeclKind]int) -> bool {
+    header: strings.Builder
+    strings.builder_init(&header, context.temp_allocator)
+    write_header(strings.to_writer(&header), counts)
+
+    if !os.write_entire_file(file_name, header.buf[:]) {
+        fmt.eprintfln("failed to write \"{}\"", file_name)
+        return false
+    }
+    return true
+}
+
+write_rune_file :: proc(
+    rune_file_name: string,
+    header_name: string,
+    size: int,
+    plat_count: int,
+) -> bool {
+    rn: strings.Builder
+    strings.builder_init(&rn, context.temp_allocator)
+
+    fmt.sbprintln(&rn, "version: 0")
+    fmt.sbprintln(&rn, "platforms:")
+    bench_plats := BENCH_PLATFORMS
+    for plat in bench_plats[:plat_count] {
+        fmt.sbprintfln(&rn, "  - {} {}", plat.os, plat.arch)
+    }
+    fmt.sbprintln(&rn, "from:")
+    fmt.sbprintln(&rn, "  language: c")
+    fmt.sbprintln(&rn, "  shared: libbench.so")
+    fmt.sbprintfln(&rn, "  headers: {}", header_name)
+    fmt.sbprintln(&rn, "to:")
+    fmt.sbprintln(&rn, "  language: odin")
+    fmt.sbprintln(&rn, "  package: bench")
+    fmt.sbprintfln(&rn, "  out: bench_{}_{}.odin", size, plat_count)
+
+    if !os.write_entire_file(rune_file_name, rn.buf[:]) {
+        fmt.eprintfln("failed to write \"{}\"", rune_file_name)
+        return false
+    }
+    return true
+}
+
+parse_int_list :: proc(list: string) -> []int {
+    values := make([dynamic]int)
+
+    str := list
+    for value_str in strings.split_iterator(&str, ",") {
+        value, ok := strconv.parse_int(strings.trim_space(value_str))
+        if !ok || value <= 0 {
+            delete(values)
+            return nil
+        }
+        append(&values, value)
+    }
+
+    slice.sort(values[:])
+    return values[:]
+}
@@ -0,0 +1,217 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package bench
+
+import "core:fmt"
+import "core:io"
+import "core:strconv"
+import "core:strings"
+
+DeclKind :: enum {
+    Structs,
+    Unions,
+    Enums,
+    Typedefs,
+    FuncPtrs,
+    Anons,
+    Macros,
+    Functions,
+}
+
+DECL_KIND_NAMES :: [DeclKind]string {
+    .Structs   = "structs",
+    .Unions    = "unions",
+    .Enums     = "enums",
+    .Typedefs  = "typedefs",
+    .FuncPtrs  = "func_ptrs",
+    .Anons     = "anons",
+    .Macros    = "macros",
+    .Functions = "functions",
+}
+
+// The relative amount of every kind of declaration
+Mix :: [DeclKind]int
+
+DEFAULT_MIX :: "structs=3,unions=1,enums=1,typedefs=2,func_ptrs=1,anons=1,macros=2,functions=3"
+
+// Parses a mix of the form "structs=3,unions=1,..."
+parse_mix :: proc(mix_str: string) -> (mix: Mix, ok: bool) {
+    str := mix_str
+    for entry in strings.split_iterator(&str, ",") {
+        eq_idx := strings.index_byte(entry, '=')
+        if eq_idx == -1 do return
+
+        name := strings.trim_space(entry[:eq_idx])
+        value := strconv.parse_int(
+            strings.trim_space(entry[eq_idx + 1:]),
+        ) or_return
+        if value < 0 do return
+
+        kind_names := DECL_KIND_NAMES
+        found: bool
+        for kind_name, kind in kind_names {
+            if kind_name == name {
+                mix[kind] = value
+                found = true
+                break
+            }
+        }
+        if !found do return
+    }
+
+    ok = true
+    return
+}
+
+// Distributes size declarations over the kinds of declarations according to mix
+counts_from_mix :: proc(size: int, mix: Mix) -> (counts: [DeclKind]int) {
+    total: int
+    for weight in mix do total += weight
+    if total == 0 do return
+
+    assigned: int
+    for weight, kind in mix {
+        counts[kind] = size * weight / total
+        assigned += counts[kind]
+    }
+    // The remainder goes to the structs, since they are the most common declarations
+    counts[.Structs] += size - assigned
+
+    return
+}
+
+// Writes a C header containing the given amount of declarations.
+// Types refer to previously declared types, so that the dependency sorting has something to do.
+write_header :: proc(wd: io.Writer, counts: [DeclKind]int) {
+    fmt.wprintln(wd, "#pragma once\n")
+    fmt.wprintln(wd, "#include <stddef.h>")
+    fmt.wprintln(wd, "#include <stdint.h>\n")
+
+    for i in 0 ..< counts[.Macros] {
+        switch i % 3 {
+        case 0:
+            fmt.wprintfln(wd, "#define BENCH_MACRO_{} ({} * 2 + 1)", i, i)
+        case 1:
+            fmt.wprintfln(wd, "#define BENCH_MACRO_{} \"macro {}\"", i, i)
+        case 2:
+            fmt.wprintfln(wd, "#define BENCH_MACRO_{} {}.5", i, i)
+        }
+    }
+    io.write_rune(wd, '\n')
+
+    num_enums := max(counts[.Enums], 1)
+    for i in 0 ..< num_enums {
+        fmt.wprintfln(
+            wd,
+            "typedef enum bench_enum_{0} {{ BENCH_ENUM_{0}_A, BENCH_ENUM_{0}_B = {0}, BENCH_ENUM_{0}_C }} bench_enum_{0};",
+            i,
+        )
+    }
+    io.write_rune(wd, '\n')
+
+    num_structs := max(counts[.Structs], 1)
+    for i in 0 ..< num_structs {
+        fmt.wprintf(
+            wd,
+            "typedef struct bench_struct_{0} {{ int32_t a; float b; const char* name; bench_enum_{1} e; ",
+            i,
+            i % num_enums,
+        )
+        if i != 0 {
+            fmt.wprintf(wd, "struct bench_struct_{} prev; ", i - 1)
+        }
+        // Pointer to a type that is only declared later
+        fmt.wprintfln(
+            wd,
+            "struct bench_struct_{1}* next; }} bench_struct_{0};",
+            i,
+            (i + 1) % num_structs,
+        )
+    }
+    io.write_rune(wd, '\n')
+
+    for i in 0 ..< counts[.Unions] {
+        fmt.wprintfln(
+            wd,
+            "typedef union bench_union_{0} {{ int64_t i; double d; bench_struct_{1} s; }} bench_union_{0};",
+            i,
+            i % num_structs,
+        )
+    }
+    io.write_rune(wd, '\n')
+
+    // Every typedef is part of a chain of three typedefs
+    for i in 0 ..< counts[.Typedefs] {
+        if i % 3 == 0 {
+            fmt.wprintfln(
+                wd,
+                "typedef bench_struct_{} bench_typedef_{};",
+                i % num_structs,
+                i,
+            )
+        } else {
+            fmt.wprintfln(
+                wd,
+                "typedef bench_typedef_{} bench_typedef_{};",
+                i - 1,
+                i,
+            )
+        }
+    }
+    io.write_rune(wd, '\n')
+
+    for i in 0 ..< counts[.FuncPtrs] {
+        fmt.wprintfln(
+            wd,
+            "typedef int (*bench_callback_{})(bench_struct_{}* s, bench_enum_{} e, void* user_data);",
+            i,
+            i % num_structs,
+            i % num_enums,
+        )
+    }
+    io.write_rune(wd, '\n')
+
+    for i in 0 ..< counts[.Anons] {
+        fmt.wprintfln(
+            wd,
+            "typedef struct bench_nested_{0} {{ struct {{ int x; union {{ float f; int i; }} u; }} inner; struct {{ double d; bench_struct_{1}* s; }} arr[4]; }} bench_nested_{0};",
+            i,
+            i % num_structs,
+        )
+    }
+    io.write_rune(wd, '\n')
+
+    for i in 0 ..< counts[.Functions] {
+        if counts[.FuncPtrs] != 0 {
+            fmt.wprintfln(
+                wd,
+                "int bench_function_{}(bench_struct_{}* s, bench_callback_{} cb, size_t count);",
+                i,
+                i % num_structs,
+                i % counts[.FuncPtrs],
+            )
+        } else {
+            fmt.wprintfln(
+                wd,
+                "int bench_function_{}(bench_struct_{}* s, size_t count);",
+                i,
+                i % num_structs,
+            )
+        }
+    }
+}
@@ -0,0 +1,159 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// Buffers the output of jobs running on different threads (e.g. one job per
+// platform), so that it can be printed in a deterministic order once all jobs
+// have finished. Every line written into a buffer is prefixed with the tag of
+// its job. Threads that have not begun a buffer print straight to stderr.
+package console
+
+import "core:bytes"
+import "core:fmt"
+import "core:io"
+import "core:os"
+import "core:strings"
+
+Buffer :: struct {
+    tag:        string,
+    builder:    strings.Builder,
+    line_start: bool,
+}
+
+@(private, thread_local)
+current: ^Buffer
+
+buffer_init :: proc(
+    b: ^Buffer,
+    tag: string,
+    allocator := context.allocator,
+) {
+    b.tag = strings.clone(tag, allocator)
+    strings.builder_init(&b.builder, allocator)
+    b.line_start = true
+}
+
+buffer_destroy :: proc(b: ^Buffer) {
+    delete(b.tag, b.builder.buf.allocator)
+    strings.builder_destroy(&b.builder)
+    b^ = {}
+}
+
+// Redirects the output of the calling thread into b
+// The returned buffer needs to be passed to end
+begin :: proc(b: ^Buffer) -> (prev: ^Buffer) {
+    prev = current
+    current = b
+    return
+}
+
+end :: proc(prev: ^Buffer) {
+    current = prev
+}
+
+// Returns the buffer of the calling thread or nil if it prints to stderr
+current_buffer :: proc() -> ^Buffer {
+    return current
+}
+
+// Returns the writer of the buffer of the calling thread or stderr
+writer :: proc() -> io.Writer {
+    if current == nil do return os.stream_from_handle(os.stderr)
+    return buffer_writer(current)
+}
+
+buffer_writer :: proc(b: ^Buffer) -> io.Writer {
+    return io.Stream {
+        procedure = proc(
+            stream_data: rawptr,
+            mode: io.Stream_Mode,
+            p: []byte,
+            offset: i64,
+            whence: io.Seek_From,
+        ) -> (
+            n: i64,
+            err: io.Error,
+        ) {
+            #partial switch mode {
+            case .Write:
+                buffer_write(cast(^Buffer)stream_data, p)
+                return i64(len(p)), .None
+            case .Query:
+                return io.query_utility({.Write, .Query})
+            }
+            return 0, .Empty
+        },
+        data = b,
+    }
+}
+
+@(private = "file")
+buffer_write :: proc(b: ^Buffer, p: []byte) {
+    rest := p
+    for len(rest) != 0 {
+        if b.line_start {
+            if len(b.tag) != 0 {
+                strings.write_byte(&b.builder, '[')
+                strings.write_string(&b.builder, b.tag)
+                strings.write_string(&b.builder, "] ")
+            }
+            b.line_start = false
+        }
+
+        nl := bytes.index_byte(rest, '\n')
+        if nl == -1 {
+            strings.write_bytes(&b.builder, rest)
+            return
+        }
+
+        strings.write_bytes(&b.builder, rest[:nl + 1])
+        rest = rest[nl + 1:]
+        b.line_start = true
+    }
+}
+
+// Writes the contents of b into the buffer of the calling thread or to stderr
+// if the calling thread has not begun a buffer. b is cleared afterwards.
+// The contents have already been tagged and are not tagged again
+flush :: proc(b: ^Buffer) {
+    if strings.builder_len(b.builder) == 0 do return
+
+    if current != nil && current != b {
+        strings.write_string(&current.builder, strings.to_string(b.builder))
+        current.line_start = b.line_start
+    } else {
+        os.write_string(os.stderr, strings.to_string(b.builder))
+    }
+
+    strings.builder_reset(&b.builder)
+    b.line_start = true
+}
+
+eprint :: proc(args: ..any, sep := " ") -> int {
+    return fmt.wprint(writer(), ..args, sep = sep)
+}
+
+eprintln :: proc(args: ..any, sep := " ") -> int {
+    return fmt.wprintln(writer(), ..args, sep = sep)
+}
+
+eprintf :: proc(format: string, args: ..any) -> int {
+    return fmt.wprintf(writer(), format, ..args)
+}
+
+eprintfln :: proc(format: string, args: ..any) -> int {
+    return fmt.wprintfln(writer(), format, ..args)
+}
@@ -0,0 +1,54 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package console
+
+import "core:strings"
+import "core:testing"
+
+@(test)
+test_console_buffer :: proc(t: ^testing.T) {
+    using testing
+
+    a, b: Buffer
+    buffer_init(&a, "Linux.x86_64")
+    defer buffer_destroy(&a)
+    buffer_init(&b, "Linux.x86_64")
+    defer buffer_destroy(&b)
+
+    prev := begin(&a)
+    eprintfln("Parsing \"{}\" ...", "foo.h")
+    eprint("first ")
+    eprintln("second")
+
+    prev_b := begin(&b)
+    eprintln("from b")
+    end(prev_b)
+
+    eprintln("last")
+    flush(&b)
+    end(prev)
+
+    expect(t, current_buffer() == nil)
+
+    expect_value(
+        t,
+        strings.to_string(a.builder),
+        "[Linux.x86_64] Parsing \"foo.h\" ...\n[Linux.x86_64] first second\n[Linux.x86_64] last\n[Linux.x86_64] from b\n",
+    )
+    expect_value(t, strings.builder_len(b.builder), 0)
+}
@@ -0,0 +1,413 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package cpp_codegen
+
+import "base:runtime"
+import "core:crypto/hash"
+import "core:encoding/hex"
+import "core:fmt"
+import "core:io"
+import "core:os"
+import "core:path/filepath"
+import "core:slice"
+import "core:strings"
+import "root:errors"
+import "root:runic"
+import clang "shared:libclang"
+
+// Needs to be increased whenever the generated runestones or the layout of the cache change
+RUNESTONE_CACHE_VERSION :: 2
+
+// The library is not part of the cached runestone, since it is set from the rune after loading
+@(private = "file")
+CACHE_LIB_PLACEHOLDER :: "runic-cache"
+
+// The cache consists of two kinds of files:
+// <key>.manifest: lists every file that has been included together with the hash of its contents
+// <object>.runestone: the generated runestone in the binary encoding where object is the hash of the key and the manifest
+// The key only covers what is known before parsing (rune, clang flags, libclang version).
+// The included files are only known after parsing which is why they are stored in the manifest.
+@(private)
+runestone_cache_key :: proc(
+    p: ^Parser,
+    allocator := context.allocator,
+) -> string {
+    plat, rf := p.plat, p.rf
+
+    // The directory of the system includes is named after the hash of their contents, which is why it also
+    // invalidates the cache when they change. The files inside of it are not part of the manifest
+    key_stdinc_gen_dir: Maybe(string)
+    if !p.enable_host_includes && !p.disable_system_include_gen {
+        key_stdinc_gen_dir = system_includes_gen_dir(allocator)
+    }
+
+    clang_flags := generate_clang_flags(
+        plat,
+        p.disable_stdint_macros,
+        p.defines,
+        p.include_dirs,
+        p.enable_host_includes,
+        key_stdinc_gen_dir,
+        p.flags,
+        allocator,
+    )
+    defer delete(clang_flags)
+
+    ctx: hash.Context
+    hash.init(&ctx, .SHA256)
+    wd := hash_writer(&ctx)
+
+    clang_version := clang.getClangVersion()
+    defer clang.disposeString(clang_version)
+
+    fmt.wprintfln(wd, "runic-cache={}", RUNESTONE_CACHE_VERSION)
+    fmt.wprintfln(wd, "libclang={:q}", clang_str(clang_version))
+    fmt.wprintfln(wd, "platform={}.{}", plat.os, plat.arch)
+    fmt.wprintfln(wd, "rune={:q}", p.rune_file_name)
+    fmt.wprintfln(wd, "language={:q}", rf.language)
+
+    write_key_list(wd, "headers", p.headers)
+
+    ignore := runic.platform_value_get(runic.IgnoreSet, rf.ignore, plat)
+    write_key_list(wd, "ignore.constants", ignore.constants)
+    write_key_list(wd, "ignore.functions", ignore.functions)
+    write_key_list(wd, "ignore.variables", ignore.variables)
+    write_key_list(wd, "ignore.types", ignore.types)
+
+    write_key_list(wd, "extern", rf.extern)
+
+    load_all_includes := runic.platform_value_get(
+        bool,
+        rf.load_all_includes,
+        plat,
+    )
+    fmt.wprintfln(wd, "load_all_includes={}", load_all_includes)
+    fmt.wprintfln(wd, "umbrella={}", p.umbrella)
+
+    if forward_decl_type, ok := runic.platform_value_get(
+        runic.Type,
+        rf.forward_decl_type,
+        plat,
+    ); ok {
+        io.write_string(wd, "forward_decl_type=")
+        runic.write_type(wd, forward_decl_type)
+        io.write_rune(wd, '\n')
+    }
+
+    fmt.wprintfln(wd, "flags={}", len(clang_flags))
+    for flag in clang_flags {
+        fmt.wprintfln(wd, "{:q}", flag)
+    }
+
+    return hash_final_hex(&ctx, allocator)
+}
+
+// Loads the runestone of key from the cache. It is only loaded if all files that have been included
+// when the runestone was generated are still the same. Those files are appended to dependencies if it is set
+@(private)
+load_cached_runestone :: proc(
+    cache_dir: string,
+    key: string,
+    plat: runic.Platform,
+    rf: runic.From,
+    dependencies: ^[dynamic]string = nil,
+) -> (
+    rs: runic.Runestone,
+    ok: bool,
+) {
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    if runtime.arena_init(&arena, 0, context.allocator) != .None do return
+    arena_alloc := runtime.arena_allocator(&arena)
+
+    manifest_path := filepath.join(
+        {cache_dir, strings.concatenate({key, ".manifest"}, arena_alloc)},
+        arena_alloc,
+    )
+    manifest := os.read_entire_file(manifest_path, arena_alloc) or_return
+
+    manifest_str := string(manifest)
+    for line in strings.split_lines_iterator(&manifest_str) {
+        if len(line) == 0 do continue
+
+        space_idx := strings.index_byte(line, ' ')
+        if space_idx == -1 do return
+
+        content_hash, file_name := line[:space_idx], line[space_idx + 1:]
+        current_hash := hash_file_hex(file_name, arena_alloc) or_return
+        if current_hash != content_hash do return
+    }
+
+    object := cache_object_name(key, manifest, arena_alloc)
+    object_path := filepath.join(
+        {cache_dir, strings.concatenate({object, ".runestone"}, arena_alloc)},
+        arena_alloc,
+    )
+
+    if !os.is_file(object_path) do return
+
+    rs_err: errors.Error = ---
+    rs, rs_err = runic.load_runestone(object_path)
+    if rs_err != nil {
+        runic.runestone_destroy(&rs)
+        return
+    }
+
+    rs.lib = {}
+    runic.set_library(plat, &rs, rf)
+
+    if dependencies != nil {
+        manifest_str = string(manifest)
+        for line in strings.split_lines_iterator(&manifest_str) {
+            if len(line) == 0 do continue
+
+            file_name := line[strings.index_byte(line, ' ') + 1:]
+            append(
+                dependencies,
+                strings.clone(file_name, dependencies.allocator),
+            )
+        }
+    }
+
+    ok = true
+    return
+}
+
+// Stores the runestone of key together with a manifest of all files that have been included by units
+@(private)
+store_cached_runestone :: proc(
+    cache_dir: string,
+    key: string,
+    rs: runic.Runestone,
+    units: []clang.TranslationUnit,
+    stdinc_gen_dir: Maybe(string),
+    unsaved_files: []clang.UnsavedFile,
+) -> (
+    err: errors.Error,
+) {
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    errors.wrap(runtime.arena_init(&arena, 0, context.allocator)) or_return
+    arena_alloc := runtime.arena_allocator(&arena)
+
+    errors.wrap(make_directory_parents(cache_dir)) or_return
+
+    included_files := included_files_of_units(
+        units,
+        stdinc_gen_dir,
+        unsaved_files,
+        arena_alloc,
+    )
+
+    manifest: strings.Builder
+    strings.builder_init(&manifest, arena_alloc)
+
+    for file_name in included_files {
+        content_hash, ok := hash_file_hex(file_name, arena_alloc)
+        errors.wrap(ok, "failed to hash included file") or_return
+
+        strings.write_string(&manifest, content_hash)
+        strings.write_rune(&manifest, ' ')
+        strings.write_string(&manifest, file_name)
+        strings.write_rune(&manifest, '\n')
+    }
+
+    object := cache_object_name(key, manifest.buf[:], arena_alloc)
+    object_path := filepath.join(
+        {cache_dir, strings.concatenate({object, ".runestone"}, arena_alloc)},
+        arena_alloc,
+    )
+
+    cached_rs := rs
+    cached_rs.lib = {
+        shared = CACHE_LIB_PLACEHOLDER,
+    }
+
+    rs_contents: strings.Builder
+    strings.builder_init(&rs_contents, arena_alloc)
+    errors.wrap(
+        runic.write_runestone_binary(
+            cached_rs,
+            strings.to_writer(&rs_contents),
+            object_path,
+        ),
+    ) or_return
+
+    // The runestone needs to be written first, since the manifest is used to look it up
+    runic.write_file_atomic(
+        object_path,
+        rs_contents.buf[:],
+        arena_alloc,
+    ) or_return
+
+    manifest_path := filepath.join(
+        {cache_dir, strings.concatenate({key, ".manifest"}, arena_alloc)},
+        arena_alloc,
+    )
+    runic.write_file_atomic(
+        manifest_path,
+        manifest.buf[:],
+        arena_alloc,
+    ) or_return
+
+    return
+}
+
+// Returns the sorted file paths of all files that have been included by units, except the system include placeholders
+// and the unsaved files which only exist in memory
+@(private)
+included_files_of_units :: proc(
+    units: []clang.TranslationUnit,
+    stdinc_gen_dir: Maybe(string),
+    unsaved_files: []clang.UnsavedFile,
+    allocator := context.allocator,
+) -> []string {
+    InclusionData :: struct {
+        files:          map[string]struct{},
+        stdinc_gen_dir: Maybe(string),
+        unsaved_files:  []clang.UnsavedFile,
+        allocator:      runtime.Allocator,
+    }
+
+    data := InclusionData {
+        files          = make(map[string]struct{}, allocator = allocator),
+        stdinc_gen_dir = stdinc_gen_dir,
+        unsaved_files  = unsaved_files,
+        allocator      = allocator,
+    }
+
+    for unit in units {
+        if unit == nil do continue
+
+        clang.getInclusions(
+            unit,
+            proc "c" (
+                included_file: clang.File,
+                inclusion_stack: ^clang.SourceLocation,
+                include_len: u32,
+                client_data: clang.ClientData,
+            ) {
+                context = runtime.default_context()
+                data := cast(^InclusionData)client_data
+
+                file_name_clang := clang.getFileName(included_file)
+                defer clang.disposeString(file_name_clang)
+                file_name := clang_str(file_name_clang)
+
+                if len(file_name) == 0 do return
+                // The system include placeholders are generated into a different directory on every run
+                if gen_dir, ok := data.stdinc_gen_dir.?; ok {
+                    if strings.has_prefix(file_name, gen_dir) do return
+                }
+                for unsaved in data.unsaved_files {
+                    if file_name == string(unsaved.Filename) do return
+                }
+
+                if file_name not_in data.files {
+                    data.files[strings.clone(file_name, data.allocator)] = {}
+                }
+            },
+            &data,
+        )
+    }
+
+    files := make([]string, len(data.files), allocator)
+    idx: int
+    for file_name in data.files {
+        files[idx] = file_name
+        idx += 1
+    }
+    slice.sort(files)
+
+    return files
+}
+
+@(private = "file")
+cache_object_name :: proc(
+    key: string,
+    manifest: []byte,
+    allocator := context.allocator,
+) -> string {
+    ctx: hash.Context
+    hash.init(&ctx, .SHA256)
+    hash.update(&ctx, transmute([]byte)key)
+    hash.update(&ctx, manifest)
+    return hash_final_hex(&ctx, allocator)
+}
+
+@(private = "file")
+hash_file_hex :: proc(
+    file_name: string,
+    allocator := context.allocator,
+) -> (
+    string,
+    bool,
+) {
+    contents, ok := os.read_entire_file(file_name)
+    if !ok do return "", false
+    defer delete(contents)
+
+    ctx: hash.Context
+    hash.init(&ctx, .SHA256)
+    hash.update(&ctx, contents)
+    return hash_final_hex(&ctx, allocator), true
+}
+
+@(private = "file")
+hash_final_hex :: proc(
+    ctx: ^hash.Context,
+    allocator := context.allocator,
+) -> string {
+    digest: [32]byte
+    hash.final(ctx, digest[:])
+    return string(hex.encode(digest[:], allocator))
+}
+
+@(private = "file")
+hash_writer :: proc(ctx: ^hash.Context) -> io.Writer {
+    return io.Stream {
+        procedure = proc(
+            stream_data: rawptr,
+            mode: io.Stream_Mode,
+            p: []byte,
+            offset: i64,
+            whence: io.Seek_From,
+        ) -> (
+            n: i64,
+            err: io.Error,
+        ) {
+            #partial switch mode {
+            case .Write:
+                hash.update(cast(^hash.Context)stream_data, p)
+                return i64(len(p)), .None
+            case .Query:
+                return io.query_utility({.Write, .Query})
+            }
+            return 0, .Empty
+        },
+        data = ctx,
+    }
+}
+
+@(private = "file")
+write_key_list :: proc(wd: io.Writer, name: string, values: []string) {
+    fmt.wprintfln(wd, "{}={}", name, len(values))
+    for value in values {
+        fmt.wprintfln(wd, "{:q}", value)
+    }
+}
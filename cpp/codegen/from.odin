@@ -18,17 +18,29 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 package cpp_codegen
 
 import "base:runtime"
+import "core:c"
 import "core:fmt"
 import "core:os"
 import "core:path/filepath"
 import "core:strconv"
 import "core:strings"
+import "core:thread"
 import "core:unicode"
+import "root:console"
 import "root:errors"
 import om "root:ordered_map"
 import "root:runic"
+import "root:stats"
+import "root:trace"
 import clang "shared:libclang"
 
+// Name of the umbrella file which includes all headers, when they are parsed as one translation unit.
+// It only exists in memory and is placed next to the rune
+UMBRELLA_FILE_NAME :: "runic_umbrella.h"
+
+// Name of the file which is parsed to evaluate the macros. It only exists in memory and is placed next to the rune
+MACRO_FILE_NAME :: "runic_macros.c"
+
 @(private = "file")
 Macro :: struct {
     def:    string,
@@ -52,6 +64,8 @@ ParseContext :: struct {
     load_all_includes: bool,
     extern:            []string,
     main_file_name:    string,
+    umbrella_headers:  map[string]string,
+    umbrella_files:    map[clang.File]string,
     rs:                ^runic.Runestone,
     types:             ^om.OrderedMap(string, runic.Type),
     included_types:    ^map[string]IncludedType,
@@ -62,111 +76,511 @@ ParseContext :: struct {
     forward_decls:     ^[dynamic]string,
     allocator:         runtime.Allocator,
     err:               errors.Error,
+    cursors_visited:   int,
 }
 
+// Holds the libclang state of one platform. The translation units are kept alive,
+// so that they can be reparsed when the headers change (e.g. in watch mode).
+// If umbrella is set, all headers are parsed as one translation unit of the umbrella file
+Parser :: struct {
+    plat:                       runic.Platform,
+    rune_file_name:             string,
+    rf:                         runic.From,
+    arena:                      runtime.Arena,
+    disable_stdint_macros:      bool,
+    enable_host_includes:       bool,
+    disable_system_include_gen: bool,
+    defines:                    map[string]string,
+    include_dirs:               []string,
+    flags:                      []cstring,
+    headers:                    []string,
+    umbrella:                   bool,
+    umbrella_file_name:         string,
+    // Number of threads used to parse the headers
+    jobs:                       int,
+    unsaved_files:              []clang.UnsavedFile,
+    stdinc_gen_dir:             Maybe(string),
+    clang_flags:                [dynamic]cstring,
+    index:                      clang.Index,
+    units:                      [dynamic]clang.TranslationUnit,
+    had_errors:                 bool,
+}
+
+// If dependencies is set, all files that have been included by the headers are appended to it (allocated using its allocator).
+// The headers are parsed using up to `jobs` threads
 generate_runestone :: proc(
     plat: runic.Platform,
     rune_file_name: string,
     rf: runic.From,
+    cache_dir: Maybe(string) = nil,
+    dependencies: ^[dynamic]string = nil,
+    jobs := 1,
 ) -> (
     rs: runic.Runestone,
     err: errors.Error,
 ) {
-    if !filepath.is_abs(rune_file_name) do return rs, errors.message("Internal Error: rune_file_name (\"{}\") needs to be absolute for cpp_codegen.generate_runestone", rune_file_name)
+    p: Parser
+    defer parser_destroy(&p)
+    parser_init(&p, plat, rune_file_name, rf) or_return
+    p.jobs = jobs
+
+    cache_key: string
+    if dir, ok := cache_dir.?; ok {
+        cache_key = runestone_cache_key(&p, runtime.arena_allocator(&p.arena))
+
+        if cached_rs, hit := load_cached_runestone(
+            dir,
+            cache_key,
+            plat,
+            rf,
+            dependencies,
+        ); hit {
+            console.eprintfln(
+                "Loaded runestone {}.{} from cache",
+                plat.os,
+                plat.arch,
+            )
+            return cached_rs, nil
+        }
+    }
 
-    rs_arena_alloc := runic.init_runestone(&rs)
+    parser_parse(&p) or_return
+    rs = parser_runestone(&p) or_return
+
+    if dependencies != nil {
+        for dep in parser_dependencies(&p, runtime.arena_allocator(&p.arena)) {
+            append(dependencies, strings.clone(dep, dependencies.allocator))
+        }
+    }
+
+    // Runestones of headers with errors are not cached, since the errors may come from missing files
+    if dir, ok := cache_dir.?; ok && !p.had_errors {
+        if cache_err := store_cached_runestone(
+            dir,
+            cache_key,
+            rs,
+            p.units[:],
+            p.stdinc_gen_dir,
+            p.unsaved_files,
+        ); cache_err != nil {
+            console.eprintfln(
+                "warning: failed to store runestone {}.{} in cache: {}",
+                plat.os,
+                plat.arch,
+                cache_err,
+            )
+        }
+    }
+
+    return
+}
+
+// Reads all values of the rune that are needed to parse the headers of plat. Nothing is parsed yet
+parser_init :: proc(
+    p: ^Parser,
+    plat: runic.Platform,
+    rune_file_name: string,
+    rf: runic.From,
+) -> (
+    err: errors.Error,
+) {
+    if !filepath.is_abs(rune_file_name) do return errors.message("Internal Error: rune_file_name (\"{}\") needs to be absolute for cpp_codegen.generate_runestone", rune_file_name)
 
-    rs.platform = plat
-    runic.set_library(plat, &rs, rf)
+    p.plat = plat
+    p.rune_file_name = rune_file_name
+    p.rf = rf
+
+    errors.wrap(runtime.arena_init(&p.arena, 0, context.allocator)) or_return
+    arena_alloc := runtime.arena_allocator(&p.arena)
 
     disable_stdint_macros, dsm_ok := runic.platform_value_get(
         bool,
         rf.disable_stdint_macros,
         plat,
     )
-    disable_stdint_macros = dsm_ok && disable_stdint_macros
+    p.disable_stdint_macros = dsm_ok && disable_stdint_macros
 
-    rune_defines, rd_ok := runic.platform_value_get(
+    rd_ok: bool = ---
+    p.defines, rd_ok = runic.platform_value_get(
         map[string]string,
         rf.defines,
         plat,
     )
-    if !rd_ok do rune_defines = make(map[string]string, allocator = rs_arena_alloc)
+    if !rd_ok do p.defines = make(map[string]string, allocator = arena_alloc)
 
-    include_dirs, inc_ok := runic.platform_value_get(
+    inc_ok: bool = ---
+    p.include_dirs, inc_ok = runic.platform_value_get(
         []string,
         rf.includedirs,
         plat,
     )
-    if !inc_ok do include_dirs = make([]string, 0, rs_arena_alloc)
-
-    // Generate system includes as empty files just for placeholders
-    stdinc_gen_dir: Maybe(string)
-    defer if gen_dir, ok := stdinc_gen_dir.?; ok {
-        delete_system_includes(gen_dir)
-    }
+    if !inc_ok do p.include_dirs = make([]string, 0, arena_alloc)
 
     enable_host_includes, hinc_ok := runic.platform_value_get(
         bool,
         rf.enable_host_includes,
         plat,
     )
-    enable_host_includes = hinc_ok && enable_host_includes
+    p.enable_host_includes = hinc_ok && enable_host_includes
 
     disable_system_include_gen, dsysinc_ok := runic.platform_value_get(
         bool,
         rf.disable_system_include_gen,
         plat,
     )
-    disable_system_include_gen = dsysinc_ok && disable_system_include_gen
+    p.disable_system_include_gen =
+        dsysinc_ok && disable_system_include_gen
+
+    flag_ok: bool = ---
+    p.flags, flag_ok = runic.platform_value_get([]cstring, rf.flags, plat)
+    if !flag_ok do p.flags = make([]cstring, 0, arena_alloc)
+
+    p.headers = runic.platform_value_get([]string, rf.headers, plat)
+
+    // A single header does not need an umbrella
+    umbrella, umbrella_ok := runic.platform_value_get(bool, rf.umbrella, plat)
+    p.umbrella = umbrella_ok && umbrella && len(p.headers) > 1
+
+    if p.umbrella {
+        p.umbrella_file_name = filepath.join(
+            {filepath.dir(rune_file_name, arena_alloc), UMBRELLA_FILE_NAME},
+            arena_alloc,
+        )
+
+        p.unsaved_files = make([]clang.UnsavedFile, 1, arena_alloc)
+        p.unsaved_files[0] = umbrella_unsaved_file(
+            p.umbrella_file_name,
+            p.headers,
+            arena_alloc,
+        )
+    } else {
+        p.unsaved_files = make([]clang.UnsavedFile, 0, arena_alloc)
+    }
+
+    return
+}
 
-    flags, flag_ok := runic.platform_value_get([]cstring, rf.flags, plat)
-    if !flag_ok do flags = make([]cstring, 0, rs_arena_alloc)
+// Parses all headers. If they have already been parsed, they are reparsed which reuses the state of libclang
+parser_parse :: proc(p: ^Parser) -> (err: errors.Error) {
+    if p.index != nil do return parser_reparse(p)
 
-    if !enable_host_includes {
-        if !disable_system_include_gen {
+    arena_alloc := runtime.arena_allocator(&p.arena)
+
+    // Generate system includes as empty files just for placeholders. They are reused by every platform and run
+    if !p.enable_host_includes {
+        if !p.disable_system_include_gen {
             stdinc_gen_dir_ok: bool = ---
-            stdinc_gen_dir, stdinc_gen_dir_ok = system_includes_gen_dir(
-                plat,
-                rs_arena_alloc,
+            p.stdinc_gen_dir, stdinc_gen_dir_ok = system_includes_gen_dir(
+                arena_alloc,
             )
 
             if stdinc_gen_dir_ok {
-                if !generate_system_includes(stdinc_gen_dir.?) {
-                    fmt.eprintfln(
+                trace.scope("generate system includes")
+                if !generate_system_includes(p.stdinc_gen_dir.?) {
+                    console.eprintfln(
                         "FATAL: failed to generate system includes for platform {}.{} into \"{}\"",
-                        plat.os,
-                        plat.arch,
-                        stdinc_gen_dir,
+                        p.plat.os,
+                        p.plat.arch,
+                        p.stdinc_gen_dir,
                     )
 
-                    stdinc_gen_dir = nil
+                    p.stdinc_gen_dir = nil
                 }
             } else {
-                stdinc_gen_dir = nil
-                fmt.eprintfln(
-                    "FATAL: failed to create temporary directory for system includes for platform {}.{}",
-                    plat.os,
-                    plat.arch,
+                p.stdinc_gen_dir = nil
+                console.eprintfln(
+                    "FATAL: failed to create directory for system includes for platform {}.{}",
+                    p.plat.os,
+                    p.plat.arch,
                 )
             }
         }
     }
 
-    clang_flags := generate_clang_flags(
-        plat,
-        disable_stdint_macros,
-        rune_defines,
-        include_dirs,
-        enable_host_includes,
-        stdinc_gen_dir,
-        flags,
-        rs_arena_alloc,
+
+    p.clang_flags = generate_clang_flags(
+        p.plat,
+        p.disable_stdint_macros,
+        p.defines,
+        p.include_dirs,
+        p.enable_host_includes,
+        p.stdinc_gen_dir,
+        p.flags,
+        arena_alloc,
+    )
+
+    when ODIN_DEBUG {
+        console.eprint("clang flags: ")
+        for flag in p.clang_flags {
+            console.eprintf("\"{}\" ", flag)
+        }
+        console.eprintln()
+    }
+
+    p.index = clang.createIndex(0, 0)
+    p.units = make(
+        [dynamic]clang.TranslationUnit,
+        1 if p.umbrella else len(p.headers),
+    )
+    p.had_errors = false
+
+    return parse_units(p)
+}
+
+@(private = "file")
+parser_reparse :: proc(p: ^Parser) -> (err: errors.Error) {
+    p.had_errors = false
+    return parse_units(p)
+}
+
+@(private = "file")
+UnitTask :: struct {
+    p:   ^Parser,
+    idx: int,
+    log: console.Buffer,
+    err: errors.Error,
+}
+
+// Parses or reparses all translation units using up to p.jobs threads. libclang allows to parse distinct
+// translation units of one index concurrently. The output of every unit is buffered and printed
+// together with its diagnostics in the order of the headers afterwards
+@(private = "file")
+parse_units :: proc(p: ^Parser) -> (err: errors.Error) {
+    tasks := make([]UnitTask, len(p.units))
+    defer delete(tasks)
+
+    // The units are tagged like the output of the calling thread (e.g. with the platform)
+    caller_log := console.current_buffer()
+    tag := caller_log.tag if caller_log != nil else ""
+
+    for &task, idx in tasks {
+        task.p = p
+        task.idx = idx
+        console.buffer_init(&task.log, tag)
+    }
+    defer for &task in tasks {
+        console.buffer_destroy(&task.log)
+    }
+
+    thread_count := min(p.jobs, len(tasks))
+    if thread_count <= 1 {
+        for &task in tasks {
+            parse_unit_task(&task)
+        }
+    } else {
+        pool: thread.Pool
+        thread.pool_init(&pool, context.allocator, thread_count)
+        defer thread.pool_destroy(&pool)
+
+        for &unit_task, idx in tasks {
+            thread.pool_add_task(
+                &pool,
+                context.allocator,
+                proc(task: thread.Task) {
+                    parse_unit_task(cast(^UnitTask)task.data)
+                },
+                &unit_task,
+                idx,
+            )
+        }
+
+        thread.pool_start(&pool)
+        thread.pool_finish(&pool)
+    }
+
+    for &task, idx in tasks {
+        console.flush(&task.log)
+        if task.err != nil {
+            if err == nil do err = task.err
+            continue
+        }
+        report_diagnostics(p, p.units[idx])
+    }
+
+    return
+}
+
+@(private = "file")
+parse_unit_task :: proc(task: ^UnitTask) {
+    prev_log := console.begin(&task.log)
+    defer console.end(prev_log)
+
+    p := task.p
+    unit := &p.units[task.idx]
+    header := p.umbrella_file_name if p.umbrella else p.headers[task.idx]
+
+    if unit^ != nil {
+        console.eprintfln("Reparsing \"{}\" ...", header)
+        trace.scope("reparseTranslationUnit", header)
+
+        if clang.reparseTranslationUnit(
+               unit^,
+               u32(len(p.unsaved_files)),
+               raw_data(p.unsaved_files),
+               clang.defaultReparseOptions(unit^),
+           ) ==
+           0 {
+            return
+        }
+
+        // A translation unit can not be used anymore after reparsing failed
+        clang.disposeTranslationUnit(unit^)
+        unit^ = nil
+    }
+
+    if p.umbrella {
+        unit^, task.err = parse_umbrella(p)
+    } else {
+        unit^, task.err = parse_header(p, header)
+    }
+}
+
+@(private = "file")
+parse_header :: proc(
+    p: ^Parser,
+    header: string,
+) -> (
+    unit: clang.TranslationUnit,
+    err: errors.Error,
+) {
+    check_header_file(header) or_return
+
+    console.eprintfln("Parsing \"{}\" ...", header)
+    trace.scope("parseTranslationUnit", header)
+
+    return parse_unit(p, header)
+}
+
+// Parses the umbrella file as one translation unit, so that files included by multiple headers are only parsed once
+@(private = "file")
+parse_umbrella :: proc(
+    p: ^Parser,
+) -> (
+    unit: clang.TranslationUnit,
+    err: errors.Error,
+) {
+    for header in p.headers {
+        check_header_file(header) or_return
+    }
+
+    console.eprintfln(
+        "Parsing {} headers as one translation unit ...",
+        len(p.headers),
+    )
+    trace.scope("parseTranslationUnit", p.umbrella_file_name)
+
+    return parse_unit(p, p.umbrella_file_name)
+}
+
+@(private = "file")
+parse_unit :: proc(
+    p: ^Parser,
+    file_name: string,
+) -> (
+    unit: clang.TranslationUnit,
+    err: errors.Error,
+) {
+    file_name_cstr := strings.clone_to_cstring(file_name)
+
+    unit = clang.parseTranslationUnit(
+        p.index,
+        file_name_cstr,
+        raw_data(p.clang_flags),
+        i32(len(p.clang_flags)),
+        raw_data(p.unsaved_files),
+        u32(len(p.unsaved_files)),
+        .DetailedPreprocessingRecord | .SkipFunctionBodies,
     )
-    defer delete(clang_flags)
+    delete(file_name_cstr)
+
+    if unit == nil {
+        err = errors.message(
+            "\"{}\" failed to parse translation unit",
+            file_name,
+        )
+    }
+
+    return
+}
+
+@(private = "file")
+check_header_file :: proc(header: string) -> errors.Error {
+    dealloc_me, os_stat := os.stat(header)
+    #partial switch stat in os_stat {
+    case os.General_Error:
+        if stat == .Not_Exist {
+            return errors.message(
+                "failed to find header file: \"{}\"",
+                header,
+            )
+        }
+        return errors.message(
+            "failed to open header file \"{}\": {}",
+            header,
+            stat,
+        )
+    case nil:
+        os.file_info_delete(dealloc_me)
+    case:
+        return errors.message(
+            "failed to open header file \"{}\": {}",
+            header,
+            stat,
+        )
+    }
+
+    return nil
+}
+
+@(private = "file")
+report_diagnostics :: proc(p: ^Parser, unit: clang.TranslationUnit) {
+    if print_diagnostics(console.writer(), unit) {
+        p.had_errors = true
+        console.eprintln(
+            "Errors occurred. The resulting runestone can not be trusted! Make sure to fix the errors accordingly. If system includes can not be found you can check this page for help: https://github.com/Samudevv/runic/wiki#how-system-include-files-are-handled",
+        )
+    }
+}
+
+// Returns the in-memory umbrella file which includes all headers
+@(private = "file")
+umbrella_unsaved_file :: proc(
+    file_name: string,
+    headers: []string,
+    allocator := context.allocator,
+) -> clang.UnsavedFile {
+    contents: strings.Builder
+    strings.builder_init(&contents, allocator)
+
+    // The headers are included by their absolute paths, since the umbrella is not placed into the working directory
+    for header in headers {
+        include := umbrella_header_key(header, allocator)
+        fmt.sbprintfln(&contents, "#include \"{}\"", include)
+    }
+
+    return {
+        Filename = strings.clone_to_cstring(file_name, allocator),
+        Contents = strings.clone_to_cstring(
+            strings.to_string(contents),
+            allocator,
+        ),
+        Length = c.ulong(strings.builder_len(contents)),
+    }
+}
+
+// Creates a runestone out of the parsed headers
+parser_runestone :: proc(
+    p: ^Parser,
+) -> (
+    rs: runic.Runestone,
+    err: errors.Error,
+) {
+    rs_arena_alloc := runic.init_runestone(&rs)
+
+    rs.platform = p.plat
+    runic.set_library(p.plat, &rs, p.rf)
 
-    headers := runic.platform_value_get([]string, rf.headers, plat)
-    ignore := runic.platform_value_get(runic.IgnoreSet, rf.ignore, plat)
+    ignore := runic.platform_value_get(runic.IgnoreSet, p.rf.ignore, p.plat)
 
     included_types := make(map[string]IncludedType)
     defer delete(included_types)
@@ -179,21 +593,21 @@ generate_runestone :: proc(
 
     load_all_includes := runic.platform_value_get(
         bool,
-        rf.load_all_includes,
-        plat,
+        p.rf.load_all_includes,
+        p.plat,
     )
 
     forward_decl_type := runic.platform_value_get(
         runic.Type,
-        rf.forward_decl_type,
-        plat,
+        p.rf.forward_decl_type,
+        p.plat,
     )
 
     // Add stdinc gen dir to externs
-    extern := rf.extern
-    if add_extern, ok := stdinc_gen_dir.?; ok {
+    extern := p.rf.extern
+    if add_extern, ok := p.stdinc_gen_dir.?; ok {
         arr := system_includes_gen_extern(
-            rf.extern,
+            p.rf.extern,
             add_extern,
             rs_arena_alloc,
         )
@@ -205,7 +619,7 @@ generate_runestone :: proc(
     defer delete(forward_decls)
 
     ctx := ParseContext {
-        rune_file_name    = rune_file_name,
+        rune_file_name    = p.rune_file_name,
         load_all_includes = load_all_includes,
         extern            = extern[:],
         rs                = &rs,
@@ -213,101 +627,45 @@ generate_runestone :: proc(
         included_types    = &included_types,
         included_anons    = &included_anons,
         macros            = &macros,
-        int_sizes         = int_sizes_from_platform(plat),
+        int_sizes         = int_sizes_from_platform(p.plat),
         anon_index        = &anon_index,
         forward_decls     = &forward_decls,
         allocator         = rs_arena_alloc,
     }
     context.user_ptr = &ctx
+    defer stats.add_cursors_visited(p.plat, ctx.cursors_visited)
 
-    index := clang.createIndex(0, 0)
-    defer clang.disposeIndex(index)
-    units := make(
-        [dynamic]clang.TranslationUnit,
-        len = len(headers),
-        cap = len(headers),
-    )
-    defer delete(units)
-    defer for unit in units {
-        clang.disposeTranslationUnit(unit)
-    }
-
-    when ODIN_DEBUG {
-        fmt.eprint("clang flags: ")
-        for flag in clang_flags {
-            fmt.eprintf("\"{}\" ", flag)
-        }
-        fmt.eprintln()
-    }
+    // The headers are not the main file of the umbrella, which is why the cursors are attributed to the headers by their file
+    if p.umbrella {
+        ctx.umbrella_headers = make(map[string]string, len(p.headers))
+        ctx.umbrella_files = make(map[clang.File]string)
 
-    for header in headers {
-        dealloc_me, os_stat := os.stat(header)
-        #partial switch stat in os_stat {
-        case os.General_Error:
-            if stat == .Not_Exist {
-                err = errors.message(
-                    "failed to find header file: \"{}\"",
-                    header,
-                )
-                return
-            }
-            err = errors.message(
-                "failed to open header file \"{}\": {}",
+        for header in p.headers {
+            key := umbrella_header_key(header, rs_arena_alloc)
+            ctx.umbrella_headers[key] = header_main_file_name(
+                p.rune_file_name,
                 header,
-                stat,
-            )
-            return
-        case nil:
-            os.file_info_delete(dealloc_me)
-        case:
-            err = errors.message(
-                "failed to open header file \"{}\": {}",
-                header,
-                stat,
+                rs_arena_alloc,
             )
-            return
         }
+    }
+    defer delete(ctx.umbrella_headers)
+    defer delete(ctx.umbrella_files)
 
-        fmt.eprintfln("Parsing \"{}\" ...", header)
-
-        header_cstr := strings.clone_to_cstring(header)
+    for unit, idx in p.units {
+        header := p.umbrella_file_name if p.umbrella else p.headers[idx]
+        trace.scope("visit translation unit", header)
 
-        unit := clang.parseTranslationUnit(
-            index,
-            header_cstr,
-            raw_data(clang_flags),
-            i32(len(clang_flags)),
-            nil,
-            0,
-            .DetailedPreprocessingRecord | .SkipFunctionBodies,
-        )
-        delete(header_cstr)
+        cursor := clang.getTranslationUnitCursor(unit)
 
-        if unit == nil {
-            err = errors.message(
-                "\"{}\" failed to parse translation unit",
+        if !p.umbrella {
+            ctx.main_file_name = header_main_file_name(
+                p.rune_file_name,
                 header,
-            )
-            return
-        }
-
-        append(&units, unit)
-
-        if print_diagnostics(os.stderr, unit) {
-            fmt.eprintln(
-                "Errors occurred. The resulting runestone can not be trusted! Make sure to fix the errors accordingly. If system includes can not be found you can check this page for help: https://github.com/Samudevv/runic/wiki#how-system-include-files-are-handled",
+                rs_arena_alloc,
             )
         }
 
-        cursor := clang.getTranslationUnitCursor(unit)
-
-        rel_main_file_name, rel_main_ok := runic.absolute_to_file(
-            rune_file_name,
-            header,
-            rs_arena_alloc,
-        )
-        ctx.main_file_name = rel_main_file_name if rel_main_ok else header
-
         clang.visitChildren(
             cursor,
             proc "c" (
@@ -317,10 +675,11 @@ generate_runestone :: proc(
                 context = runtime.default_context()
                 context.user_ptr = client_data
                 ctx := ps()
+                ctx.cursors_visited += 1
 
                 cursor_location := clang.getCursorLocation(cursor)
 
-                if !clang.Location_isFromMainFile(cursor_location) {
+                if !location_is_from_main(ctx, cursor_location) {
                     if !parse_cursor_not_from_main(cursor) do return .Continue
                 }
 
@@ -344,7 +703,7 @@ generate_runestone :: proc(
                 case .MacroExpansion, .InclusionDirective:
                 // Ignore
                 case:
-                    fmt.eprintln(
+                    console.eprintln(
                         clang_source_error(
                             cursor,
                             fmt.aprintf(
@@ -357,7 +716,7 @@ generate_runestone :: proc(
                 }
 
                 if ctx.err != nil {
-                    fmt.eprintln(ctx.err, "\n")
+                    console.eprintln(ctx.err, "\n")
                     ctx.err = nil
                 }
 
@@ -376,249 +735,432 @@ generate_runestone :: proc(
 
     runic.ignore_types(&rs.types, ignore)
 
-    parse_unknowns(forward_decl_type, rf.extern)
+    {
+        trace.scope("parse_unknowns")
+        parse_unknowns(forward_decl_type, p.rf.extern)
+    }
 
     runic.ignore_types(&rs.types, ignore)
 
     // Remove all types that are they same inside of the externs
     // If a type is Untyped then the same type of the externs takes
     // precedence
-    for entry in rs.externs.data {
-        name := entry.key
-        if om.contains(rs.types, name) {
-            om.delete_key(&rs.types, name)
-        }
+    extern_names := make(
+        []string,
+        om.length(rs.externs),
+        context.temp_allocator,
+    )
+    for entry, idx in rs.externs.data {
+        extern_names[idx] = entry.key
     }
+    om.delete_keys(&rs.types, extern_names)
 
     // Handle Macros
     if om.length(macros) != 0 {
-        macro_file_name: string = ---
-        {
-            macro_file: os.Handle = ---
-            macro_file_err: errors.Error = ---
-            macro_file, macro_file_name, macro_file_err = temp_file()
-            if macro_file_err != nil {
-                err = errors.message(
-                    "failed to create macro file: {}",
-                    macro_file_err,
-                )
-                return
-            }
-            defer os.close(macro_file)
+        trace.scope("parse macros", om.length(macros), " macros")
+        err = evaluate_macros(p, &ctx, macros)
+    }
 
-            stringify_name, stringify2_name: strings.Builder
-            strings.builder_init(&stringify_name)
-            strings.builder_init(&stringify2_name)
-            defer strings.builder_destroy(&stringify_name)
-            defer strings.builder_destroy(&stringify2_name)
+    return
+}
 
-            strings.write_rune(&stringify_name, 'S')
-            strings.write_string(&stringify2_name, "SS")
+@(private = "file")
+MacroDecl :: struct {
+    name:     string,
+    evaluate: bool,
+}
 
-            for om.contains(macros, strings.to_string(stringify_name)) {
-                strings.write_rune(&stringify_name, '_')
-            }
-            for om.contains(macros, strings.to_string(stringify2_name)) {
-                strings.write_rune(&stringify2_name, '_')
-            }
+@(private = "file")
+MacroAlias :: struct {
+    name:  string,
+    value: string,
+}
+
+@(private = "file")
+MacroEvaluation :: struct {
+    ctx:     ^ParseContext,
+    // Maps the variables declared in the macro file to their macros
+    decls:   map[string]MacroDecl,
+    // The macro of the string literal that is visited next
+    current: string,
+    // Macros whose values could be the name of a symbol or a type
+    aliases: [dynamic]MacroAlias,
+}
+
+// Turns the object-like macros into constants. An in-memory macro file is parsed using the index of p,
+// which declares two variables per macro. The first one is initialized with the stringified macro
+// which is used for strings, characters and aliases to symbols and types. The second one is evaluated
+// by libclang and takes precedence for numbers. Macros that can not be evaluated keep their stringification.
+// Aliases are resolved after all macros have been visited
+@(private = "file")
+evaluate_macros :: proc(
+    p: ^Parser,
+    ctx: ^ParseContext,
+    macros: om.OrderedMap(string, Macro),
+) -> (
+    err: errors.Error,
+) {
+    arena: runtime.Arena
+    errors.wrap(runtime.arena_init(&arena, 0, context.allocator)) or_return
+    defer runtime.arena_destroy(&arena)
+    arena_alloc := runtime.arena_allocator(&arena)
+
+    data := MacroEvaluation {
+        ctx     = ctx,
+        decls   = make(map[string]MacroDecl, allocator = arena_alloc),
+        aliases = make([dynamic]MacroAlias, arena_alloc),
+    }
+
+    macro_source: strings.Builder
+    strings.builder_init(&macro_source, arena_alloc)
+
+    stringify_name, stringify2_name: strings.Builder
+    strings.builder_init(&stringify_name, arena_alloc)
+    strings.builder_init(&stringify2_name, arena_alloc)
+
+    strings.write_rune(&stringify_name, 'S')
+    strings.write_string(&stringify2_name, "SS")
+
+    for om.contains(macros, strings.to_string(stringify_name)) {
+        strings.write_rune(&stringify_name, '_')
+    }
+    for om.contains(macros, strings.to_string(stringify2_name)) {
+        strings.write_rune(&stringify2_name, '_')
+    }
 
-            fmt.fprintf(
-                macro_file,
-                `#define {}(X) #X
+    fmt.sbprintf(
+        &macro_source,
+        `#define {}(X) #X
 #define {}(X) {}(X)
 `,
-                strings.to_string(stringify2_name),
-                strings.to_string(stringify_name),
-                strings.to_string(stringify2_name),
-            )
+        strings.to_string(stringify2_name),
+        strings.to_string(stringify_name),
+        strings.to_string(stringify2_name),
+    )
 
-            for entry in macros.data {
-                name, macro := entry.key, entry.value
+    for entry in macros.data {
+        name, macro := entry.key, entry.value
 
-                fmt.fprintfln(macro_file, "#define {} {}", name, macro.def)
-            }
+        fmt.sbprintfln(&macro_source, "#define {} {}", name, macro.def)
+    }
 
-            first_macro_written := false
-            for entry in macros.data {
-                name, macro := entry.key, entry.value
-                if macro.func || macro.extern || len(macro.def) == 0 do continue
+    for entry in macros.data {
+        name, macro := entry.key, entry.value
+        if macro.func || macro.extern || len(macro.def) == 0 do continue
+
+        string_name := macro_decl_name(macros, 'R', name, arena_alloc)
+        value_name := macro_decl_name(macros, 'E', name, arena_alloc)
+        data.decls[string_name] = {name, false}
+        data.decls[value_name] = {name, true}
+
+        fmt.sbprintfln(
+            &macro_source,
+            "const char*{}={}({});",
+            string_name,
+            strings.to_string(stringify_name),
+            name,
+        )
+        fmt.sbprintfln(
+            &macro_source,
+            "__auto_type {}=({});",
+            value_name,
+            name,
+        )
+    }
 
-                prefix_name := strings.concatenate({"R", name}, rs_arena_alloc)
-                for om.contains(macros, prefix_name) {
-                    prefix_name = strings.concatenate(
-                        {"_", prefix_name},
-                        rs_arena_alloc,
-                    )
+    macro_file_name := filepath.join(
+        {filepath.dir(p.rune_file_name, arena_alloc), MACRO_FILE_NAME},
+        arena_alloc,
+    )
+    macro_file := clang.UnsavedFile {
+        Filename = strings.clone_to_cstring(macro_file_name, arena_alloc),
+        Contents = strings.clone_to_cstring(
+            strings.to_string(macro_source),
+            arena_alloc,
+        ),
+        Length   = c.ulong(strings.builder_len(macro_source)),
+    }
+
+    macro_flags := make(
+        [dynamic]cstring,
+        len = 0,
+        cap = len(p.clang_flags) + 3,
+        allocator = arena_alloc,
+    )
+    append(&macro_flags, ..p.clang_flags[:])
+    append(&macro_flags, "-xc")
+    append(&macro_flags, "--std=c99")
+    // Macros that can not be evaluated produce errors which must not stop the parsing of the remaining macros
+    append(&macro_flags, "-ferror-limit=0")
+
+    unit := clang.parseTranslationUnit(
+        p.index,
+        macro_file.Filename,
+        raw_data(macro_flags),
+        i32(len(macro_flags)),
+        &macro_file,
+        1,
+        .SkipFunctionBodies | .SingleFileParse,
+    )
+    if unit == nil {
+        err = errors.message("failed to parse macro file")
+        return
+    }
+    defer clang.disposeTranslationUnit(unit)
+
+    when ODIN_DEBUG {
+        print_diagnostics(console.writer(), unit, "MACROS-FILE-")
+    }
+
+    cursor := clang.getTranslationUnitCursor(unit)
+
+    clang.visitChildren(
+        cursor,
+        proc "c" (
+            cursor, parent: clang.Cursor,
+            client_data: clang.ClientData,
+        ) -> clang.ChildVisitResult {
+            context = runtime.default_context()
+            data := cast(^MacroEvaluation)client_data
+            context.user_ptr = data.ctx
+
+            ctx := ps()
+            ctx.cursors_visited += 1
+
+            cursor_kind := clang.getCursorKind(cursor)
+
+            #partial switch cursor_kind {
+            case .VarDecl:
+                var_name_clang := clang.getCursorSpelling(cursor)
+                defer clang.disposeString(var_name_clang)
+
+                decl, ok := data.decls[clang_str(var_name_clang)]
+                if !ok do return .Continue
+
+                if decl.evaluate {
+                    evaluate_macro(ctx, cursor, decl.name)
+                    return .Continue
                 }
 
-                if first_macro_written {
-                    os.write_rune(macro_file, ',')
+                om.insert(&ctx.rs.constants, decl.name, runic.Constant{})
+                data.current = decl.name
+            case .StringLiteral:
+                if len(data.current) == 0 do break
+                name := data.current
+                data.current = ""
+
+                const_value_clang := clang.getCursorSpelling(cursor)
+                const_value := clang_str(const_value_clang)
+                defer clang.disposeString(const_value_clang)
+
+                const_value = const_value[1:len(const_value) - 1]
+
+                const_idx := om.index(ctx.rs.constants, name)
+                const := &ctx.rs.constants.data[const_idx].value
+                const.type.spec = runic.Builtin.Untyped
+
+                if strings.has_prefix(const_value, "\\\"") &&
+                   strings.has_suffix(const_value, "\\\"") {
+                    const.value = strings.clone(
+                        strings.trim_prefix(
+                            strings.trim_suffix(const_value, "\\\""),
+                            "\\\"",
+                        ),
+                        ctx.allocator,
+                    )
+                    const.type.spec = runic.Builtin.String
+                } else if strings.has_prefix(const_value, "'") &&
+                   strings.has_suffix(const_value, "'") &&
+                   len(const_value) == 3 {
+                    const.value = strings.clone(
+                        strings.trim_prefix(
+                            strings.trim_suffix(const_value, "'"),
+                            "'",
+                        ),
+                        ctx.allocator,
+                    )
+                    const.type.spec = runic.Builtin.SInt8
+                } else if value_i64, ok_i64 := strconv.parse_i64(
+                    const_value,
+                ); ok_i64 {
+                    const.value = value_i64
+                } else if value_f64, ok_f64 := strconv.parse_f64(
+                    const_value,
+                ); ok_f64 {
+                    const.value = value_f64
                 } else {
-                    os.write_string(macro_file, "const char")
+                    value := strings.clone(const_value, ctx.allocator)
+                    const.value = value
+                    append(&data.aliases, MacroAlias{name, value})
                 }
+            }
 
-                fmt.fprintf(
-                    macro_file,
-                    "*{}={}({})",
-                    prefix_name,
-                    strings.to_string(stringify_name),
-                    name,
-                )
+            return .Recurse
+        },
+        &data,
+    )
 
-                first_macro_written = true
-            }
+    resolve_macro_aliases(ctx, data.aliases[:])
+    return
+}
 
-            os.write_rune(macro_file, ';')
+// Turns the constants of macros whose values are the names of symbols or types into aliases of them.
+// The constants are removed all at once, since removing them one by one shifts all following constants every time
+@(private = "file")
+resolve_macro_aliases :: proc(ctx: ^ParseContext, aliases: []MacroAlias) {
+    resolved := make([dynamic]string, context.temp_allocator)
+    for alias in aliases {
+        // The macro could have been evaluated to a number
+        const := om.get(ctx.rs.constants, alias.name)
+        if _, is_string := const.value.(string); !is_string do continue
+
+        if sym_idx, is_sym := om.index(ctx.rs.symbols, alias.value); is_sym {
+            sym := &ctx.rs.symbols.data[sym_idx].value
+            append(&sym.aliases, alias.name)
+        } else if om.contains(ctx.rs.types, alias.value) {
+            om.insert(
+                &ctx.rs.types,
+                alias.name,
+                runic.Type{spec = alias.value},
+            )
+        } else {
+            continue
         }
 
-        defer delete(macro_file_name)
-        defer os.remove(macro_file_name)
-
-        macro_file_name_cstr := strings.clone_to_cstring(macro_file_name)
+        append(&resolved, alias.name)
+    }
 
-        macro_index := clang.createIndex(0, 0)
-        defer clang.disposeIndex(macro_index)
+    om.delete_keys(&ctx.rs.constants, resolved[:])
+}
 
-        append(&clang_flags, "-xc")
-        append(&clang_flags, "--std=c99")
-        unit := clang.parseTranslationUnit(
-            macro_index,
-            macro_file_name_cstr,
-            raw_data(clang_flags),
-            i32(len(clang_flags)),
-            nil,
-            0,
-            .SkipFunctionBodies | .SingleFileParse,
-        )
-        delete(macro_file_name_cstr)
+// Returns the name of a variable of the macro file that does not collide with any macro
+@(private = "file")
+macro_decl_name :: proc(
+    macros: om.OrderedMap(string, Macro),
+    prefix: rune,
+    name: string,
+    allocator := context.allocator,
+) -> string {
+    decl_name := fmt.aprintf("{}{}", prefix, name, allocator = allocator)
+    for om.contains(macros, decl_name) {
+        decl_name = strings.concatenate({"_", decl_name}, allocator)
+    }
+    return decl_name
+}
 
-        if unit == nil {
-            err = errors.message("failed to parse macro file")
-            return
-        }
-        defer clang.disposeTranslationUnit(unit)
+// Sets the constant of the macro name to the value of the evaluated cursor. Strings and characters
+// are kept as they have been stringified, since evaluating turns characters into integers
+@(private = "file")
+evaluate_macro :: proc(ctx: ^ParseContext, cursor: clang.Cursor, name: string) {
+    // The macro has been turned into an alias
+    const_idx, ok := om.index(ctx.rs.constants, name)
+    if !ok do return
+
+    const := &ctx.rs.constants.data[const_idx].value
+    if spec, is_builtin := const.type.spec.(runic.Builtin);
+       !is_builtin || spec != .Untyped {
+        return
+    }
 
-        when ODIN_DEBUG {
-            print_diagnostics(os.stderr, unit, "MACROS-FILE-")
+    eval := clang.Cursor_Evaluate(cursor)
+    if eval == nil do return
+    defer clang.EvalResult_dispose(eval)
+
+    #partial switch clang.EvalResult_getKind(eval) {
+    case .Int:
+        if bool(clang.EvalResult_isUnsignedInt(eval)) {
+            value := u64(clang.EvalResult_getAsUnsigned(eval))
+            // Values that do not fit keep their stringification
+            if value > u64(max(i64)) do return
+            const.value = i64(value)
+        } else {
+            const.value = i64(clang.EvalResult_getAsLongLong(eval))
         }
+    case .Float:
+        const.value = f64(clang.EvalResult_getAsDouble(eval))
+    }
+}
 
-        cursor := clang.getTranslationUnitCursor(unit)
-
-        clang.visitChildren(
-            cursor,
-            proc "c" (
-                cursor, parent: clang.Cursor,
-                client_data: clang.ClientData,
-            ) -> clang.ChildVisitResult {
-                context = runtime.default_context()
-                context.user_ptr = client_data
+// Returns all files that have been included when the headers have been parsed, including the headers themselves
+parser_dependencies :: proc(
+    p: ^Parser,
+    allocator := context.allocator,
+) -> []string {
+    return included_files_of_units(
+        p.units[:],
+        p.stdinc_gen_dir,
+        p.unsaved_files,
+        allocator,
+    )
+}
 
-                ctx := ps()
+parser_destroy :: proc(p: ^Parser) {
+    for unit in p.units {
+        clang.disposeTranslationUnit(unit)
+    }
+    delete(p.units)
+    if p.index != nil do clang.disposeIndex(p.index)
+    delete(p.clang_flags)
 
-                cursor_kind := clang.getCursorKind(cursor)
+    runtime.arena_destroy(&p.arena)
+}
 
-                #partial switch cursor_kind {
-                case .VarDecl:
-                    var_name_clang := clang.getCursorSpelling(cursor)
-                    var_name := clang_str(var_name_clang)
-                    defer clang.disposeString(var_name_clang)
-
-                    start: int = ---
-                    for r, idx in var_name {
-                        if r == 'R' {
-                            start = idx
-                            break
-                        }
-                    }
-                    start += 1
+// Returns whether location is inside of one of the headers. Inside of an umbrella main_file_name is set to the header of location
+@(private = "file")
+location_is_from_main :: proc(
+    ctx: ^ParseContext,
+    location: clang.SourceLocation,
+) -> bool {
+    if ctx.umbrella_headers == nil {
+        return bool(clang.Location_isFromMainFile(location))
+    }
 
-                    var_name_str := strings.clone(
-                        var_name[start:],
-                        ctx.allocator,
-                    )
+    file: clang.File = ---
+    clang.getFileLocation(location, &file, nil, nil, nil)
+    if file == nil {
+        ctx.main_file_name = ""
+        return false
+    }
 
-                    om.insert(
-                        &ctx.rs.constants,
-                        var_name_str,
-                        runic.Constant{},
-                    )
-                case .StringLiteral:
-                    const_value_clang := clang.getCursorSpelling(cursor)
-                    const_value := clang_str(const_value_clang)
-                    defer clang.disposeString(const_value_clang)
-
-                    const_value = const_value[1:len(const_value) - 1]
-
-                    entry := &ctx.rs.constants.data[len(ctx.rs.constants.data) - 1]
-                    const := &entry.value
-                    const.type.spec = runic.Builtin.Untyped
-
-                    if strings.has_prefix(const_value, "\\\"") &&
-                       strings.has_suffix(const_value, "\\\"") {
-                        const.value = strings.clone(
-                            strings.trim_prefix(
-                                strings.trim_suffix(const_value, "\\\""),
-                                "\\\"",
-                            ),
-                            ctx.allocator,
-                        )
-                        const.type.spec = runic.Builtin.String
-                    } else if strings.has_prefix(const_value, "'") &&
-                       strings.has_suffix(const_value, "'") &&
-                       len(const_value) == 3 {
-                        const.value = strings.clone(
-                            strings.trim_prefix(
-                                strings.trim_suffix(const_value, "'"),
-                                "'",
-                            ),
-                            ctx.allocator,
-                        )
-                        const.type.spec = runic.Builtin.SInt8
-                    } else if value_i64, ok_i64 := strconv.parse_i64(
-                        const_value,
-                    ); ok_i64 {
-                        const.value = value_i64
-                    } else if value_f64, ok_f64 := strconv.parse_f64(
-                        const_value,
-                    ); ok_f64 {
-                        const.value = value_f64
-                    } else {
-                        name := entry.key
-
-                        for &sym_entry in ctx.rs.symbols.data {
-                            sym_name, sym := sym_entry.key, &sym_entry.value
-                            if const_value == sym_name {
-                                append(&sym.aliases, name)
-                                om.delete_key(&ctx.rs.constants, name)
-                                return .Recurse
-                            }
-                        }
+    header, cached := ctx.umbrella_files[file]
+    if !cached {
+        file_name_clang := clang.getFileName(file)
+        defer clang.disposeString(file_name_clang)
 
-                        for type_entry in ctx.rs.types.data {
-                            type_name := type_entry.key
-
-                            if const_value == type_name {
-                                om.insert(
-                                    &ctx.rs.types,
-                                    name,
-                                    runic.Type{spec = type_name},
-                                )
-                                om.delete_key(&ctx.rs.constants, name)
-                                return .Recurse
-                            }
-                        }
+        key := umbrella_header_key(clang_str(file_name_clang), ctx.allocator)
+        header = ctx.umbrella_headers[key]
+        ctx.umbrella_files[file] = header
+    }
 
-                        const.value = strings.clone(const_value, ctx.allocator)
-                    }
-                }
+    ctx.main_file_name = header
+    return len(header) != 0
+}
 
-                return .Recurse
-            },
-            &ctx,
-        )
-    }
+// Returns the absolute path of header which is used to include it into the umbrella and to match the files of the umbrella against the headers
+@(private = "file")
+umbrella_header_key :: proc(
+    header: string,
+    allocator := context.allocator,
+) -> string {
+    abs_header, abs_ok := filepath.abs(header, allocator)
+    if !abs_ok do abs_header = filepath.clean(header, allocator)
+
+    key, _ := strings.replace_all(abs_header, "\\", "/", allocator)
+    return key
+}
 
-    return
+// Returns the name of header relative to the rune, as it is compared against the file names of the cursors
+@(private = "file")
+header_main_file_name :: proc(
+    rune_file_name, header: string,
+    allocator := context.allocator,
+) -> string {
+    rel_header, rel_ok := runic.absolute_to_file(
+        rune_file_name,
+        header,
+        allocator,
+    )
+    return rel_header if rel_ok else header
 }
 
 // return value of false means "do not continue" else "continue"
@@ -642,7 +1184,7 @@ parse_cursor_not_from_main :: proc(cursor: clang.Cursor) -> bool {
     if len(file_name_str) == 0 {
         when ODIN_DEBUG {
             if cursor_kind != .MacroDefinition {
-                fmt.eprintfln(
+                console.eprintfln(
                     "debug: cursor_kind={} display_name=\"{}\" will be ignored because the file name is empty",
                     cursor_kind,
                     display_name,
@@ -709,7 +1251,7 @@ parse_cursor_not_from_main :: proc(cursor: clang.Cursor) -> bool {
                     )
                     if ctx.err != nil {
                         // TODO: add file name and line, column to the error output
-                        fmt.eprintfln(
+                        console.eprintfln(
                             "{}: failed to parse function pointer: {}",
                             type_name,
                             ctx.err,
@@ -1240,7 +1782,7 @@ parse_unknowns :: proc(forward_decl_type: runic.Type, extern: []string) {
             unknown_anons = om.make(string, runic.Type)
 
             if ctx.err != nil {
-                fmt.eprintln(ctx.err, "\n")
+                console.eprintln(ctx.err, "\n")
                 ctx.err = nil
                 continue
             }
@@ -1259,7 +1801,7 @@ parse_unknowns :: proc(forward_decl_type: runic.Type, extern: []string) {
             // If the type is #Untyped then it technically exists and we don't need to notify the user about it
             if !(om.contains(ctx.rs.types, unknown) ||
                    om.contains(ctx.rs.externs, unknown)) {
-                fmt.eprintfln(
+                console.eprintfln(
                     "Unknown type \"{}\" has not been found in the includes",
                     unknown,
                 )
@@ -20,7 +20,9 @@ package cpp_codegen
 import "core:fmt"
 import "core:io"
 import "core:os"
+import "core:slice"
 import "core:strings"
+import "root:console"
 import "root:errors"
 import om "root:ordered_map"
 import "root:runic"
@@ -129,43 +131,6 @@ clang_source_error :: proc(
     )
 }
 
-@(private)
-temp_file :: proc(
-) -> (
-    file: os.Handle,
-    file_path: string,
-    err: errors.Error,
-) {
-    file_name: strings.Builder
-
-    when ODIN_OS == .Windows {
-        os.make_directory("C:\\temp")
-        strings.write_string(&file_name, "C:\\temp\\runic_macros")
-    } else {
-        strings.write_string(&file_name, "/tmp/runic_macros")
-    }
-
-    MAX_TRIES :: 100
-
-    for _ in 0 ..< MAX_TRIES {
-        strings.write_rune(&file_name, '_')
-
-        os_err: os.Error = ---
-        file, os_err = os.open(
-            strings.to_string(file_name),
-            os.O_WRONLY | os.O_CREATE | os.O_EXCL,
-            0o777,
-        )
-        if os_err == nil {
-            file_path = strings.to_string(file_name)
-            return
-        }
-    }
-
-    err = errors.message("MAX_TRIES reached")
-    return
-}
-
 @(private)
 clang_get_cursor_extent :: proc(cursor: clang.Cursor) -> string {
     range := clang.getCursorExtent(cursor)
@@ -464,7 +429,12 @@ generate_clang_flags :: proc(
         append(&clang_flags, "-mfloat-abi=soft")
     }
 
-    for name, value in defines {
+    // Sorted so that the flags are the same on every run (e.g. for the runestone cache)
+    define_names, _ := slice.map_keys(defines, allocator)
+    slice.sort(define_names)
+
+    for name in define_names {
+        value := defines[name]
         arg := strings.clone_to_cstring(
             fmt.aprintf("-D{}={}", name, value, allocator = allocator),
             allocator,
@@ -515,7 +485,7 @@ make_forward_decls_into_actual_types :: proc(
         if included_file_name != nil &&
            runic.single_list_glob(ctx.extern, included_file_name.?) {
             when ODIN_DEBUG {
-                fmt.eprintfln(
+                console.eprintfln(
                     "debug: forward declaration \"{}\" will be added to externs as defined by \"from.forward_decl_type\" (default: '#Opaque')",
                     decl,
                 )
@@ -536,7 +506,7 @@ make_forward_decls_into_actual_types :: proc(
             if om.contains(ctx.rs.types, decl) do continue
 
             when ODIN_DEBUG {
-                fmt.eprintfln(
+                console.eprintfln(
                     "debug: forward declaration \"{}\" will be added to types as defined by \"from.forward_decl_type\" (default: '#Opaque')",
                     decl,
                 )
@@ -547,6 +517,7 @@ make_forward_decls_into_actual_types :: proc(
     }
 }
 
+// Prints every diagnostic of unit using one write, so that diagnostics are not split up
 @(private)
 print_diagnostics :: proc(out: union #no_nil {
         io.Writer,
@@ -560,38 +531,43 @@ print_diagnostics :: proc(out: union #no_nil {
         wd = os.stream_from_handle(w)
     }
 
-    num_diag := clang.getNumDiagnostics(unit)
-    if num_diag != 0 {
-        for idx in 0 ..< num_diag {
-            dig := clang.getDiagnostic(unit, idx)
-            defer clang.disposeDiagnostic(dig)
-
-            sev := clang.getDiagnosticSeverity(dig)
-            dig_msg := clang.formatDiagnostic(
-                dig,
-                clang.defaultDiagnosticDisplayOptions(),
-            )
-            defer clang.disposeString(dig_msg)
-            dig_str := clang.getCString(dig_msg)
-
-            fmt.wprint(wd, prefix)
-            switch sev {
-            case .Error:
-                fmt.wprint(wd, "ERROR: ")
-                is_fatal = true
-            case .Fatal:
-                fmt.wprint(wd, "FATAL: ")
-                is_fatal = true
-            case .Warning:
-                fmt.wprint(wd, "WARNING: ")
-            case .Note:
-                fmt.wprint(wd, "NOTE: ")
-            case .Ignored:
-                fmt.wprint(wd, "IGNORED: ")
-            }
+    line: strings.Builder
+    strings.builder_init(&line)
+    defer strings.builder_destroy(&line)
 
-            fmt.wprintln(wd, dig_str)
+    num_diag := clang.getNumDiagnostics(unit)
+    for idx in 0 ..< num_diag {
+        dig := clang.getDiagnostic(unit, idx)
+        defer clang.disposeDiagnostic(dig)
+
+        sev := clang.getDiagnosticSeverity(dig)
+        dig_msg := clang.formatDiagnostic(
+            dig,
+            clang.defaultDiagnosticDisplayOptions(),
+        )
+        defer clang.disposeString(dig_msg)
+        dig_str := clang.getCString(dig_msg)
+
+        strings.builder_reset(&line)
+        strings.write_string(&line, prefix)
+        switch sev {
+        case .Error:
+            strings.write_string(&line, "ERROR: ")
+            is_fatal = true
+        case .Fatal:
+            strings.write_string(&line, "FATAL: ")
+            is_fatal = true
+        case .Warning:
+            strings.write_string(&line, "WARNING: ")
+        case .Note:
+            strings.write_string(&line, "NOTE: ")
+        case .Ignored:
+            strings.write_string(&line, "IGNORED: ")
         }
+        strings.write_string(&line, string(dig_str))
+        strings.write_byte(&line, '\n')
+
+        io.write_string(wd, strings.to_string(line))
     }
 
     return
@@ -1,6 +1,8 @@
 #+feature dynamic-literals
 package cpp_codegen
 
+import "core:os"
+import "core:strings"
 import "core:testing"
 import om "root:ordered_map"
 import "root:runic"
@@ -796,7 +798,7 @@ test_cpp_macros :: proc(t: ^testing.T) {
     if !expect_value(t, err, nil) do return
     defer runic.runestone_destroy(&rs)
 
-    if !expect_value(t, om.length(rs.constants), 10) do return
+    if !expect_value(t, om.length(rs.constants), 12) do return
     if !expect_value(t, om.length(rs.types), 4) do return
     if !expect_value(t, om.length(rs.symbols), 5) do return
 
@@ -807,6 +809,11 @@ test_cpp_macros :: proc(t: ^testing.T) {
     C := om.get(rs.constants, "C")
     expect_value(t, C.value.(i64), 3)
 
+    shifted := om.get(rs.constants, "SHIFTED")
+    expect_value(t, shifted.value.(i64), 8)
+    unsigned := om.get(rs.constants, "UNSIGNED")
+    expect_value(t, unsigned.value.(i64), 10)
+
     slashy := om.get(rs.constants, "SLASHY")
     expect_value(t, slashy.value.(string), "COUNT 1 2 3 4")
 
@@ -914,3 +921,178 @@ test_cpp_unknown_int :: proc(t: ^testing.T) {
 
     expect_value(t, fp.return_type.spec.(runic.Builtin), runic.Builtin.SInt8)
 }
+
+@(test)
+test_cpp_runestone_cache :: proc(t: ^testing.T) {
+    using testing
+
+    CACHE_DIR :: "test_data/runestone_cache"
+    defer delete_system_includes(CACHE_DIR)
+
+    rf := runic.From {
+        language = "c",
+        shared = {d = {runic.Platform{.Any, .Any} = "libbuiltin.so"}},
+        headers = {d = {runic.Platform{.Any, .Any} = {"test_data/builtin.h"}}},
+    }
+    defer delete(rf.shared.d)
+    defer delete(rf.headers.d)
+
+    rs, err := generate_runestone(
+        {.Linux, .arm64},
+        RUNESTONE_TEST_PATH,
+        rf,
+        CACHE_DIR,
+    )
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&rs)
+
+    cache_fd, cache_err := os.open(CACHE_DIR)
+    if !expect_value(t, cache_err, nil) do return
+    cache_files, read_err := os.read_dir(cache_fd, -1)
+    os.close(cache_fd)
+    if !expect_value(t, read_err, nil) do return
+    defer os.file_info_slice_delete(cache_files)
+
+    manifests: int
+    for file in cache_files {
+        if strings.has_suffix(file.name, ".manifest") do manifests += 1
+    }
+    expect_value(t, manifests, 1)
+
+    cached_rs: runic.Runestone = ---
+    cached_rs, err = generate_runestone(
+        {.Linux, .arm64},
+        RUNESTONE_TEST_PATH,
+        rf,
+        CACHE_DIR,
+    )
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&cached_rs)
+
+    expect_value(t, cached_rs.lib.shared.?, "libbuiltin.so")
+    expect_value(t, om.length(cached_rs.types), om.length(rs.types))
+    expect_value(t, om.length(cached_rs.symbols), om.length(rs.symbols))
+
+    for entry in rs.types.data {
+        cached_type, ok := om.get(cached_rs.types, entry.key)
+        if expect(t, ok) {
+            expect(t, runic.is_same(entry.value, cached_type))
+        }
+    }
+}
+
+@(test)
+test_cpp_umbrella :: proc(t: ^testing.T) {
+    using testing
+
+    rf := runic.From {
+        language = "c",
+        shared = {d = {runic.Platform{.Any, .Any} = "libumbrella.so"}},
+        headers = {
+            d = {
+                runic.Platform{.Any, .Any} = {
+                    "test_data/gnu_attribute.h",
+                    "test_data/union.h",
+                },
+            },
+        },
+    }
+    defer delete(rf.shared.d)
+    defer delete(rf.headers.d)
+
+    rs, err := generate_runestone(
+        runic.platform_from_host(),
+        RUNESTONE_TEST_PATH,
+        rf,
+    )
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&rs)
+
+    rf.umbrella = runic.make_platform_value(bool)
+    defer delete(rf.umbrella.d)
+    rf.umbrella.d[{.Any, .Any}] = true
+
+    umbrella_rs: runic.Runestone = ---
+    umbrella_rs, err = generate_runestone(
+        runic.platform_from_host(),
+        RUNESTONE_TEST_PATH,
+        rf,
+    )
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&umbrella_rs)
+
+    if !expect_value(t, om.length(umbrella_rs.types), om.length(rs.types)) {
+        return
+    }
+    if !expect_value(
+        t,
+        om.length(umbrella_rs.symbols),
+        om.length(rs.symbols),
+    ) {
+        return
+    }
+
+    for entry, idx in rs.types.data {
+        umbrella_entry := umbrella_rs.types.data[idx]
+        expect_value(t, umbrella_entry.key, entry.key)
+        expect(t, runic.is_same(umbrella_entry.value, entry.value))
+    }
+    for entry, idx in rs.symbols.data {
+        expect_value(t, umbrella_rs.symbols.data[idx].key, entry.key)
+    }
+}
+
+@(test)
+test_cpp_parallel_headers :: proc(t: ^testing.T) {
+    using testing
+
+    rf := runic.From {
+        language = "c",
+        shared = {d = {runic.Platform{.Any, .Any} = "libparallel.so"}},
+        headers = {
+            d = {
+                runic.Platform{.Any, .Any} = {
+                    "test_data/builtin.h",
+                    "test_data/pointer.h",
+                    "test_data/array.h",
+                },
+            },
+        },
+    }
+    defer delete(rf.shared.d)
+    defer delete(rf.headers.d)
+
+    rs, err := generate_runestone({.Linux, .x86_64}, RUNESTONE_TEST_PATH, rf)
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&rs)
+
+    parallel_rs: runic.Runestone = ---
+    parallel_rs, err = generate_runestone(
+        {.Linux, .x86_64},
+        RUNESTONE_TEST_PATH,
+        rf,
+        jobs = 3,
+    )
+    if !expect_value(t, err, nil) do return
+    defer runic.runestone_destroy(&parallel_rs)
+
+    if !expect_value(t, om.length(parallel_rs.types), om.length(rs.types)) {
+        return
+    }
+    if !expect_value(
+        t,
+        om.length(parallel_rs.symbols),
+        om.length(rs.symbols),
+    ) {
+        return
+    }
+
+    for entry, idx in rs.types.data {
+        parallel_entry := parallel_rs.types.data[idx]
+        expect_value(t, parallel_entry.key, entry.key)
+        expect(t, runic.is_same(parallel_entry.value, entry.value))
+    }
+    for entry, idx in rs.symbols.data {
+        expect_value(t, parallel_rs.symbols.data[idx].key, entry.key)
+    }
+}
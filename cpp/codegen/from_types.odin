@@ -20,6 +20,7 @@ package cpp_codegen
 import "base:runtime"
 import "core:fmt"
 import "core:strings"
+import "root:console"
 import "root:errors"
 import om "root:ordered_map"
 import "root:runic"
@@ -353,6 +354,7 @@ record_to_type :: proc(
             context = runtime.default_context()
             data := cast(^RecordData)client_data
             context.user_ptr = data.ctx
+            data.ctx.cursors_visited += 1
 
             cursor_type := clang.getCursorType(cursor)
             cursor_kind := clang.getCursorKind(cursor)
@@ -380,12 +382,12 @@ record_to_type :: proc(
                 parent_display_name_str := clang.getCString(parent_display_name)
 
                 if field_size % 8 != 0 {
-                    fmt.eprintfln("field \"{}.{}\" has specific bit width of {}. This field can not be converted to a byte array, therefore the type will be set to \"#Untyped\"", parent_display_name_str, member_name, field_size)
+                    console.eprintfln("field \"{}.{}\" has specific bit width of {}. This field can not be converted to a byte array, therefore the type will be set to \"#Untyped\"", parent_display_name_str, member_name, field_size)
                     data.members_failed = true
                     return .Break
                 }
 
-                fmt.eprintfln("field \"{}.{}\" has specific bit width of {}. This is not properly supported by runic. Therefore \"{}\" will be added as \"#UInt8 #Attr Arr {} #AttrEnd\"", parent_display_name_str, member_name, field_size, member_name, field_size / 8)
+                console.eprintfln("field \"{}.{}\" has specific bit width of {}. This is not properly supported by runic. Therefore \"{}\" will be added as \"#UInt8 #Attr Arr {} #AttrEnd\"", parent_display_name_str, member_name, field_size, member_name, field_size / 8)
 
                 array_info := make([dynamic]runic.Array, len = 1, cap = 1, allocator = data.ctx.allocator)
                 array_info[0].size = u64(field_size / 8)
@@ -489,6 +491,8 @@ enum_to_type :: proc(
         },
         &e,
     )
+    // Every child of an enum is an entry
+    ctx.cursors_visited += len(e.entries)
 
     enum_int_type := clang.getEnumDeclIntegerType(cursor)
 
@@ -576,6 +580,7 @@ function_to_type :: proc(
             context = runtime.default_context()
             data := cast(^FuncParamsData)client_data
             context.user_ptr = data.ctx
+            data.ctx.cursors_visited += 1
 
             if clang.getCursorKind(cursor) != .ParmDecl do return .Continue
 
@@ -617,7 +622,7 @@ function_to_type :: proc(
     }
 
     if len(func.parameters) != int(num_params) {
-        fmt.eprintln(
+        console.eprintln(
             clang_source_error(
                 cursor,
                 "{}: could not find parameters len(func.parameters)={} num_params={}. type will be added as RawPtr",
@@ -18,6 +18,8 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 package cpp_codegen
 
 import "base:runtime"
+import "core:crypto/hash"
+import "core:encoding/hex"
 import "core:fmt"
 import "core:math/rand"
 import "core:os"
@@ -221,65 +223,55 @@ when ODIN_OS == .Windows {
     SYSTEM_INCLUDE_GEN_DIR :: "/tmp/runic_system_includes/"
 }
 
+// Needs to be increased whenever the way the system includes are generated changes
+@(private)
+SYSTEM_INCLUDE_GEN_VERSION :: 1
+
+// Returns the directory into which the system includes are generated. It is named after the hash of the
+// generated files, so that one tree is shared by all platforms, runs and processes until the files change
 system_includes_gen_dir :: proc(
-    plat: runic.Platform,
     allocator := context.allocator,
 ) -> (
     gen_dir: string,
     ok: bool,
 ) #optional_ok {
-    os_arch_name := fmt.aprintf(
-        "{}_{}",
-        plat.os,
-        plat.arch,
-        allocator = allocator,
-    )
-    defer delete(os_arch_name, allocator = allocator)
-
-    // Max 100 attempts
-    for _ in 0 ..< 100 {
-        // At max six digits
-        id := rand.uint32() % 1000000
-        folder_name := fmt.aprintf(
-            "{}-{:06d}",
-            os_arch_name,
-            id,
-            allocator = allocator,
-        )
-        gen_dir = filepath.join(
-            {SYSTEM_INCLUDE_GEN_DIR, folder_name},
-            allocator,
+    ctx: hash.Context
+    hash.init(&ctx, .SHA256)
+
+    version := fmt.tprintf("version={}\n", SYSTEM_INCLUDE_GEN_VERSION)
+    hash.update(&ctx, transmute([]byte)version)
+
+    for file_name in SYSTEM_INCLUDE_FILES {
+        contents, _ := system_includes_contents(file_name)
+        // The lengths separate the names and contents of the files
+        entry := fmt.tprintf(
+            "{}:{}\n{}:{}\n",
+            len(file_name),
+            file_name,
+            len(contents),
+            contents,
         )
-        delete(folder_name, allocator = allocator)
-
-        err := make_directory_parents(gen_dir)
-        #partial switch errno in err {
-        case nil:
-            ok = true
-            return
-        case:
-            delete(gen_dir, allocator = allocator)
-            if plat_err, plat_err_ok := os.is_platform_error(errno);
-               plat_err_ok {
-                when ODIN_OS == .Windows {
-                    is_already_exists :=
-                        plat_err == i32(os.ERROR_ALREADY_EXISTS)
-                } else {
-                    is_already_exists := plat_err == i32(os.EEXIST)
-                }
-
-                if is_already_exists do continue
-            }
-            ok = false
-            return
-        }
+        hash.update(&ctx, transmute([]byte)entry)
     }
 
-    ok = false
+    digest: [32]byte
+    hash.final(&ctx, digest[:])
+    // The first 16 characters are enough to tell different versions apart
+    digest_hex := hex.encode(digest[:8], context.temp_allocator)
+
+    gen_dir = filepath.join(
+        {SYSTEM_INCLUDE_GEN_DIR, string(digest_hex)},
+        allocator,
+    )
+    ok = make_directory_parents(SYSTEM_INCLUDE_GEN_DIR) == nil
     return
 }
 
+// Generates the system includes into gen_dir, unless a previous run or another process already did.
+// They are generated into a temporary directory which is then renamed to gen_dir, so that an incomplete tree is never used
 generate_system_includes :: proc(gen_dir: string) -> bool {
+    if os.is_dir(gen_dir) do return true
+
     arena: runtime.Arena
     alloc_err := runtime.arena_init(&arena, 0, context.allocator)
     if alloc_err != .None do return false
@@ -287,6 +279,25 @@ generate_system_includes :: proc(gen_dir: string) -> bool {
 
     context.allocator = runtime.arena_allocator(&arena)
 
+    tmp_dir := fmt.aprintf("{}.tmp-{:08x}", gen_dir, rand.uint32())
+    if err := make_directory_parents(tmp_dir); err != nil do return false
+
+    if !write_system_includes(tmp_dir) {
+        delete_system_includes(tmp_dir)
+        return false
+    }
+
+    if err := os.rename(tmp_dir, gen_dir); err != nil {
+        delete_system_includes(tmp_dir)
+        // Another platform or process generated the system includes first
+        return os.is_dir(gen_dir)
+    }
+
+    return true
+}
+
+@(private = "file")
+write_system_includes :: proc(gen_dir: string) -> bool {
     for file_name in SYSTEM_INCLUDE_FILES {
         when ODIN_OS == .Windows {
             slashed_file_name, _ := strings.replace_all(file_name, "/", "\\")
@@ -347,7 +358,7 @@ delete_system_includes :: proc(gen_dir: string) {
     }
 }
 
-@(private = "file")
+@(private)
 make_directory_parents :: proc(path: string) -> os.Error {
     // An arena is necessary because filepath.dir can allocate memory
     arena: runtime.Arena
@@ -21,21 +21,30 @@ import "core:fmt"
 import "core:os"
 import "core:path/filepath"
 import "core:testing"
-import "root:runic"
 
 @(test)
 test_cpp_stdinc :: proc(t: ^testing.T) {
     using testing
 
-    plat := runic.Platform{.Linux, .x86_64}
+    default_gen_dir, default_gen_dir_ok := system_includes_gen_dir()
+    if !expect(t, default_gen_dir_ok) do return
+    defer delete(default_gen_dir)
 
-    gen_dir, gen_dir_ok := system_includes_gen_dir(plat)
-    if !expect(t, gen_dir_ok) do return
-    defer delete(gen_dir)
+    same_gen_dir := system_includes_gen_dir()
+    defer delete(same_gen_dir)
+    expect_value(t, same_gen_dir, default_gen_dir)
+
+    // The default directory is shared with the other tests which is why a separate one is used
+    gen_dir :: "test_data/stdinc_gen"
+    defer delete_system_includes(gen_dir)
 
     ok := generate_system_includes(gen_dir)
     if !expect(t, ok) do return
 
+    // The existing tree is reused
+    ok = generate_system_includes(gen_dir)
+    if !expect(t, ok) do return
+
     for file_name in SYSTEM_INCLUDE_FILES {
         file_path := filepath.join({gen_dir, file_name})
         defer delete(file_path)
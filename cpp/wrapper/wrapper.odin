@@ -183,20 +183,26 @@ generate_wrapper :: proc(
             )
         }
 
-        out_header, out_header_err := os.open(
+        out_header: runic.OutputFile
+        runic.output_file_open(
+            &out_header,
             out_header_name,
-            os.O_CREATE | os.O_TRUNC | os.O_WRONLY,
-            0o644,
-        )
-        errors.wrap(out_header_err, "failed to create out header") or_return
-        defer os.close(out_header)
-        out_source, out_source_err := os.open(
+            arena_alloc,
+        ) or_return
+        defer if close_err := runic.output_file_close(&out_header, err == nil);
+           close_err != nil && err == nil {
+            err = close_err
+        }
+        out_source: runic.OutputFile
+        runic.output_file_open(
+            &out_source,
             out_source_name,
-            os.O_CREATE | os.O_TRUNC | os.O_WRONLY,
-            0o644,
-        )
-        errors.wrap(out_source_err, "failed to create out source") or_return
-        defer os.close(out_source)
+            arena_alloc,
+        ) or_return
+        defer if close_err := runic.output_file_close(&out_source, err == nil);
+           close_err != nil && err == nil {
+            err = close_err
+        }
 
         parsed_names := make([dynamic]string)
         defer delete(parsed_names)
@@ -205,8 +211,8 @@ generate_wrapper :: proc(
         }
 
         data := ClientData {
-            header            = os.stream_from_handle(out_header),
-            source            = os.stream_from_handle(out_source),
+            header            = runic.output_file_writer(&out_header),
+            source            = runic.output_file_writer(&out_source),
             load_all_includes = load_all_includes,
             extern            = extern,
             rune_file_name    = rune_file_name,
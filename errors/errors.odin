@@ -21,6 +21,7 @@ import "base:runtime"
 import "core:encoding/json"
 import "core:fmt"
 import "core:io"
+import "core:mem"
 import "core:os"
 import "core:reflect"
 
@@ -34,7 +35,19 @@ error_arena_err := runtime.arena_init(
     0,
     runtime.default_allocator(),
 )
-error_allocator := runtime.arena_allocator(&error_arena)
+@(private)
+error_mutex: mem.Mutex_Allocator
+// Errors are created from multiple threads when generating runestones in parallel
+error_allocator := make_error_allocator()
+
+@(private = "file")
+make_error_allocator :: proc() -> runtime.Allocator {
+    mem.mutex_allocator_init(
+        &error_mutex,
+        runtime.arena_allocator(&error_arena),
+    )
+    return mem.mutex_allocator(&error_mutex)
+}
 
 message :: proc(
     fmt_str: string,
@@ -0,0 +1,218 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package main
+
+import "core:fmt"
+import "core:os"
+import "core:strings"
+import "core:thread"
+import "console"
+import cppcdg "cpp/codegen"
+import "errors"
+import odincdg "odin/codegen"
+import "runic"
+import "stats"
+import "trace"
+
+GenerateJob :: struct {
+    plat:           runic.Platform,
+    rune_file_name: string,
+    from:           runic.From,
+    cache_dir:      Maybe(string),
+    // If set, the headers are (re-)parsed using the parser instead of generating the runestone from scratch
+    parser:         ^cppcdg.Parser,
+    // If set, the files that have been included by the headers are collected in dependencies
+    collect_deps:   bool,
+    dependencies:   [dynamic]string,
+    // Number of threads used to parse the headers. It is set by run_generate_jobs
+    jobs:           int,
+    // Output of the job tagged with its platform. It is printed by run_generate_jobs
+    log:            console.Buffer,
+    rs:             runic.Runestone,
+    err:            errors.Error,
+}
+
+// Generates and postprocesses the runestones of all platforms using up to `jobs` threads.
+// The runestones are appended in the order of `plats` and the output and status of every
+// platform are printed in that order, no matter which platform finishes first.
+// If cache_dir is set, runestones of c headers are loaded from and stored in it.
+// If dependencies is set, all files that have been included by the headers are appended to it.
+generate_runestones :: proc(
+    plats: []runic.Platform,
+    rune_file_name: string,
+    from: runic.From,
+    jobs: int,
+    cache_dir: Maybe(string),
+    runestones: ^[dynamic]runic.Runestone,
+    file_paths: ^[dynamic]string,
+    dependencies: ^[dynamic]string = nil,
+) {
+    switch strings.to_lower(from.language, context.temp_allocator) {
+    case "c", "cpp", "cxx", "c++":
+    case "odin":
+        when ODIN_OS == .FreeBSD {
+            fmt.eprintfln("from odin is not supported on FreeBSD")
+            os.exit(1)
+        }
+    case:
+        fmt.eprintfln("from language {} is not supported", from.language)
+        os.exit(1)
+    }
+
+    generate_jobs := make([]GenerateJob, len(plats), context.temp_allocator)
+    for plat, idx in plats {
+        generate_jobs[idx] = GenerateJob {
+            plat           = plat,
+            rune_file_name = rune_file_name,
+            from           = from,
+            cache_dir      = cache_dir,
+            collect_deps   = dependencies != nil,
+        }
+    }
+
+    run_generate_jobs(generate_jobs, jobs)
+
+    for &job in generate_jobs {
+        // The dependencies are allocated by the threads of the jobs which is why they are copied
+        for dep in job.dependencies {
+            append(dependencies, strings.clone(dep, dependencies.allocator))
+            delete(dep)
+        }
+        delete(job.dependencies)
+
+        if job.err != nil do continue
+
+        append(runestones, job.rs)
+        append(file_paths, "")
+    }
+}
+
+// Runs all generate jobs using up to `jobs` threads. The threads that are not needed
+// for the platforms are used to parse the headers of every platform concurrently.
+// The output of every job is buffered and printed together with its status in the order of the jobs
+run_generate_jobs :: proc(generate_jobs: []GenerateJob, jobs: int) {
+    thread_count := min(jobs, len(generate_jobs))
+    for &job in generate_jobs {
+        job.jobs = max(1, jobs / max(1, thread_count))
+
+        // The output of a single platform can not be confused with another one
+        tag := ""
+        if len(generate_jobs) > 1 {
+            tag = fmt.tprintf("{}.{}", job.plat.os, job.plat.arch)
+        }
+        console.buffer_init(&job.log, tag)
+    }
+
+    if jobs <= 1 || len(generate_jobs) <= 1 {
+        for &job in generate_jobs {
+            generate_job(&job)
+            report_generate_job(&job)
+        }
+        return
+    }
+
+    pool: thread.Pool
+    thread.pool_init(&pool, context.allocator, thread_count)
+    defer thread.pool_destroy(&pool)
+
+    for &job, idx in generate_jobs {
+        thread.pool_add_task(
+            &pool,
+            context.allocator,
+            proc(task: thread.Task) {
+                generate_job(cast(^GenerateJob)task.data)
+            },
+            &job,
+            idx,
+        )
+    }
+
+    thread.pool_start(&pool)
+    thread.pool_finish(&pool)
+
+    for &job in generate_jobs {
+        report_generate_job(&job)
+    }
+}
+
+// Prints the output of the job followed by whether it succeeded or failed
+@(private = "file")
+report_generate_job :: proc(job: ^GenerateJob) {
+    console.flush(&job.log)
+    console.buffer_destroy(&job.log)
+
+    if job.err != nil {
+        fmt.eprintfln(
+            "\"{}\" Runestone {}.{} Failed: {}",
+            job.from.language,
+            job.plat.os,
+            job.plat.arch,
+            job.err,
+        )
+        return
+    }
+
+    fmt.eprintfln(
+        "\"{}\" Runestone {}.{} Success",
+        job.from.language,
+        job.plat.os,
+        job.plat.arch,
+    )
+}
+
+@(private = "file")
+generate_job :: proc(job: ^GenerateJob) {
+    prev_log := console.begin(&job.log)
+    defer console.end(prev_log)
+
+    trace.scope("generate runestone", job.plat.os, ".", job.plat.arch)
+
+    if job.collect_deps do job.dependencies = make([dynamic]string)
+
+    switch strings.to_lower(job.from.language, context.temp_allocator) {
+    case "c", "cpp", "cxx", "c++":
+        if job.parser != nil {
+            job.parser.jobs = job.jobs
+            if job.err = cppcdg.parser_parse(job.parser); job.err != nil do return
+            job.rs, job.err = cppcdg.parser_runestone(job.parser)
+            break
+        }
+
+        job.rs, job.err = cppcdg.generate_runestone(
+            job.plat,
+            job.rune_file_name,
+            job.from,
+            job.cache_dir,
+            &job.dependencies if job.collect_deps else nil,
+            job.jobs,
+        )
+    case "odin":
+        when ODIN_OS != .FreeBSD {
+            job.rs, job.err = odincdg.generate_runestone(
+                job.plat,
+                job.rune_file_name,
+                job.from,
+            )
+        }
+    }
+
+    if job.err != nil do return
+
+    runic.from_postprocess_runestone(&job.rs, job.from)
+    stats.record_runestone("generate", job.rs)
+}
@@ -65,28 +65,11 @@ parse_reader :: proc(
                 allocator,
             )
 
-            ini[section_name] = om.make(string, string)
+            ini[section_name] = om.make(string, string, allocator = allocator)
             current_section = &ini[section_name]
         } else {
-            // Retreive the first '=' rune that is not inside a string
-            inside_string: bool
-            equals_pos: int = -1
-            rune_loop: for r, idx in line_str {
-                switch r {
-                case '"':
-                    if inside_string && idx != 0 && line_str[idx - 1] == '\\' {
-                        continue
-                    }
-                    inside_string = !inside_string
-                case '=':
-                    equals_pos = idx
-                    if !inside_string {
-                        break rune_loop
-                    }
-                }
-            }
-
-            if equals_pos == -1 {
+            key, value, ok := split_key_value(line_str)
+            if !ok {
                 err = errors.message(
                     "{}:{}: \"=\" expected",
                     file_name,
@@ -95,14 +78,8 @@ parse_reader :: proc(
                 return
             }
 
-            key_str := strings.clone(
-                strings.trim_right_space(line_str[:equals_pos]),
-                allocator,
-            )
-            value_str := strings.clone(
-                strings.trim_left_space(line_str[equals_pos + 1:]),
-                allocator,
-            )
+            key_str := strings.clone(key, allocator)
+            value_str := strings.clone(value, allocator)
 
             om.insert(current_section, key_str, value_str)
         }
@@ -111,6 +88,35 @@ parse_reader :: proc(
     return
 }
 
+// Splits a trimmed line at the first '=' that is not inside of a string into the trimmed key and value.
+// ok is false if the line does not contain any '='
+split_key_value :: proc(line: string) -> (key, value: string, ok: bool) {
+    // Retreive the first '=' rune that is not inside a string
+    inside_string: bool
+    equals_pos: int = -1
+    rune_loop: for r, idx in line {
+        switch r {
+        case '"':
+            if inside_string && idx != 0 && line[idx - 1] == '\\' {
+                continue
+            }
+            inside_string = !inside_string
+        case '=':
+            equals_pos = idx
+            if !inside_string {
+                break rune_loop
+            }
+        }
+    }
+
+    if equals_pos == -1 do return
+
+    key = strings.trim_right_space(line[:equals_pos])
+    value = strings.trim_left_space(line[equals_pos + 1:])
+    ok = true
+    return
+}
+
 parse :: proc {
     parse_file,
     parse_reader,
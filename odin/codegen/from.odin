@@ -28,6 +28,7 @@ import "core:reflect"
 import "core:slice"
 import "core:strconv"
 import "core:strings"
+import "root:console"
 import "root:errors"
 import om "root:ordered_map"
 import "root:runic"
@@ -785,14 +786,14 @@ lookup_type_of_import :: proc(
                     when ODIN_DEBUG {
                         reserved_packages := cast(^[dynamic]string)context.user_ptr
                         if !slice.contains(reserved_packages^[:], whole_msg) {
-                            fmt.eprintln("debug:", whole_msg)
+                            console.eprintln("debug:", whole_msg)
                             append(reserved_packages, whole_msg)
                         }
                     }
                     return
                 }
 
-                fmt.eprintln(error_tok(whole_msg, pos))
+                console.eprintln(error_tok(whole_msg, pos))
             }
 
             imp.pkg, ok = odinp.parse_package_from_path(imp.abs_path, &p)
@@ -1191,7 +1192,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
         type_err: errors.Error = ---
         decl_type, type_err = type_to_type(first_name, stm.type)
         if type_err != nil {
-            fmt.eprintln(type_err)
+            console.eprintln(type_err)
             return
         }
     }
@@ -1208,20 +1209,20 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
                 }
 
                 if om.contains(ctx.symbols^, name) {
-                    fmt.eprintf("{} is defined as \"", name)
+                    console.eprintf("{} is defined as \"", name)
                     sym := om.get(ctx.symbols^, name)
                     switch v in sym.value {
                     case runic.Type:
-                        runic.write_type(os.stream_from_handle(os.stderr), v)
+                        runic.write_type(console.writer(), v)
                     case runic.Function:
                         runic.write_function(
-                            os.stream_from_handle(os.stderr),
+                            console.writer(),
                             v,
                         )
                     }
-                    fmt.eprintln("\" and \"")
-                    runic.write_type(os.stream_from_handle(os.stderr), type)
-                    fmt.eprintln('"')
+                    console.eprintln("\" and \"")
+                    runic.write_type(console.writer(), type)
+                    console.eprintln('"')
                 }
 
                 om.insert(
@@ -1241,7 +1242,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
 
             fn, fn_err := proc_to_function(value.type, name)
             if fn_err != nil {
-                fmt.eprintln(fn_err)
+                console.eprintln(fn_err)
                 continue
             }
 
@@ -1250,17 +1251,17 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
             }
 
             if om.contains(ctx.symbols^, name) {
-                fmt.eprintf("{} is defined as \"", name)
+                console.eprintf("{} is defined as \"", name)
                 sym := om.get(ctx.symbols^, name)
                 switch v in sym.value {
                 case runic.Type:
-                    runic.write_type(os.stream_from_handle(os.stderr), v)
+                    runic.write_type(console.writer(), v)
                 case runic.Function:
-                    runic.write_function(os.stream_from_handle(os.stderr), v)
+                    runic.write_function(console.writer(), v)
                 }
-                fmt.eprintln("\" and \"")
-                runic.write_function(os.stream_from_handle(os.stderr), fn)
-                fmt.eprintln('"')
+                console.eprintln("\" and \"")
+                runic.write_function(console.writer(), fn)
+                console.eprintln('"')
             }
 
             om.insert(
@@ -1279,7 +1280,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
             #partial switch value.tok.kind {
             case .Integer:
                 if ival, ok := strconv.parse_i64(value.tok.text); !ok {
-                    fmt.eprintfln(
+                    console.eprintfln(
                         "Failed to parse constant value \"{}\" to integer",
                         value.tok.text,
                     )
@@ -1289,7 +1290,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
                 }
             case .Float:
                 if fval, ok := strconv.parse_f64(value.tok.text); !ok {
-                    fmt.eprintfln(
+                    console.eprintfln(
                         "Failed to parse constant value \"{}\" as float",
                         value.tok.text,
                     )
@@ -1304,7 +1305,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
                 )
                 const_spec = .String
             case:
-                fmt.eprintfln(
+                console.eprintfln(
                     "Constants with token kind {} are not supported",
                     value.tok.kind,
                 )
@@ -1312,7 +1313,7 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
             }
 
             if om.contains(ctx.constants^, name) {
-                fmt.eprintfln(
+                console.eprintfln(
                     "Constant {} is defined as \"{}\" and \"{}\"",
                     om.get(ctx.constants^, name),
                     const_val,
@@ -1327,22 +1328,22 @@ parse_value_decl :: proc(stm: ^odina.Value_Decl) -> (err: errors.Error) {
         case:
             type, type_err := type_to_type(name, value_expr)
             if type_err != nil {
-                fmt.eprintln(type_err)
+                console.eprintln(type_err)
                 continue
             }
 
             if om.contains(ctx.symbols^, name) {
-                fmt.eprintf("{} is defined as \"", name)
+                console.eprintf("{} is defined as \"", name)
                 sym := om.get(ctx.symbols^, name)
                 switch v in sym.value {
                 case runic.Type:
-                    runic.write_type(os.stream_from_handle(os.stderr), v)
+                    runic.write_type(console.writer(), v)
                 case runic.Function:
-                    runic.write_function(os.stream_from_handle(os.stderr), v)
+                    runic.write_function(console.writer(), v)
                 }
-                fmt.eprintln("\" and \"")
-                runic.write_type(os.stream_from_handle(os.stderr), type)
-                fmt.eprintln('"')
+                console.eprintln("\" and \"")
+                runic.write_type(console.writer(), type)
+                console.eprintln('"')
             }
 
             #partial switch enum_type in type.spec {
@@ -1385,7 +1386,7 @@ parse_when_stmt :: proc(
 
         is_cond_true_any, eval_err := evaluate_expr(stm.cond)
         if eval_err != nil {
-            fmt.eprintln(
+            console.eprintln(
                 error_tok(
                     fmt.aprintf(
                         "failed to evaluate condition of when: {}",
@@ -1401,7 +1402,7 @@ parse_when_stmt :: proc(
 
         is_cond_true, ok := is_cond_true_any.(bool)
         if !ok {
-            fmt.eprintln(
+            console.eprintln(
                 error_tok(
                     fmt.aprintf(
                         "condition of when does not evaluate to boolean: {}",
@@ -1562,7 +1563,7 @@ odin_root :: proc(allocator := context.allocator) -> string {
     value := os.get_env("ODIN_ROOT", allocator)
     if len(value) == 0 {
         when ODIN_DEBUG {
-            fmt.eprintfln(
+            console.eprintfln(
                 "ODIN_ROOT is not defined. using builtin value \"{}\" instead",
                 ODIN_ROOT,
             )
@@ -23,6 +23,7 @@ import odina "core:odin/ast"
 import "core:reflect"
 import "core:strconv"
 import "core:strings"
+import "root:console"
 import "root:errors"
 import om "root:ordered_map"
 import "root:runic"
@@ -95,7 +96,7 @@ type_to_type :: proc(
     case ^odina.Map_Type:
         return map_to_type(name, type_expr)
     case:
-        fmt.eprintln(
+        console.eprintln(
             error_tok(
                 fmt.aprintf(
                     "type {} not supported",
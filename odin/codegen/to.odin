@@ -19,7 +19,6 @@ package odin_codegen
 import "base:runtime"
 import "core:fmt"
 import "core:io"
-import "core:os"
 import "core:path/filepath"
 import "core:path/slashpath"
 import "core:slice"
@@ -41,6 +40,21 @@ ImportGroup :: struct {
     plats:         [dynamic]runic.Platform,
 }
 
+@(private = "file")
+CrossInfo :: struct {
+    // The sources of all extern types that the runestone uses
+    imports:         [dynamic]string,
+    add_libs_static: [dynamic]AddLibs,
+    add_libs_shared: [dynamic]AddLibs,
+}
+
+@(private = "file")
+ImportCollector :: struct {
+    sources: map[string]string,
+    seen:    ^map[string]struct{},
+    imports: ^[dynamic]string,
+}
+
 @(private = "file")
 RunestoneWriter :: struct {
     wd:        Maybe(io.Writer),
@@ -53,10 +67,12 @@ generate_bindings :: proc(
     platforms: []runic.Platform,
     wd: io.Writer,
     file_path: string,
-) -> union {
+) -> (
+    err: union {
         errors.Error,
         io.Error,
-    } {
+    },
+) {
     arena: runtime.Arena
     defer runtime.arena_destroy(&arena)
     arena_alloc := runtime.arena_allocator(&arena)
@@ -67,177 +83,55 @@ generate_bindings :: proc(
     // If imports differ per runestone write the runestones into separate files
 
     // 1. First construct a list for every runestone that contains all the imports that this runestone uses
-    runestone_imports := make(
-        [dynamic][dynamic]string,
-        len = len(rc.cross),
-        cap = len(rc.cross),
-        allocator = arena_alloc,
-    )
+    extern_sources := runic.extern_sources_of_runecross(rc, arena_alloc)
+    cross_infos := make([]CrossInfo, len(rc.cross), arena_alloc)
+    seen_imports := make(map[string]struct{}, allocator = arena_alloc)
 
     for rs, idx in rc.cross {
-        rs_imps := &runestone_imports[idx]
-        rs_imps^ = make(
+        info := &cross_infos[idx]
+        info.imports = make(
             [dynamic]string,
             len = 0,
             cap = len(rn.extern.sources),
             allocator = arena_alloc,
         )
 
+        clear(&seen_imports)
+        ic := ImportCollector {
+            sources = extern_sources,
+            seen    = &seen_imports,
+            imports = &info.imports,
+        }
+
         // Loop over the types
         for entry in rs.types.data {
-            type := entry.value
-
-            #partial switch spec in type.spec {
-            case runic.ExternType:
-                extern_source, source_found :=
-                    runic.source_of_extern_type_from_runecross(spec, rc)
-                if source_found &&
-                   !slice.contains(rs_imps^[:], extern_source) {
-                    append(rs_imps, extern_source)
-                }
-            case runic.Struct:
-                for m in spec.members {
-                    #partial switch mt in m.type.spec {
-                    case runic.ExternType:
-                        extern_source, source_found :=
-                            runic.source_of_extern_type_from_runecross(mt, rc)
-                        if source_found &&
-                           !slice.contains(rs_imps^[:], extern_source) {
-                            append(rs_imps, extern_source)
-                        }
-                    }
-                }
-            case runic.Union:
-                for m in spec.members {
-                    #partial switch mt in m.type.spec {
-                    case runic.ExternType:
-                        extern_source, source_found :=
-                            runic.source_of_extern_type_from_runecross(mt, rc)
-                        if source_found &&
-                           !slice.contains(rs_imps^[:], extern_source) {
-                            append(rs_imps, extern_source)
-                        }
-                    }
-                }
-            case runic.FunctionPointer:
-                for p in spec.parameters {
-                    #partial switch pt in p.type.spec {
-                    case runic.ExternType:
-                        extern_source, source_found :=
-                            runic.source_of_extern_type_from_runecross(pt, rc)
-                        if source_found &&
-                           !slice.contains(rs_imps^[:], extern_source) {
-                            append(rs_imps, extern_source)
-                        }
-                    }
-                }
-
-                #partial switch pt in spec.return_type.spec {
-                case runic.ExternType:
-                    extern_source, source_found :=
-                        runic.source_of_extern_type_from_runecross(pt, rc)
-                    if source_found &&
-                       !slice.contains(rs_imps^[:], extern_source) {
-                        append(rs_imps, extern_source)
-                    }
-                }
-            }
+            collect_type_imports(&ic, entry.value)
         }
 
         // Loop over the symbols
         for entry in rs.symbols.data {
-            symbol := entry.value
-
-            switch sym in symbol.value {
+            switch sym in entry.value.value {
             case runic.Type:
-                #partial switch spec in sym.spec {
-                case runic.ExternType:
-                    extern_source, source_found :=
-                        runic.source_of_extern_type_from_runecross(spec, rc)
-                    if source_found &&
-                       !slice.contains(rs_imps^[:], extern_source) {
-                        append(rs_imps, extern_source)
-                    }
-                case runic.Struct:
-                    for m in spec.members {
-                        #partial switch mt in m.type.spec {
-                        case runic.ExternType:
-                            extern_source, source_found :=
-                                runic.source_of_extern_type_from_runecross(
-                                    mt,
-                                    rc,
-                                )
-                            if source_found &&
-                               !slice.contains(rs_imps^[:], extern_source) {
-                                append(rs_imps, extern_source)
-                            }
-                        }
-                    }
-                case runic.Union:
-                    for m in spec.members {
-                        #partial switch mt in m.type.spec {
-                        case runic.ExternType:
-                            extern_source, source_found :=
-                                runic.source_of_extern_type_from_runecross(
-                                    mt,
-                                    rc,
-                                )
-                            if source_found &&
-                               !slice.contains(rs_imps^[:], extern_source) {
-                                append(rs_imps, extern_source)
-                            }
-                        }
-                    }
-                case runic.FunctionPointer:
-                    for p in spec.parameters {
-                        #partial switch pt in p.type.spec {
-                        case runic.ExternType:
-                            extern_source, source_found :=
-                                runic.source_of_extern_type_from_runecross(
-                                    pt,
-                                    rc,
-                                )
-                            if source_found &&
-                               !slice.contains(rs_imps^[:], extern_source) {
-                                append(rs_imps, extern_source)
-                            }
-                        }
-                    }
-
-                    #partial switch pt in spec.return_type.spec {
-                    case runic.ExternType:
-                        extern_source, source_found :=
-                            runic.source_of_extern_type_from_runecross(pt, rc)
-                        if source_found &&
-                           !slice.contains(rs_imps^[:], extern_source) {
-                            append(rs_imps, extern_source)
-                        }
-                    }
-                }
+                collect_type_imports(&ic, sym)
             case runic.Function:
                 for p in sym.parameters {
-                    #partial switch pt in p.type.spec {
-                    case runic.ExternType:
-                        extern_source, source_found :=
-                            runic.source_of_extern_type_from_runecross(pt, rc)
-                        if source_found &&
-                           !slice.contains(rs_imps^[:], extern_source) {
-                            append(rs_imps, extern_source)
-                        }
-                    }
-                }
-
-                #partial switch pt in sym.return_type.spec {
-                case runic.ExternType:
-                    extern_source, source_found :=
-                        runic.source_of_extern_type_from_runecross(pt, rc)
-                    if source_found &&
-                       !slice.contains(rs_imps^[:], extern_source) {
-                        append(rs_imps, extern_source)
-                    }
+                    collect_import(&ic, p.type)
                 }
+                collect_import(&ic, sym.return_type)
             }
         }
+
+        // Determine which add libs fit this specific runestone
+        info.add_libs_static = add_libs_for_runestone(
+            rs.plats,
+            rn.add_libs_static,
+            arena_alloc,
+        )
+        info.add_libs_shared = add_libs_for_runestone(
+            rs.plats,
+            rn.add_libs_shared,
+            arena_alloc,
+        )
     }
 
     // 2. Group matching import lists. Two import lists can be grouped together if
@@ -250,8 +144,9 @@ generate_bindings :: proc(
         allocator = arena_alloc,
     )
 
-    group_imports_loop: for rs_imps, rs_idx in runestone_imports {
+    group_imports_loop: for info, rs_idx in cross_infos {
         rs := rc.cross[rs_idx]
+        rs_imps := info.imports
 
         for &imp_group in grouped_imports {
             // Does it match?
@@ -353,13 +248,19 @@ generate_bindings :: proc(
         cap = len(grouped_imports),
         allocator = arena_alloc,
     )
-    opened_handles := make(
-        [dynamic]os.Handle,
+    opened_files := make(
+        [dynamic]^runic.OutputFile,
         len = 0,
         cap = len(grouped_imports),
         allocator = arena_alloc,
     )
-    defer for hd in opened_handles do os.close(hd)
+    // The files of the different platforms are only written if all of them have been generated successfully
+    defer for of in opened_files {
+        if close_err := runic.output_file_close(of, err == nil);
+           close_err != nil && err == nil {
+            err = close_err
+        }
+    }
 
     for imp_group in grouped_imports {
         // If it's any any, use the current writer
@@ -388,12 +289,12 @@ generate_bindings :: proc(
             defer delete(imp_file_name)
 
             imp_wd: Maybe(io.Writer)
-            imp_file, imp_file_err := os.open(
-                imp_file_name,
-                os.O_CREATE | os.O_WRONLY | os.O_TRUNC,
-                0o666,
-            )
-            if imp_file_err != nil {
+            imp_file := new(runic.OutputFile, arena_alloc)
+            if imp_file_err := runic.output_file_open(
+                imp_file,
+                strings.clone(imp_file_name, arena_alloc),
+                arena_alloc,
+            ); imp_file_err != nil {
                 when ODIN_DEBUG {
                     fmt.eprintfln(
                         "debug: failed to create file for different platforms {}",
@@ -401,8 +302,8 @@ generate_bindings :: proc(
                     )
                 }
             } else {
-                imp_wd = os.stream_from_handle(imp_file)
-                append(&opened_handles, imp_file)
+                imp_wd = runic.output_file_writer(imp_file)
+                append(&opened_files, imp_file)
             }
 
             append(
@@ -596,17 +497,6 @@ generate_bindings :: proc(
 
             rs_builder: strings.Builder
             defer strings.builder_destroy(&rs_builder)
-            // Determine which add libs fit this specific runestone
-            add_libs_static := add_libs_for_runestone(
-                rs.plats,
-                rn.add_libs_static,
-            )
-            add_libs_shared := add_libs_for_runestone(
-                rs.plats,
-                rn.add_libs_shared,
-            )
-            defer delete(add_libs_static)
-            defer delete(add_libs_shared)
 
             errors.wrap(
                 generate_bindings_from_runestone(
@@ -615,8 +505,8 @@ generate_bindings :: proc(
                     strings.to_stream(&rs_builder),
                     rs_file_path,
                     package_name,
-                    add_libs_static,
-                    add_libs_shared,
+                    cross_infos[cross_idx].add_libs_static,
+                    cross_infos[cross_idx].add_libs_shared,
                 ),
             ) or_return
 
@@ -702,19 +592,6 @@ generate_bindings :: proc(
                     }
                 }
 
-                // Determine which add libs fit this specific runestone
-                add_libs_static := add_libs_for_runestone(
-                    rs.plats,
-                    rn.add_libs_static,
-                )
-                add_libs_shared := add_libs_for_runestone(
-                    rs.plats,
-                    rn.add_libs_shared,
-                )
-                defer delete(add_libs_static)
-                defer delete(add_libs_shared)
-
-
                 write_complete_foreign_import(
                     rs_wd,
                     rs_file_path,
@@ -722,8 +599,8 @@ generate_bindings :: proc(
                     rs.lib,
                     package_name,
                     rn.static_switch,
-                    add_libs_static,
-                    add_libs_shared,
+                    cross_infos[rs_idx].add_libs_static,
+                    cross_infos[rs_idx].add_libs_shared,
                     rn.ignore_arch,
                 ) or_return
 
@@ -1675,12 +1552,53 @@ import_path :: proc(
     return
 }
 
+// Adds the source of type to the imports if it is an extern type
+@(private = "file")
+collect_import :: proc(ic: ^ImportCollector, type: runic.Type) {
+    extern, is_extern := type.spec.(runic.ExternType)
+    if !is_extern do return
+
+    source, source_found := ic.sources[string(extern)]
+    if !source_found || source in ic.seen do return
+
+    ic.seen[source] = {}
+    append(ic.imports, source)
+}
+
+// Adds the sources of type and of the extern types of its members and parameters to the imports
+@(private = "file")
+collect_type_imports :: proc(ic: ^ImportCollector, type: runic.Type) {
+    #partial switch spec in type.spec {
+    case runic.ExternType:
+        collect_import(ic, type)
+    case runic.Struct:
+        for m in spec.members {
+            collect_import(ic, m.type)
+        }
+    case runic.Union:
+        for m in spec.members {
+            collect_import(ic, m.type)
+        }
+    case runic.FunctionPointer:
+        for p in spec.parameters {
+            collect_import(ic, p.type)
+        }
+        collect_import(ic, spec.return_type)
+    }
+}
+
 @(private = "file")
 add_libs_for_runestone :: proc(
     plats: []runic.Platform,
     rn_add_libs: runic.PlatformValue([]string),
+    allocator := context.allocator,
 ) -> [dynamic]AddLibs {
-    rs_add_libs := make([dynamic]AddLibs, len = 0, cap = len(rn_add_libs.d))
+    rs_add_libs := make(
+        [dynamic]AddLibs,
+        len = 0,
+        cap = len(rn_add_libs.d),
+        allocator = allocator,
+    )
 
     for add_lib_plat, add_libs in rn_add_libs.d {
         for rs_plat in plats {
@@ -95,6 +95,17 @@ get :: #force_inline proc(
     return
 }
 
+// Makes sure that capacity entries fit into m without growing it
+reserve :: #force_inline proc(
+    using m: ^OrderedMap($Key, $Value),
+    #any_int capacity: int,
+    loc := #caller_location,
+) -> runtime.Allocator_Error {
+    reserve_map(&indices, capacity, loc) or_return
+    reserve_dynamic_array(&data, capacity, loc) or_return
+    return .None
+}
+
 delete :: #force_inline proc(
     using m: OrderedMap($Key, $Value),
     loc := #caller_location,
@@ -115,11 +126,43 @@ delete_key :: #force_inline proc(
     ordered_remove(&data, idx, loc)
     runtime.delete_key(&indices, key)
 
-    for i, v in indices {
-        if v > idx {
-            indices[i] = v - 1
-        }
+    // Only the entries after the removed one have been shifted
+    for i := idx; i < len(data); i += 1 {
+        indices[data[i].key] = i
+    }
+}
+
+// Removes all keys at once. Keys that do not exist are ignored.
+// Use this instead of delete_key to delete many keys, since every delete_key needs to shift all following entries
+delete_keys :: proc(m: ^OrderedMap($Key, $Value), keys: []Key) {
+    for key in keys {
+        tombstone(m, key)
+    }
+    compact(m)
+}
+
+// Removes key from the indices, but leaves its entry inside data until compact is called
+@(private = "file")
+tombstone :: #force_inline proc(using m: ^OrderedMap($Key, $Value), key: Key) {
+    runtime.delete_key(&indices, key)
+}
+
+// Removes the entries of all tombstoned keys in one pass and updates the indices
+@(private = "file")
+compact :: proc(using m: ^OrderedMap($Key, $Value)) {
+    if len(indices) == len(data) do return
+
+    live: int
+    for i in 0 ..< len(data) {
+        entry := data[i]
+        // The entry has been tombstoned
+        if idx, ok := indices[entry.key]; !ok || idx != i do continue
+
+        data[live] = entry
+        indices[entry.key] = live
+        live += 1
     }
+    resize(&data, live)
 }
 
 length :: #force_inline proc(using m: OrderedMap($Key, $Value)) -> int {
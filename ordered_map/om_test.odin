@@ -176,3 +176,32 @@ test_ordered_map_move :: proc(t: ^testing.T) {
     expect_value(t, omap.indices["kiwi"], 6)
 }
 
+@(test)
+test_ordered_map_delete_keys :: proc(t: ^testing.T) {
+    using testing
+
+    omap := make(string, int)
+    defer delete(omap)
+
+    insert(&omap, "a", 0)
+    insert(&omap, "b", 1)
+    insert(&omap, "c", 2)
+    insert(&omap, "d", 3)
+    insert(&omap, "e", 4)
+
+    delete_keys(&omap, {"a", "c", "e", "f"})
+    insert(&omap, "c", 5)
+
+    expect_value(t, length(omap), 3)
+    expect(t, !contains(omap, "a"))
+
+    if expect_value(t, len(omap.data), 3) {
+        expect_value(t, omap.data[0].key, "b")
+        expect_value(t, omap.data[1].key, "d")
+        expect_value(t, omap.data[2].key, "c")
+        expect_value(t, omap.data[2].value, 5)
+    }
+    expect_value(t, omap.indices["b"], 0)
+    expect_value(t, omap.indices["d"], 1)
+    expect_value(t, omap.indices["c"], 2)
+}
@@ -0,0 +1,631 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package main
+
+import ccdg "c/codegen"
+import "console"
+import "core:fmt"
+import "core:os"
+import "core:path/filepath"
+import "core:slice"
+import "core:strings"
+import "core:thread"
+import "errors"
+import odincdg "odin/codegen"
+import "runic"
+import "stats"
+import "trace"
+
+DEFAULT_TO_FILE_NAME :: "runic.to"
+
+// Writes the bindings or runestones specified by the "to" of the rune. Errors are printed.
+// Files whose contents did not change are not touched.
+// If out_file_names is set, the paths of all written files are appended to it.
+// The runestones are preprocessed and the runes are crossed using up to `jobs` threads
+write_outputs :: proc(
+    rune: runic.Rune,
+    rune_file_name: string,
+    runestones: []runic.Runestone,
+    file_paths: []string,
+    jobs: int,
+    out_file_names: ^[dynamic]string = nil,
+) -> bool {
+    switch to in rune.to {
+    case runic.To:
+        return write_bindings(
+            rune,
+            to,
+            rune_file_name,
+            runestones,
+            file_paths,
+            jobs,
+            out_file_names,
+        )
+    case string:
+        return write_runestones(
+            to,
+            rune_file_name,
+            runestones,
+            out_file_names,
+        )
+    case []runic.ToTarget:
+        return write_targets(
+            rune,
+            to,
+            rune_file_name,
+            runestones,
+            file_paths,
+            jobs,
+            out_file_names,
+        )
+    }
+
+    return true
+}
+
+// Preprocesses and crosses the runestones and writes the bindings of to. Errors are printed.
+// The runestones are modified
+write_bindings :: proc(
+    rune: runic.Rune,
+    to: runic.To,
+    rune_file_name: string,
+    runestones: []runic.Runestone,
+    file_paths: []string,
+    jobs: int,
+    out_file_names: ^[dynamic]string = nil,
+) -> bool {
+    err: errors.Error
+
+    reserved_keywords: []string = ---
+    switch strings.to_lower(to.language, context.temp_allocator) {
+    case "c":
+        reserved_keywords = ccdg.C_RESERVED
+    case "odin":
+        reserved_keywords = odincdg.ODIN_RESERVED
+    case:
+        console.eprintfln("To Language \"{}\" is not supported", to.language)
+        return false
+    }
+
+    preprocess_runestones(runestones, to, reserved_keywords, jobs)
+
+    console.eprintln("Crossing the runes ...")
+    cross_span := trace.begin("cross_the_runes")
+    runecross, rc_err := runic.cross_the_runes(
+        file_paths[:],
+        runestones[:],
+        to.extern.sources,
+        jobs,
+    )
+    trace.end(cross_span)
+    if rc_err != nil {
+        console.eprintfln("failed to cross the runes: {}", rc_err)
+        return false
+    }
+    defer runic.runecross_destroy(&runecross, len(runestones) > 1)
+    stats.record_runecross("cross_the_runes", runecross)
+
+    out_file_name: string
+    make_out_name: if len(to.out) != 0 {
+        abs_out := runic.relative_to_file(
+            rune_file_name,
+            to.out,
+            context.temp_allocator,
+        )
+
+        dir := filepath.dir(abs_out)
+        defer delete(dir)
+
+        if !os.is_dir(dir) {
+            err = errors.wrap(os.make_directory(dir))
+            if err != nil {
+                console.eprintfln("failed to make output directory: {}", err)
+                return false
+            }
+        }
+        out_file_name = abs_out
+    } else {
+        out_file_name = DEFAULT_TO_FILE_NAME
+    }
+
+    out_file: runic.OutputFile
+    if err = runic.output_file_open(&out_file, out_file_name); err != nil {
+        console.eprintfln("failed to open to file: {}", err)
+        return false
+    }
+
+    console.eprintfln("Writing bindings for \"{}\" ...", to.language)
+    bindings_span := trace.begin("generate_bindings", to.language)
+
+    switch strings.to_lower(to.language, context.temp_allocator) {
+    case "odin":
+        err = errors.wrap(
+            odincdg.generate_bindings(
+                runecross,
+                to,
+                rune.platforms,
+                runic.output_file_writer(&out_file),
+                out_file_name,
+            ),
+        )
+    case "c":
+        err = errors.wrap(
+            ccdg.generate_bindings(
+                runecross,
+                to,
+                runic.output_file_writer(&out_file),
+            ),
+        )
+    case:
+        console.eprintfln("to language {} is not supported", to.language)
+        runic.output_file_close(&out_file, false)
+        return false
+    }
+
+    if close_err := runic.output_file_close(&out_file, err == nil);
+       err == nil {
+        err = close_err
+    }
+    trace.end(bindings_span)
+
+    if err != nil {
+        console.eprintfln(
+            "failed to generate bindings ({}) for \"{}\": {}",
+            out_file_name,
+            to.language,
+            err,
+        )
+        return false
+    }
+
+    if out_file.unchanged {
+        console.eprintfln(
+            "Bindings for \"{}\" did not change ({})",
+            to.language,
+            out_file_name,
+        )
+    } else {
+        console.eprintfln(
+            "Successfully generated bindings for \"{}\" ({})",
+            to.language,
+            out_file_name,
+        )
+    }
+
+    if out_file_names != nil do append(out_file_names, out_file_name)
+
+    return true
+}
+
+@(private = "file")
+PreprocessTask :: struct {
+    rs:                ^runic.Runestone,
+    to:                runic.To,
+    reserved_keywords: []string,
+    log:               console.Buffer,
+}
+
+// Preprocesses the runestones using up to `jobs` threads. Every runestone only
+// modifies its own arena, which is why they can be preprocessed concurrently.
+// The output is printed in the order of the runestones
+@(private = "file")
+preprocess_runestones :: proc(
+    runestones: []runic.Runestone,
+    to: runic.To,
+    reserved_keywords: []string,
+    jobs: int,
+) {
+    tasks := make([]PreprocessTask, len(runestones))
+    defer delete(tasks)
+
+    for &rs, idx in runestones {
+        tasks[idx] = PreprocessTask {
+            rs                = &rs,
+            to                = to,
+            reserved_keywords = reserved_keywords,
+        }
+        // The output of a single platform can not be confused with another one
+        tag := ""
+        if len(runestones) > 1 {
+            tag = fmt.tprintf("{}.{}", rs.platform.os, rs.platform.arch)
+        }
+        console.buffer_init(&tasks[idx].log, tag)
+    }
+    defer for &pp_task in tasks {
+        console.buffer_destroy(&pp_task.log)
+    }
+
+    thread_count := min(jobs, len(tasks))
+    if thread_count <= 1 {
+        for &pp_task in tasks {
+            preprocess_task(&pp_task)
+            console.flush(&pp_task.log)
+        }
+        return
+    }
+
+    pool: thread.Pool
+    thread.pool_init(&pool, context.allocator, thread_count)
+    defer thread.pool_destroy(&pool)
+
+    for &pp_task, idx in tasks {
+        thread.pool_add_task(
+            &pool,
+            context.allocator,
+            proc(task: thread.Task) {
+                preprocess_task(cast(^PreprocessTask)task.data)
+            },
+            &pp_task,
+            idx,
+        )
+    }
+
+    thread.pool_start(&pool)
+    thread.pool_finish(&pool)
+
+    for &pp_task in tasks {
+        console.flush(&pp_task.log)
+    }
+}
+
+@(private = "file")
+preprocess_task :: proc(task: ^PreprocessTask) {
+    prev_log := console.begin(&task.log)
+    defer console.end(prev_log)
+
+    trace.scope(
+        "to_preprocess_runestone",
+        task.rs.platform.os,
+        ".",
+        task.rs.platform.arch,
+    )
+    runic.to_preprocess_runestone(task.rs, task.to, task.reserved_keywords)
+    stats.record_runestone("to_preprocess", task.rs^)
+}
+
+// Writes the runestones to the runestone file(s) of to. Errors are printed
+write_runestones :: proc(
+    to: string,
+    rune_file_name: string,
+    runestones: []runic.Runestone,
+    out_file_names: ^[dynamic]string = nil,
+) -> bool {
+    err: errors.Error
+
+    rs_files := make(
+        []runic.OutputFile,
+        len(runestones),
+        context.temp_allocator,
+    )
+    rs_file_paths := make(
+        []string,
+        len(runestones),
+        context.temp_allocator,
+    )
+
+    if to == "stdout" {
+        if len(runestones) != 1 {
+            console.eprintln(
+                "Unable to write multiple runestones to stdout. If you want to output the runestone to stdout you are only able to provide one platform",
+            )
+            return false
+        }
+        rs_file_paths[0] = "stdout"
+        runic.output_file_from_handle(&rs_files[0], os.stdout, to)
+    } else {
+        for rs, idx in runestones {
+            runestone_file_name := to
+            if len(runestones) > 1 {
+                stem := filepath.stem(runestone_file_name)
+                ext := filepath.ext(runestone_file_name)
+                dir := filepath.dir(runestone_file_name)
+                file_name := fmt.aprintf(
+                    "{}-{}.{}{}",
+                    stem,
+                    rs.platform.os,
+                    rs.platform.arch,
+                    ext,
+                    allocator = context.temp_allocator,
+                )
+                runestone_file_name = filepath.join(
+                    {dir, file_name},
+                    context.temp_allocator,
+                )
+            }
+
+            rs_file_paths[idx] = runic.relative_to_file(
+                rune_file_name,
+                runestone_file_name,
+                context.temp_allocator,
+            )
+
+            if err = runic.output_file_open(
+                &rs_files[idx],
+                rs_file_paths[idx],
+            ); err != nil {
+                console.eprintfln(
+                    "failed to open to runestone file \"{}\": {}",
+                    rs_file_paths[idx],
+                    err,
+                )
+                for &rs_file in rs_files[:idx] {
+                    runic.output_file_close(&rs_file, false)
+                }
+                return false
+            }
+        }
+    }
+
+    for rs, idx in runestones {
+        trace.scope(
+            "write_runestone",
+            rs.platform.os,
+            ".",
+            rs.platform.arch,
+        )
+
+        err = errors.wrap(
+            runic.write_runestone(
+                rs,
+                runic.output_file_writer(&rs_files[idx]),
+                to,
+            ),
+        )
+        if close_err := runic.output_file_close(&rs_files[idx], err == nil);
+           err == nil {
+            err = close_err
+        }
+
+        if err != nil {
+            console.eprintfln(
+                "failed to write runestone {}.{}: {}",
+                rs.platform.os,
+                rs.platform.arch,
+                err,
+            )
+            for &rs_file in rs_files[idx + 1:] {
+                runic.output_file_close(&rs_file, false)
+            }
+            return false
+        }
+
+        if rs_files[idx].unchanged {
+            console.eprintfln(
+                "Runestone {}.{} did not change \"{}\"",
+                rs.platform.os,
+                rs.platform.arch,
+                rs_file_paths[idx],
+            )
+        } else {
+            console.eprintfln(
+                "Successfully generated runestone {}.{} \"{}\"",
+                rs.platform.os,
+                rs.platform.arch,
+                rs_file_paths[idx],
+            )
+        }
+
+        if out_file_names != nil && to != "stdout" {
+            append(out_file_names, rs_file_paths[idx])
+        }
+    }
+
+    return true
+}
+
+OutputTarget :: struct {
+    rune:           runic.Rune,
+    to:             runic.ToTarget,
+    rune_file_name: string,
+    runestones:     []runic.Runestone,
+    file_paths:     []string,
+    jobs:           int,
+    collect_outs:   bool,
+    out_file_names: [dynamic]string,
+    // Output of the target. It is printed in the order of the targets
+    log:            console.Buffer,
+    ok:             bool,
+}
+
+// Writes all targets of a rune with multiple "to". The runestones are only generated and postprocessed once.
+// Every target is written on its own thread using up to `jobs` threads in total.
+// The output of every target is buffered and printed in the order of the targets.
+// Bindings are generated from clones of the runestones, since preprocessing and crossing modifies them
+write_targets :: proc(
+    rune: runic.Rune,
+    targets: []runic.ToTarget,
+    rune_file_name: string,
+    runestones: []runic.Runestone,
+    file_paths: []string,
+    jobs: int,
+    out_file_names: ^[dynamic]string = nil,
+) -> bool {
+    if len(targets) == 0 do return true
+
+    thread_count := min(jobs, len(targets))
+    output_targets := make(
+        []OutputTarget,
+        len(targets),
+        context.temp_allocator,
+    )
+    for target, idx in targets {
+        output_targets[idx] = OutputTarget {
+            rune           = rune,
+            to             = target,
+            rune_file_name = rune_file_name,
+            runestones     = runestones,
+            file_paths     = file_paths,
+            jobs           = max(1, jobs / max(1, thread_count)),
+            collect_outs   = out_file_names != nil,
+        }
+        console.buffer_init(&output_targets[idx].log, "")
+    }
+    defer for &target in output_targets {
+        console.buffer_destroy(&target.log)
+    }
+
+    if thread_count <= 1 {
+        for &target in output_targets {
+            write_target(&target)
+            console.flush(&target.log)
+        }
+    } else {
+        pool: thread.Pool
+        thread.pool_init(&pool, context.allocator, thread_count)
+        defer thread.pool_destroy(&pool)
+
+        for &target, idx in output_targets {
+            thread.pool_add_task(
+                &pool,
+                context.allocator,
+                proc(task: thread.Task) {
+                    write_target(cast(^OutputTarget)task.data)
+                },
+                &target,
+                idx,
+            )
+        }
+
+        thread.pool_start(&pool)
+        thread.pool_finish(&pool)
+
+        for &target in output_targets {
+            console.flush(&target.log)
+        }
+    }
+
+    ok := true
+    for &target in output_targets {
+        // The file names are allocated by the threads of the targets which is why they are copied
+        for name in target.out_file_names {
+            if out_file_names != nil {
+                append(
+                    out_file_names,
+                    strings.clone(name, out_file_names.allocator),
+                )
+            }
+            delete(name)
+        }
+        delete(target.out_file_names)
+
+        if !target.ok do ok = false
+    }
+
+    return ok
+}
+
+@(private = "file")
+write_target :: proc(target: ^OutputTarget) {
+    prev_log := console.begin(&target.log)
+    defer console.end(prev_log)
+
+    out_file_names: ^[dynamic]string
+    if target.collect_outs {
+        target.out_file_names = make([dynamic]string)
+        out_file_names = &target.out_file_names
+    }
+
+    switch to in target.to {
+    case runic.To:
+        runestones := make([]runic.Runestone, len(target.runestones))
+        defer delete(runestones)
+        for rs, idx in target.runestones {
+            runestones[idx] = runic.runestone_clone(rs)
+        }
+        defer for &rs in runestones {
+            runic.runestone_destroy(&rs)
+        }
+
+        target.ok = write_bindings(
+            target.rune,
+            to,
+            target.rune_file_name,
+            runestones,
+            target.file_paths,
+            target.jobs,
+            out_file_names,
+        )
+    case string:
+        target.ok = write_runestones(
+            to,
+            target.rune_file_name,
+            target.runestones,
+            out_file_names,
+        )
+    }
+
+    // The names are allocated using the temp allocator of this thread
+    for &name in target.out_file_names {
+        name = strings.clone(name)
+    }
+}
+
+// Writes a depfile in the format understood by Make and Ninja, which declares that targets depend on dependencies
+write_depfile :: proc(
+    depfile_name: string,
+    targets: []string,
+    dependencies: []string,
+) -> bool {
+    if len(targets) == 0 {
+        console.eprintln("no output files have been written for the depfile")
+        return false
+    }
+
+    deps := slice.clone(dependencies, context.temp_allocator)
+    slice.sort(deps)
+    deps = slice.unique(deps)
+
+    depfile: strings.Builder
+    strings.builder_init(&depfile, context.temp_allocator)
+
+    for target, idx in targets {
+        if idx != 0 do strings.write_rune(&depfile, ' ')
+        write_depfile_path(&depfile, target)
+    }
+    strings.write_rune(&depfile, ':')
+
+    for dep in deps {
+        strings.write_string(&depfile, " \\\n ")
+        write_depfile_path(&depfile, dep)
+    }
+    strings.write_rune(&depfile, '\n')
+
+    if err := runic.write_file_atomic(
+        depfile_name,
+        depfile.buf[:],
+        context.temp_allocator,
+    ); err != nil {
+        console.eprintfln("failed to write depfile: {}", err)
+        return false
+    }
+
+    return true
+}
+
+@(private = "file")
+write_depfile_path :: proc(depfile: ^strings.Builder, path: string) {
+    for r in path {
+        switch r {
+        case ' ', '#':
+            strings.write_rune(depfile, '\\')
+        case '$':
+            strings.write_rune(depfile, '$')
+        }
+        strings.write_rune(depfile, r)
+    }
+}
@@ -17,19 +17,16 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 
 package main
 
-import ccdg "c/codegen"
 import "core:flags"
 import "core:fmt"
 import "core:os"
 import "core:path/filepath"
 import "core:strings"
-import cppcdg "cpp/codegen"
 import cppwrap "cpp/wrapper"
 import "errors"
-import odincdg "odin/codegen"
 import "runic"
-
-DEFAULT_TO_FILE_NAME :: "runic.to"
+import "stats"
+import "trace"
 
 main :: proc() {
     when ODIN_DEBUG {
@@ -48,6 +45,22 @@ main :: proc() {
         bool `args:"name=version" usage:"Print version and license information"`,
         credits:
         bool `args:"name=credits" usage:"Print credits to dependencies"`,
+        jobs:
+        int `args:"name=jobs" usage:"Number of threads used to generate the platforms and cross the runes (default: number of cores)"`,
+        watch:
+        bool `args:"name=watch" usage:"Keep running and regenerate whenever the rune or the files it depends on change"`,
+        cache_dir:
+        string `args:"name=cache-dir" usage:"Directory in which runestones generated from c headers are cached"`,
+        depfile:
+        string `args:"name=depfile" usage:"Write a Make/Ninja depfile listing all files the outputs depend on"`,
+        trace:
+        string `args:"name=trace" usage:"Write a Chrome trace (chrome://tracing) of the time spent in the different phases"`,
+        stats:
+        bool `args:"name=stats" usage:"Print memory and size statistics of the runestones"`,
+        stats_json:
+        string `args:"name=stats-json" usage:"Write memory and size statistics of the runestones as JSON"`,
+        convert:
+        string `args:"name=convert" usage:"Convert the runestone given instead of the rune between the text and the binary encoding and write it to this file"`,
         rune_file_name:
         string `args:"pos=0,name=rune" usage:"The rune configuration file to load"`,
     }
@@ -76,6 +89,13 @@ main :: proc() {
         panic("unreachable")
     }
 
+    if args.jobs <= 0 do args.jobs = os.processor_core_count()
+
+    cache_dir: Maybe(string)
+    if len(args.cache_dir) != 0 {
+        cache_dir = args.cache_dir
+    }
+
     if args.version {
         print_version()
         os.exit(0)
@@ -84,6 +104,15 @@ main :: proc() {
         os.exit(0)
     }
 
+    if len(args.convert) != 0 {
+        if len(args.rune_file_name) == 0 {
+            fmt.eprintln("no runestone to convert has been specified")
+            os.exit(1)
+        }
+        if !convert_runestone(args.rune_file_name, args.convert) do os.exit(1)
+        os.exit(0)
+    }
+
     rune_file_name := args.rune_file_name
     if len(rune_file_name) == 0 {
         canditates := [?]string{"rune.yml", "rune.yaml", "rune.json"}
@@ -107,8 +136,6 @@ main :: proc() {
         }
     }
 
-    host_plat := runic.platform_from_host()
-
     if !filepath.is_abs(rune_file_name) {
         cwd := os.get_current_directory()
         defer delete(cwd)
@@ -118,44 +145,29 @@ main :: proc() {
         )
     }
 
-    rune_file, os_err := os.open(rune_file_name)
-    if err := errors.wrap(os_err); err != nil {
-        fmt.eprintfln("failed to open rune file: {}", err)
-        os.exit(1)
+    if args.watch {
+        // The trace and the statistics are written when runic exits, which never happens in watch mode
+        if len(args.trace) != 0 || args.stats || len(args.stats_json) != 0 {
+            fmt.eprintln(
+                "--trace, --stats and --stats-json can not be used together with --watch",
+            )
+            os.exit(1)
+        }
+        watch(strings.clone(rune_file_name), args.jobs)
     }
-    defer os.close(rune_file)
 
-    err: errors.Error
-    rune, rune_err := runic.parse_rune(
-        os.stream_from_handle(rune_file),
-        rune_file_name,
-    )
-    err = errors.wrap(rune_err)
-    defer runic.rune_destroy(&rune)
-    if err != nil {
-        fmt.eprintfln("failed to parse rune file: {}", err)
-        os.exit(1)
-    }
+    if len(args.trace) != 0 do trace.enable()
+    defer trace.destroy()
+    if args.stats || len(args.stats_json) != 0 do stats.enable()
+    defer stats.destroy()
 
-    if rune.version != 0 {
-        fmt.eprintfln("rune version {} is not supported", rune.version)
-        os.exit(1)
-    }
+    rune, rune_ok := load_rune(rune_file_name)
+    defer runic.rune_destroy(&rune)
+    if !rune_ok do os.exit(1)
 
-    plats: []runic.Platform = ---
-    if len(rune.platforms) != 0 {
-        plats = rune.platforms
-    } else {
-        platties := make(
-            [dynamic]runic.Platform,
-            allocator = context.temp_allocator,
-            len = 0,
-            cap = len(rune.platforms),
-        )
-        append(&platties, host_plat)
-        plats = platties[:]
-    }
+    plats := rune_platforms(rune)
 
+    err: errors.Error
     if wrapper, ok := rune.wrapper.?; ok {
         switch strings.to_lower(wrapper.language, context.temp_allocator) {
         case "c", "cpp", "c++", "cxx":
@@ -194,337 +206,244 @@ main :: proc() {
         [dynamic]runic.Runestone,
         allocator = context.temp_allocator,
         len = 0,
-        cap = len(rune.platforms),
+        cap = len(plats),
     )
     file_paths := make(
         [dynamic]string,
         allocator = context.temp_allocator,
         len = 0,
-        cap = len(rune.platforms),
+        cap = len(plats),
     )
 
     defer for &stone in runestones {
         runic.runestone_destroy(&stone)
     }
 
-    switch from in rune.from {
-    case runic.From:
-        for plat in plats {
-            rs: runic.Runestone = ---
+    write_deps := len(args.depfile) != 0
+    dependencies := make([dynamic]string, context.temp_allocator)
+    out_file_names := make([dynamic]string, context.temp_allocator)
+    append(&dependencies, rune_file_name)
 
-            switch strings.to_lower(from.language, context.temp_allocator) {
-            case "c", "cpp", "cxx", "c++":
-                rs, err = cppcdg.generate_runestone(plat, rune_file_name, from)
-            case "odin":
-                when ODIN_OS == .FreeBSD {
-                    fmt.eprintfln("from odin is not supported on FreeBSD")
-                    os.exit(1)
-                } else {
-                    rs, err = odincdg.generate_runestone(
-                        plat,
-                        rune_file_name,
-                        from,
-                    )
-                }
-            case:
-                fmt.eprintfln(
-                    "from language {} is not supported",
-                    from.language,
-                )
-                os.exit(1)
-            }
+    if !load_runestones(
+        rune,
+        rune_file_name,
+        plats,
+        args.jobs,
+        cache_dir,
+        &runestones,
+        &file_paths,
+        &dependencies if write_deps else nil,
+    ) {
+        os.exit(1)
+    }
 
-            if err != nil {
-                fmt.eprintfln(
-                    "\"{}\" Runestone {}.{} Failed: {}",
-                    from.language,
-                    plat.os,
-                    plat.arch,
-                    err,
-                )
-                continue
-            }
+    if !write_outputs(
+        rune,
+        rune_file_name,
+        runestones[:],
+        file_paths[:],
+        args.jobs,
+        &out_file_names if write_deps else nil,
+    ) {
+        os.exit(1)
+    }
 
-            runic.from_postprocess_runestone(&rs, from)
+    if write_deps &&
+       !write_depfile(args.depfile, out_file_names[:], dependencies[:]) {
+        os.exit(1)
+    }
 
-            append(&runestones, rs)
-            append(&file_paths, "")
+    if len(args.trace) != 0 {
+        if err = trace.write(args.trace); err != nil {
+            fmt.eprintfln("failed to write trace: {}", err)
+            os.exit(1)
+        }
+    }
 
-            fmt.eprintfln(
-                "\"{}\" Runestone {}.{} Success",
-                from.language,
-                plat.os,
-                plat.arch,
-            )
+    if args.stats {
+        stats.print(os.stream_from_handle(os.stderr))
+    }
+    if len(args.stats_json) != 0 {
+        if err = stats.write_json(args.stats_json); err != nil {
+            fmt.eprintfln("failed to write stats: {}", err)
+            os.exit(1)
         }
+    }
+}
+
+// Converts the runestone at in_path between the text and the binary encoding and writes it to out_path. Errors are printed
+convert_runestone :: proc(in_path, out_path: string) -> bool {
+    rs, err := runic.load_runestone(in_path)
+    defer runic.runestone_destroy(&rs)
+    if err != nil {
+        fmt.eprintfln("failed to load runestone: {}", err)
+        return false
+    }
+
+    to_binary := !runic.is_runestone_binary(rs.mapping)
+
+    out_file: runic.OutputFile
+    if err = runic.output_file_open(&out_file, out_path); err != nil {
+        fmt.eprintfln("failed to open to runestone file: {}", err)
+        return false
+    }
+
+    if to_binary {
+        err = errors.wrap(
+            runic.write_runestone_binary(
+                rs,
+                runic.output_file_writer(&out_file),
+                out_path,
+            ),
+        )
+    } else {
+        err = errors.wrap(
+            runic.write_runestone(
+                rs,
+                runic.output_file_writer(&out_file),
+                out_path,
+            ),
+        )
+    }
+    if close_err := runic.output_file_close(&out_file, err == nil);
+       err == nil {
+        err = close_err
+    }
+
+    if err != nil {
+        fmt.eprintfln("failed to write runestone \"{}\": {}", out_path, err)
+        return false
+    }
+
+    fmt.eprintfln(
+        "Successfully converted runestone to the {} encoding \"{}\"",
+        "binary" if to_binary else "text",
+        out_path,
+    )
+    return true
+}
+
+// Opens and parses the rune. Errors are printed
+load_rune :: proc(rune_file_name: string) -> (rune: runic.Rune, ok: bool) {
+    rune_file, os_err := os.open(rune_file_name)
+    if err := errors.wrap(os_err); err != nil {
+        fmt.eprintfln("failed to open rune file: {}", err)
+        return
+    }
+    defer os.close(rune_file)
+
+    rune_err: errors.Error = ---
+    rune, rune_err = runic.parse_rune(
+        os.stream_from_handle(rune_file),
+        rune_file_name,
+    )
+    if rune_err != nil {
+        fmt.eprintfln("failed to parse rune file: {}", rune_err)
+        return
+    }
+
+    if rune.version != 0 {
+        fmt.eprintfln("rune version {} is not supported", rune.version)
+        return
+    }
+
+    ok = true
+    return
+}
+
+// Returns the platforms of the rune or the host platform if none are specified
+rune_platforms :: proc(
+    rune: runic.Rune,
+    allocator := context.temp_allocator,
+) -> []runic.Platform {
+    if len(rune.platforms) != 0 do return rune.platforms
+
+    plats := make([]runic.Platform, 1, allocator)
+    plats[0] = runic.platform_from_host()
+    return plats
+}
+
+// Generates the runestones from the rune or loads them from runestone files. Errors are printed.
+// If dependencies is set, all files that have been read to create the runestones are appended to it
+load_runestones :: proc(
+    rune: runic.Rune,
+    rune_file_name: string,
+    plats: []runic.Platform,
+    jobs: int,
+    cache_dir: Maybe(string),
+    runestones: ^[dynamic]runic.Runestone,
+    file_paths: ^[dynamic]string,
+    dependencies: ^[dynamic]string = nil,
+) -> bool {
+    err: errors.Error
+
+    switch from in rune.from {
+    case runic.From:
+        generate_runestones(
+            plats,
+            rune_file_name,
+            from,
+            jobs,
+            cache_dir,
+            runestones,
+            file_paths,
+            dependencies,
+        )
     case string:
-        rs_file: os.Handle = ---
+        rs: runic.Runestone = ---
         rs_file_name: string = ---
         if from == "stdin" {
-            rs_file = os.stdin
             rs_file_name = "/stdin"
+            rs, err = runic.parse_runestone(
+                os.stream_from_handle(os.stdin),
+                rs_file_name,
+            )
         } else {
             rs_file_name = runic.relative_to_file(
                 rune_file_name,
                 from,
                 context.temp_allocator,
             )
-
-            rs_file, os_err = os.open(rs_file_name)
-            if err = errors.wrap(os_err); err != nil {
-                fmt.eprintfln("failed to open runestone file: {}", err)
-                os.exit(1)
-            }
+            rs, err = runic.load_runestone(rs_file_name)
         }
-        defer if from != "stdin" do os.close(rs_file)
-
-        rs: runic.Runestone = ---
-        rs, err = runic.parse_runestone(
-            os.stream_from_handle(rs_file),
-            rs_file_name,
-        )
         if err != nil {
             fmt.eprintfln("failed to parse runestone: {}", err)
-            os.exit(1)
+            return false
         }
 
         fmt.eprintfln("Successfully parsed runestone ({})", from)
+        stats.record_runestone("load", rs)
+
+        if dependencies != nil && from != "stdin" {
+            append(dependencies, rs_file_name)
+        }
 
-        append(&runestones, rs)
-        append(&file_paths, rs_file_name)
+        append(runestones, rs)
+        append(file_paths, rs_file_name)
     case [dynamic]string:
         for file_path in from {
-            rs: runic.Runestone = ---
-            rs_file: os.Handle = ---
             rs_file_name := runic.relative_to_file(
                 rune_file_name,
                 file_path,
                 context.temp_allocator,
             )
 
-            rs_file, os_err = os.open(rs_file_name)
-            if err = errors.wrap(os_err); err != nil {
-                fmt.eprintfln("failed to open runestone file: {}", err)
-                os.exit(1)
-            }
-            defer os.close(rs_file)
-
-            rs, err = runic.parse_runestone(
-                os.stream_from_handle(rs_file),
-                file_path,
-            )
+            rs: runic.Runestone = ---
+            rs, err = runic.load_runestone(rs_file_name)
             if err != nil {
                 fmt.eprintfln("failed to parse runestone: {}", err)
-                os.exit(1)
+                return false
             }
 
             fmt.eprintfln("Successfully parsed runestone ({})", file_path)
+            stats.record_runestone("load", rs)
 
-            append(&runestones, rs)
-        }
-
-        file_paths = from
-    }
-
-    switch to in rune.to {
-    case runic.To:
-        reserved_keywords: []string = ---
-        switch strings.to_lower(to.language, context.temp_allocator) {
-        case "c":
-            reserved_keywords = ccdg.C_RESERVED
-        case "odin":
-            reserved_keywords = odincdg.ODIN_RESERVED
-        case:
-            fmt.eprintfln("To Language \"{}\" is not supported", to.language)
-            os.exit(1)
-        }
-
-        for &rs in runestones {
-            runic.to_preprocess_runestone(&rs, to, reserved_keywords)
-        }
-
-        fmt.eprintln("Crossing the runes ...")
-        runecross, rc_err := runic.cross_the_runes(
-            file_paths[:],
-            runestones[:],
-            to.extern.sources,
-        )
-        if rc_err != nil {
-            fmt.eprintfln("failed to cross the runes: {}", rc_err)
-            os.exit(1)
-        }
-        defer runic.runecross_destroy(&runecross, len(runestones) > 1)
-
-        out_file_name: string
-        make_out_name: if len(to.out) != 0 {
-            abs_out := runic.relative_to_file(
-                rune_file_name,
-                to.out,
-                context.temp_allocator,
-            )
-
-            dir := filepath.dir(abs_out)
-            defer delete(dir)
-
-            if !os.is_dir(dir) {
-                err = errors.wrap(os.make_directory(dir))
-                if err != nil {
-                    fmt.eprintfln("failed to make output directory: {}", err)
-                    os.exit(1)
-                }
-            }
-            out_file_name = abs_out
-        } else {
-            out_file_name = DEFAULT_TO_FILE_NAME
-        }
+            if dependencies != nil do append(dependencies, rs_file_name)
 
-        out_file, out_err := os.open(
-            out_file_name,
-            os.O_WRONLY | os.O_CREATE | os.O_TRUNC,
-            0o644,
-        )
-        if err = errors.wrap(out_err); err != nil {
-            fmt.eprintfln("failed to open to file: {}", err)
-            os.exit(1)
-        }
-        defer os.close(out_file)
-
-        fmt.eprintfln("Writing bindings for \"{}\" ...", to.language)
-
-        switch strings.to_lower(to.language, context.temp_allocator) {
-        case "odin":
-            err = errors.wrap(
-                odincdg.generate_bindings(
-                    runecross,
-                    to,
-                    rune.platforms,
-                    os.stream_from_handle(out_file),
-                    out_file_name,
-                ),
-            )
-        case "c":
-            err = errors.wrap(
-                ccdg.generate_bindings(
-                    runecross,
-                    to,
-                    os.stream_from_handle(out_file),
-                ),
-            )
-        case:
-            fmt.eprintfln("to language {} is not supported", to.language)
-            return
-        }
-
-        if err != nil {
-            fmt.eprintfln(
-                "failed to generate bindings ({}) for \"{}\": {}",
-                out_file_name,
-                to.language,
-                err,
-            )
-            os.exit(1)
-        }
-
-        fmt.eprintfln(
-            "Successfully generated bindings for \"{}\" ({})",
-            to.language,
-            out_file_name,
-        )
-    case string:
-        rs_files := make(
-            [dynamic]os.Handle,
-            allocator = context.temp_allocator,
-            len = 0,
-            cap = len(runestones),
-        )
-        rs_file_paths := make(
-            [dynamic]string,
-            allocator = context.temp_allocator,
-            len = 0,
-            cap = len(runestones),
-        )
-
-        if to == "stdout" {
-            if len(runestones) != 1 {
-                fmt.eprintln(
-                    "Unable to write multiple runestones to stdout. If you want to output the runestone to stdout you are only able to provide one platform",
-                )
-                os.exit(1)
-            }
-            append(&rs_files, os.stdout)
-        } else {
-            for rs in runestones {
-                runestone_file_name := to
-                if len(runestones) > 1 {
-                    stem := filepath.stem(runestone_file_name)
-                    ext := filepath.ext(runestone_file_name)
-                    dir := filepath.dir(runestone_file_name)
-                    file_name := fmt.aprintf(
-                        "{}-{}.{}{}",
-                        stem,
-                        rs.platform.os,
-                        rs.platform.arch,
-                        ext,
-                        allocator = context.temp_allocator,
-                    )
-                    runestone_file_name = filepath.join(
-                        {dir, file_name},
-                        context.temp_allocator,
-                    )
-                }
-
-                rs_file_path := runic.relative_to_file(
-                    rune_file_name,
-                    runestone_file_name,
-                    context.temp_allocator,
-                )
-
-                rs_file: os.Handle = ---
-                rs_file, os_err = os.open(
-                    rs_file_path,
-                    os.O_WRONLY | os.O_CREATE | os.O_TRUNC,
-                    0o644,
-                )
-                if err = errors.wrap(os_err); err != nil {
-                    fmt.eprintfln(
-                        "failed to open to runestone file \"{}\": {}",
-                        rs_file_path,
-                        err,
-                    )
-                    return
-                }
-
-                append(&rs_files, rs_file)
-                append(&rs_file_paths, rs_file_path)
-            }
-        }
-        defer if to != "stdout" do for rs_file in rs_files {
-            os.close(rs_file)
-        }
-
-        for rs, idx in runestones {
-            if err = errors.wrap(
-                runic.write_runestone(
-                    rs,
-                    os.stream_from_handle(rs_files[idx]),
-                    to,
-                ),
-            ); err != nil {
-                fmt.eprintfln(
-                    "failed to write runestone {}.{}: {}",
-                    rs.platform.os,
-                    rs.platform.arch,
-                    err,
-                )
-                os.exit(1)
-            }
-
-            fmt.eprintfln(
-                "Successfully generated runestone {}.{} \"{}\"",
-                rs.platform.os,
-                rs.platform.arch,
-                rs_file_paths[idx],
-            )
+            append(runestones, rs)
+            append(file_paths, file_path)
         }
     }
+
+    return true
 }
@@ -0,0 +1,262 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package runic
+
+import "base:runtime"
+import "core:bufio"
+import "core:fmt"
+import "core:io"
+import "core:math/rand"
+import "core:os"
+import "core:slice"
+import "core:sync"
+import "root:errors"
+
+OUTPUT_BUFFER_SIZE :: 64 * 1024
+// Permissions of output files that do not exist yet
+OUTPUT_FILE_MODE :: 0o644
+
+// A file that is written through a large buffer into a temporary file, which is renamed
+// to the actual file path when it is closed. This way readers never see partially written files.
+// If the file already exists with the same contents it is not touched, so that its modification time stays the same.
+// The contents are compared to the existing file while they are written, so that neither file needs to be read again.
+// An OutputFile must not be moved while it is open.
+OutputFile :: struct {
+    file_path:     string,
+    // Empty if the output is written to a handle that is not owned (e.g. stdout)
+    temp_path:     string,
+    handle:        os.Handle,
+    buffer:        bufio.Writer,
+    allocator:     runtime.Allocator,
+    // The file that is replaced or os.INVALID_HANDLE if it does not exist
+    existing:      os.Handle,
+    existing_size: i64,
+    written:       i64,
+    // Set as soon as the written contents differ from the existing file
+    differs:       bool,
+    compare_buf:   []byte,
+    // Set by output_file_close if the file already had the written contents and has therefore not been replaced
+    unchanged:     bool,
+}
+
+output_file_open :: proc(
+    of: ^OutputFile,
+    file_path: string,
+    allocator := context.allocator,
+) -> errors.Error {
+    of^ = {}
+    of.file_path = file_path
+    of.allocator = allocator
+    of.temp_path = fmt.aprintf(
+        "{}.tmp-{}-{:x}",
+        file_path,
+        sync.current_thread_id(),
+        rand.uint64(),
+        allocator = allocator,
+    )
+
+    mode := OUTPUT_FILE_MODE
+    of.existing = os.INVALID_HANDLE
+    of.differs = true
+    if existing, open_err := os.open(file_path); open_err == nil {
+        if fi, stat_err := os.fstat(existing, allocator); stat_err == nil {
+            of.existing = existing
+            of.existing_size = fi.size
+            of.differs = false
+            when ODIN_OS != .Windows {
+                // Keep the permissions of the file that is replaced
+                mode = int(fi.mode) & 0o7777
+            }
+            os.file_info_delete(fi, allocator)
+        } else {
+            os.close(existing)
+        }
+    }
+
+    os_err: os.Error = ---
+    of.handle, os_err = os.open(
+        of.temp_path,
+        os.O_WRONLY | os.O_CREATE | os.O_TRUNC,
+        mode,
+    )
+    if os_err != nil {
+        if of.existing != os.INVALID_HANDLE do os.close(of.existing)
+        delete(of.temp_path, allocator)
+        of.temp_path = ""
+        return errors.message("failed to open \"{}\": {}", file_path, os_err)
+    }
+
+    bufio.writer_init(
+        &of.buffer,
+        io.Stream{procedure = output_file_stream_proc, data = of},
+        OUTPUT_BUFFER_SIZE,
+        allocator,
+    )
+    return nil
+}
+
+// Buffers the writes into handle. The handle is neither closed nor renamed by output_file_close
+output_file_from_handle :: proc(
+    of: ^OutputFile,
+    handle: os.Handle,
+    file_path: string,
+    allocator := context.allocator,
+) {
+    of.file_path = file_path
+    of.handle = handle
+    of.allocator = allocator
+    of.existing = os.INVALID_HANDLE
+    bufio.writer_init(
+        &of.buffer,
+        os.stream_from_handle(handle),
+        OUTPUT_BUFFER_SIZE,
+        allocator,
+    )
+}
+
+output_file_writer :: proc(of: ^OutputFile) -> io.Writer {
+    return bufio.writer_to_writer(&of.buffer)
+}
+
+// Flushes all buffered writes and replaces the file with the temporary file if the contents differ.
+// If commit is false the temporary file is removed and the file is left untouched.
+output_file_close :: proc(of: ^OutputFile, commit := true) -> errors.Error {
+    flush_err := bufio.writer_flush(&of.buffer)
+    bufio.writer_destroy(&of.buffer)
+
+    if len(of.temp_path) == 0 {
+        return errors.wrap(flush_err, "failed to flush output: ")
+    }
+    defer delete(of.temp_path, of.allocator)
+
+    os.close(of.handle)
+
+    // The existing file needs to be closed before it can be replaced on Windows
+    if of.existing != os.INVALID_HANDLE do os.close(of.existing)
+    delete(of.compare_buf, of.allocator)
+
+    if !commit {
+        os.remove(of.temp_path)
+        return nil
+    }
+
+    if flush_err != .None {
+        os.remove(of.temp_path)
+        return errors.message(
+            "failed to write \"{}\": {}",
+            of.file_path,
+            flush_err,
+        )
+    }
+
+    if !of.differs && of.written == of.existing_size {
+        os.remove(of.temp_path)
+        of.unchanged = true
+        return nil
+    }
+
+    if rename_err := os.rename(of.temp_path, of.file_path); rename_err != nil {
+        os.remove(of.temp_path)
+        return errors.message(
+            "failed to rename \"{}\" to \"{}\": {}",
+            of.temp_path,
+            of.file_path,
+            rename_err,
+        )
+    }
+
+    return nil
+}
+
+// Atomically replaces the contents of file_path with data
+write_file_atomic :: proc(
+    file_path: string,
+    data: []byte,
+    allocator := context.allocator,
+) -> errors.Error {
+    of: OutputFile
+    output_file_open(&of, file_path, allocator) or_return
+
+    _, write_err := io.write(output_file_writer(&of), data)
+    if write_err != .None {
+        output_file_close(&of, false)
+        return errors.message(
+            "failed to write \"{}\": {}",
+            file_path,
+            write_err,
+        )
+    }
+
+    return output_file_close(&of)
+}
+
+// Writes into the temporary file and compares the written bytes to the existing file
+@(private = "file")
+output_file_stream_proc :: proc(
+    stream_data: rawptr,
+    mode: io.Stream_Mode,
+    p: []byte,
+    offset: i64,
+    whence: io.Seek_From,
+) -> (
+    n: i64,
+    err: io.Error,
+) {
+    of := cast(^OutputFile)stream_data
+
+    #partial switch mode {
+    case .Write:
+        written, write_err := os.write(of.handle, p)
+        n = i64(written)
+        if write_err != nil do return n, .Unknown
+
+        if !of.differs do output_file_compare(of, p[:written])
+        of.written += n
+        return
+    case .Query:
+        return io.query_utility({.Write, .Query})
+    }
+
+    return 0, .Empty
+}
+
+// Compares data to the next bytes of the existing file
+@(private = "file")
+output_file_compare :: proc(of: ^OutputFile, data: []byte) {
+    if of.written + i64(len(data)) > of.existing_size {
+        of.differs = true
+        return
+    }
+
+    if of.compare_buf == nil {
+        of.compare_buf = make([]byte, OUTPUT_BUFFER_SIZE, of.allocator)
+    }
+
+    rest := data
+    for len(rest) != 0 {
+        chunk := of.compare_buf[:min(len(rest), len(of.compare_buf))]
+        read, read_err := os.read_full(of.existing, chunk)
+        if read_err != nil ||
+           read != len(chunk) ||
+           !slice.equal(chunk, rest[:len(chunk)]) {
+            of.differs = true
+            return
+        }
+        rest = rest[len(chunk):]
+    }
+}
@@ -0,0 +1,74 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package runic
+
+import "core:io"
+import "core:os"
+import "core:testing"
+
+@(test)
+test_output_file :: proc(t: ^testing.T) {
+    using testing
+
+    OUT_PATH :: "test_data/output_file_test.txt"
+    os.remove(OUT_PATH)
+    defer os.remove(OUT_PATH)
+
+    of: OutputFile
+    if !expect_value(t, output_file_open(&of, OUT_PATH), nil) do return
+    io.write_string(output_file_writer(&of), "discarded")
+    expect_value(t, output_file_close(&of, false), nil)
+    expect(t, !os.exists(OUT_PATH))
+
+    if !expect_value(t, output_file_open(&of, OUT_PATH), nil) do return
+    io.write_string(output_file_writer(&of), "Hello ")
+    io.write_string(output_file_writer(&of), "World")
+    // Nothing is visible before the file is closed
+    expect(t, !os.exists(OUT_PATH))
+    if !expect_value(t, output_file_close(&of), nil) do return
+
+    data, ok := os.read_entire_file(OUT_PATH)
+    if !expect(t, ok) do return
+    defer delete(data)
+
+    expect_value(t, string(data), "Hello World")
+    expect(t, !of.unchanged)
+
+    of = {}
+    if !expect_value(t, output_file_open(&of, OUT_PATH), nil) do return
+    io.write_string(output_file_writer(&of), "Hello World")
+    if !expect_value(t, output_file_close(&of), nil) do return
+    expect(t, of.unchanged)
+
+    // Same size, different contents
+    if !expect_value(t, output_file_open(&of, OUT_PATH), nil) do return
+    io.write_string(output_file_writer(&of), "Hello Wprld")
+    if !expect_value(t, output_file_close(&of), nil) do return
+    expect(t, !of.unchanged)
+
+    // Prefix of the existing contents
+    if !expect_value(t, output_file_open(&of, OUT_PATH), nil) do return
+    io.write_string(output_file_writer(&of), "Hello")
+    if !expect_value(t, output_file_close(&of), nil) do return
+    expect(t, !of.unchanged)
+
+    data2, ok2 := os.read_entire_file(OUT_PATH)
+    if !expect(t, ok2) do return
+    defer delete(data2)
+    expect_value(t, string(data2), "Hello")
+}
@@ -0,0 +1,75 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+package runic
+
+PLATFORM_SET_BITS :: len(OS) * len(Architecture)
+#assert(PLATFORM_SET_BITS <= 32)
+
+// A set of platforms with one bit for every combination of OS and Architecture.
+// Platforms containing Any are expanded into the platforms they cover.
+PlatformSet :: distinct bit_set[0 ..< PLATFORM_SET_BITS;u32]
+
+platform_bit :: #force_inline proc "contextless" (plat: Platform) -> int {
+    return int(plat.os) * len(Architecture) + int(plat.arch)
+}
+
+platform_of_bit :: #force_inline proc "contextless" (bit: int) -> Platform {
+    return Platform {
+        os = OS(bit / len(Architecture)),
+        arch = Architecture(bit % len(Architecture)),
+    }
+}
+
+// Returns all platforms of within that are covered by plat
+platform_set_of_platform :: proc(
+    plat: Platform,
+    within: PlatformSet,
+) -> (
+    set: PlatformSet,
+) {
+    for bit in within {
+        p := platform_of_bit(bit)
+        if (plat.os == .Any || plat.os == p.os) &&
+           (plat.arch == .Any || plat.arch == p.arch) {
+            set += {bit}
+        }
+    }
+    return
+}
+
+platform_set_of_platforms :: proc(
+    plats: []Platform,
+    within: PlatformSet,
+) -> (
+    set: PlatformSet,
+) {
+    for plat in plats {
+        set += platform_set_of_platform(plat, within)
+    }
+    return
+}
+
+platform_set_of :: proc {
+    platform_set_of_platform,
+    platform_set_of_platforms,
+}
+
+// Returns the next more common platform of plat. Linux.x86_64 -> Linux.Any -> Any.Any and Any.x86_64 -> Any.Any
+more_common_platform :: proc(plat: Platform) -> Platform {
+    if plat.arch == .Any do return Platform{os = .Any, arch = .Any}
+    return Platform{os = plat.os, arch = .Any}
+}
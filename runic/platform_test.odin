@@ -84,3 +84,53 @@ test_minimize_platforms :: proc(t: ^testing.T) {
     }
 }
 
+
+@(test)
+test_platform_set :: proc(t: ^testing.T) {
+    using testing
+
+    origin := PlatformSet {
+        platform_bit({.Linux, .x86_64}),
+        platform_bit({.Linux, .arm64}),
+        platform_bit({.Windows, .x86_64}),
+        platform_bit({.Macos, .arm64}),
+    }
+
+    expect_value(
+        t,
+        platform_of_bit(platform_bit({.Macos, .arm64})),
+        Platform{.Macos, .arm64},
+    )
+
+    linux := platform_set_of(Platform{.Linux, .Any}, origin)
+    expect_value(t, card(linux), 2)
+    expect(t, platform_bit({.Linux, .x86_64}) in linux)
+    expect(t, platform_bit({.Linux, .arm64}) in linux)
+
+    x86_64 := platform_set_of(Platform{.Any, .x86_64}, origin)
+    expect_value(t, card(x86_64), 2)
+    expect(t, platform_bit({.Windows, .x86_64}) in x86_64)
+
+    expect_value(t, platform_set_of(Platform{.Any, .Any}, origin), origin)
+    expect_value(
+        t,
+        platform_set_of([]Platform{{.Linux, .Any}, {.Macos, .arm64}}, origin),
+        linux + {platform_bit({.Macos, .arm64})},
+    )
+
+    expect_value(
+        t,
+        more_common_platform({.Linux, .x86_64}),
+        Platform{.Linux, .Any},
+    )
+    expect_value(
+        t,
+        more_common_platform({.Linux, .Any}),
+        Platform{.Any, .Any},
+    )
+    expect_value(
+        t,
+        more_common_platform({.Any, .arm64}),
+        Platform{.Any, .Any},
+    )
+}
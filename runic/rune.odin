@@ -596,6 +596,7 @@ parse_rune :: proc(
                 f.disable_stdint_macros = make_platform_value(bool)
                 f.flags = make_platform_value([]cstring)
                 f.load_all_includes = make_platform_value(bool)
+                f.umbrella = make_platform_value(bool)
                 f.forward_decl_type = make_platform_value(Type)
                 f.packages = make_platform_value([]string)
                 f.remaps = make(map[string]string)
@@ -1592,6 +1593,18 @@ parse_rune :: proc(
                         )
                         return
                     }
+                case "umbrella":
+                    #partial switch v in value {
+                    case bool:
+                        f.umbrella.d[plat] = v
+                    case:
+                        err = errors.message(
+                            "\"from.{}\" has invalid type %T",
+                            key,
+                            v,
+                        )
+                        return
+                    }
                 case "forward_decl_type":
                     #partial switch v in value {
                     case string:
@@ -1805,880 +1818,967 @@ parse_rune :: proc(
 
         #partial switch to in y["to"] {
         case yaml.Mapping:
-            t: To
-
-            if language, ok := to["language"]; ok {
-                t.language, ok = language.(string)
-                errors.wrap(ok, "\"to.language\" has invalid type") or_return
-            } else {
-                err = errors.message("\"to.language\" is missing")
-                return
+            rn.to = parse_to(to, file_path, rn_arena_alloc) or_return
+        case string:
+            rn.to = to_runestone_path(to, file_path, rn_arena_alloc)
+        case yaml.Sequence:
+            targets := make([]ToTarget, len(to), rn_arena_alloc)
+            for target_value, idx in to {
+                #partial switch target in target_value {
+                case yaml.Mapping:
+                    targets[idx], err = parse_to(
+                        target,
+                        file_path,
+                        rn_arena_alloc,
+                    )
+                    if err != nil {
+                        err = errors.message("\"to\"[{}]: {}", idx, err)
+                        return
+                    }
+                case string:
+                    targets[idx] = to_runestone_path(
+                        target,
+                        file_path,
+                        rn_arena_alloc,
+                    )
+                case:
+                    err = errors.message(
+                        "\"to\"[{}] has invalid type %T",
+                        idx,
+                        target,
+                    )
+                    return
+                }
             }
 
-            if static_switch, ok := to["static_switch"]; ok {
-                t.static_switch, ok = static_switch.(string)
-                errors.wrap(
-                    ok,
-                    "\"to.static_switch\" has invalid type",
-                ) or_return
+            // Targets writing to the same file would silently overwrite each other
+            for target, idx in targets {
+                target_out := to_target_out(target)
+                for other_idx in 0 ..< idx {
+                    if target_out != to_target_out(targets[other_idx]) {
+                        continue
+                    }
+
+                    if len(target_out) != 0 {
+                        err = errors.message(
+                            "\"to\"[{}] and \"to\"[{}] both write to \"{}\"",
+                            other_idx,
+                            idx,
+                            target_out,
+                        )
+                    } else {
+                        err = errors.message(
+                            "\"to\"[{}] and \"to\"[{}] both write to the default output file; set \"out\" for one of them",
+                            other_idx,
+                            idx,
+                        )
+                    }
+                    return
+                }
             }
 
-            if out, ok := to["out"]; ok {
-                t.out, ok = out.(string)
-                errors.wrap(ok, "\"to.out\" has invalid type") or_return
-                t.out = relative_to_file(file_path, t.out, rn_arena_alloc)
+            rn.to = targets
+        case:
+            err = errors.message("\"to\" has invalid type %T", to)
+        }
+    case:
+        err = errors.message("yaml file has invalid type %T", y)
+        return
+    }
+
+    // Add the out header to the header of from if requested
+    if wrapper, wrapper_ok := rn.wrapper.?;
+       wrapper_ok && wrapper.add_header_to_from {
+        #partial switch &from in rn.from {
+        case From:
+            // First gather all different out headers based on the platform
+            out_headers := make(map[Platform]string)
+            defer delete(out_headers)
+
+            if !wrapper.multi_platform || len(rn.platforms) < 2 {
+                out_headers[{}] = wrapper.out_header
+            } else {
+                for rn_plat in rn.platforms {
+                    out_header_platted := platform_file_name(
+                        wrapper.out_header,
+                        rn_plat,
+                        rn_arena_alloc,
+                    )
+
+                    out_headers[rn_plat] = out_header_platted
+                }
             }
 
-            if "trim_prefix" in to {
-                #partial switch trim_prefix in to["trim_prefix"] {
-                case string:
+            // Try to insert everyone of these out headers into the headers separately
+            for plat, header in out_headers {
+                inserted: bool
+
+                // If it is already there insert it into them
+                for from_plat, &from_headers in from.headers.d {
+                    if from_plat != plat do continue
+
                     arr := make(
                         [dynamic]string,
+                        len = 0,
+                        cap = len(from_headers) + 1,
                         allocator = rn_arena_alloc,
-                        len = 1,
-                        cap = 1,
                     )
-                    arr[0] = trim_prefix
+                    append(&arr, ..from_headers)
+                    append(&arr, header)
+
+                    from_headers = arr[:]
+                    inserted = true
+                }
+
+                // Otherwise find the next most common platform and add them together as a new entry
+                if !inserted {
+                    more_common_headers: Maybe([]string)
+
+                    common_plat := Platform{plat.os, .Any}
+                    if common_plat in from.headers.d {
+                        more_common_headers = from.headers.d[common_plat]
+                    } else {
+                        common_plat = {.Any, .Any}
+                        if common_plat in from.headers.d {
+                            more_common_headers = from.headers.d[common_plat]
+                        }
+                    }
+
+                    cap := 1
+                    if more_common_headers == nil {
+                        common_plat = plat
+                    } else {
+                        cap += len(more_common_headers.?)
+                    }
 
-                    t.trim_prefix.functions = arr[:]
-                    t.trim_prefix.variables = arr[:]
-                    t.trim_prefix.types = arr[:]
-                    t.trim_prefix.constants = arr[:]
-                case yaml.Sequence:
                     arr := make(
                         [dynamic]string,
-                        allocator = rn_arena_alloc,
                         len = 0,
-                        cap = len(trim_prefix),
+                        cap = cap,
+                        allocator = rn_arena_alloc,
                     )
+                    append(&arr, ..(more_common_headers.? or_else []string{}))
+                    append(&arr, header)
 
-                    for seq_v, idx in trim_prefix {
-                        #partial switch v_seq in seq_v {
-                        case string:
-                            append(&arr, v_seq)
-                        case:
-                            err = errors.message(
-                                "\"to.trim_prefix\"[{}] has invalid type %T",
-                                idx,
-                                v_seq,
-                            )
-                            return
-                        }
-                    }
+                    from.headers.d[plat] = arr[:]
+                }
+            }
+        }
+    }
 
-                    t.trim_prefix.functions = arr[:]
-                    t.trim_prefix.variables = arr[:]
-                    t.trim_prefix.types = arr[:]
-                    t.trim_prefix.constants = arr[:]
-                case yaml.Mapping:
-                    functions_arr := make([dynamic]string, rn_arena_alloc)
-                    variables_arr := make([dynamic]string, rn_arena_alloc)
-                    types_arr := make([dynamic]string, rn_arena_alloc)
-                    constants_arr := make([dynamic]string, rn_arena_alloc)
+    return
+}
 
-                    if "functions" in trim_prefix {
-                        #partial switch f in trim_prefix["functions"] {
-                        case string:
-                            append(&functions_arr, f)
-                        case yaml.Sequence:
-                            for seq_f, idx in f {
-                                #partial switch f_seq in seq_f {
-                                case string:
-                                    append(&functions_arr, f_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_prefix.functions\"[{}] has invalid type %T",
-                                        idx,
-                                        f_seq,
-                                    )
-                                    return
-                                }
-                            }
-                        case:
-                            err = errors.message(
-                                "\"to.trim_prefix.functions\" has invald type %T",
-                                f,
-                            )
-                            return
-                        }
-                    }
+// Parses the bindings that should be generated
+@(private = "file")
+parse_to :: proc(
+    to: yaml.Mapping,
+    file_path: string,
+    rn_arena_alloc: runtime.Allocator,
+) -> (
+    t: To,
+    err: errors.Error,
+) {
+    if language, ok := to["language"]; ok {
+        t.language, ok = language.(string)
+        errors.wrap(ok, "\"to.language\" has invalid type") or_return
+    } else {
+        err = errors.message("\"to.language\" is missing")
+        return
+    }
 
-                    if "variables" in trim_prefix {
-                        #partial switch var in trim_prefix["variables"] {
-                        case string:
-                            append(&variables_arr, var)
-                        case yaml.Sequence:
-                            for seq_v, idx in var {
-                                #partial switch v_seq in seq_v {
-                                case string:
-                                    append(&variables_arr, v_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_prefix.variables\"[{}] has invalid type %T",
-                                        idx,
-                                        v_seq,
-                                    )
-                                    return
-                                }
-                            }
-                        case:
-                            err = errors.message(
-                                "\"to.trim_prefix.variables\" has invald type %T",
-                                var,
-                            )
-                            return
-                        }
-                    }
+    if static_switch, ok := to["static_switch"]; ok {
+        t.static_switch, ok = static_switch.(string)
+        errors.wrap(
+            ok,
+            "\"to.static_switch\" has invalid type",
+        ) or_return
+    }
+
+    if out, ok := to["out"]; ok {
+        t.out, ok = out.(string)
+        errors.wrap(ok, "\"to.out\" has invalid type") or_return
+        t.out = relative_to_file(file_path, t.out, rn_arena_alloc)
+    }
 
-                    if "types" in trim_prefix {
-                        #partial switch t in trim_prefix["types"] {
+    if "trim_prefix" in to {
+        #partial switch trim_prefix in to["trim_prefix"] {
+        case string:
+            arr := make(
+                [dynamic]string,
+                allocator = rn_arena_alloc,
+                len = 1,
+                cap = 1,
+            )
+            arr[0] = trim_prefix
+
+            t.trim_prefix.functions = arr[:]
+            t.trim_prefix.variables = arr[:]
+            t.trim_prefix.types = arr[:]
+            t.trim_prefix.constants = arr[:]
+        case yaml.Sequence:
+            arr := make(
+                [dynamic]string,
+                allocator = rn_arena_alloc,
+                len = 0,
+                cap = len(trim_prefix),
+            )
+
+            for seq_v, idx in trim_prefix {
+                #partial switch v_seq in seq_v {
+                case string:
+                    append(&arr, v_seq)
+                case:
+                    err = errors.message(
+                        "\"to.trim_prefix\"[{}] has invalid type %T",
+                        idx,
+                        v_seq,
+                    )
+                    return
+                }
+            }
+
+            t.trim_prefix.functions = arr[:]
+            t.trim_prefix.variables = arr[:]
+            t.trim_prefix.types = arr[:]
+            t.trim_prefix.constants = arr[:]
+        case yaml.Mapping:
+            functions_arr := make([dynamic]string, rn_arena_alloc)
+            variables_arr := make([dynamic]string, rn_arena_alloc)
+            types_arr := make([dynamic]string, rn_arena_alloc)
+            constants_arr := make([dynamic]string, rn_arena_alloc)
+
+            if "functions" in trim_prefix {
+                #partial switch f in trim_prefix["functions"] {
+                case string:
+                    append(&functions_arr, f)
+                case yaml.Sequence:
+                    for seq_f, idx in f {
+                        #partial switch f_seq in seq_f {
                         case string:
-                            append(&types_arr, t)
-                        case yaml.Sequence:
-                            for seq_t, idx in t {
-                                #partial switch t_seq in seq_t {
-                                case string:
-                                    append(&types_arr, t_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_prefix.types\"[{}] has invalid type %T",
-                                        idx,
-                                        t_seq,
-                                    )
-                                    return
-                                }
-                            }
+                            append(&functions_arr, f_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_prefix.types\" has invald type %T",
-                                t,
+                                "\"to.trim_prefix.functions\"[{}] has invalid type %T",
+                                idx,
+                                f_seq,
                             )
                             return
                         }
                     }
+                case:
+                    err = errors.message(
+                        "\"to.trim_prefix.functions\" has invald type %T",
+                        f,
+                    )
+                    return
+                }
+            }
 
-                    if "constants" in trim_prefix {
-                        #partial switch c in trim_prefix["constants"] {
+            if "variables" in trim_prefix {
+                #partial switch var in trim_prefix["variables"] {
+                case string:
+                    append(&variables_arr, var)
+                case yaml.Sequence:
+                    for seq_v, idx in var {
+                        #partial switch v_seq in seq_v {
                         case string:
-                            append(&constants_arr, c)
-                        case yaml.Sequence:
-                            for seq_c, idx in c {
-                                #partial switch c_seq in seq_c {
-                                case string:
-                                    append(&constants_arr, c_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_prefix.constants\"[{}] has invalid type %T",
-                                        idx,
-                                        c_seq,
-                                    )
-                                    return
-                                }
-                            }
+                            append(&variables_arr, v_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_prefix.constants\" has invald type %T",
-                                t,
+                                "\"to.trim_prefix.variables\"[{}] has invalid type %T",
+                                idx,
+                                v_seq,
                             )
                             return
                         }
                     }
+                case:
+                    err = errors.message(
+                        "\"to.trim_prefix.variables\" has invald type %T",
+                        var,
+                    )
+                    return
+                }
+            }
 
-                    if "enum_type_name" in trim_prefix {
-                        #partial switch etn in trim_prefix["enum_type_name"] {
-                        case bool:
-                            t.trim_prefix.enum_type_name = etn
+            if "types" in trim_prefix {
+                #partial switch t in trim_prefix["types"] {
+                case string:
+                    append(&types_arr, t)
+                case yaml.Sequence:
+                    for seq_t, idx in t {
+                        #partial switch t_seq in seq_t {
+                        case string:
+                            append(&types_arr, t_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_prefix.enum_type_name\" has invalid type %T",
-                                t,
+                                "\"to.trim_prefix.types\"[{}] has invalid type %T",
+                                idx,
+                                t_seq,
                             )
                             return
                         }
                     }
-
-                    t.trim_prefix.functions = functions_arr[:]
-                    t.trim_prefix.variables = variables_arr[:]
-                    t.trim_prefix.types = types_arr[:]
-                    t.trim_prefix.constants = constants_arr[:]
                 case:
                     err = errors.message(
-                        "\"to.trim_prefix\" has invalid type %T",
-                        trim_prefix,
+                        "\"to.trim_prefix.types\" has invald type %T",
+                        t,
                     )
                     return
                 }
             }
 
-            if "trim_suffix" in to {
-                #partial switch trim_suffix in to["trim_suffix"] {
+            if "constants" in trim_prefix {
+                #partial switch c in trim_prefix["constants"] {
                 case string:
-                    arr := make(
-                        [dynamic]string,
-                        allocator = rn_arena_alloc,
-                        len = 1,
-                        cap = 1,
-                    )
-                    arr[0] = trim_suffix
-
-                    t.trim_suffix.functions = arr[:]
-                    t.trim_suffix.variables = arr[:]
-                    t.trim_suffix.types = arr[:]
-                    t.trim_suffix.constants = arr[:]
+                    append(&constants_arr, c)
                 case yaml.Sequence:
-                    arr := make(
-                        [dynamic]string,
-                        allocator = rn_arena_alloc,
-                        len = 0,
-                        cap = len(trim_suffix),
-                    )
-
-                    for v_seq, idx in trim_suffix {
-                        #partial switch seq_v in v_seq {
+                    for seq_c, idx in c {
+                        #partial switch c_seq in seq_c {
                         case string:
-                            append(&arr, seq_v)
+                            append(&constants_arr, c_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_suffix\"[{}] has invalid type %T",
+                                "\"to.trim_prefix.constants\"[{}] has invalid type %T",
                                 idx,
-                                seq_v,
+                                c_seq,
                             )
                             return
                         }
                     }
+                case:
+                    err = errors.message(
+                        "\"to.trim_prefix.constants\" has invald type %T",
+                        t,
+                    )
+                    return
+                }
+            }
 
-                    t.trim_suffix.functions = arr[:]
-                    t.trim_suffix.variables = arr[:]
-                    t.trim_suffix.types = arr[:]
-                    t.trim_suffix.constants = arr[:]
-                case yaml.Mapping:
-                    functions_arr := make([dynamic]string, rn_arena_alloc)
-                    variables_arr := make([dynamic]string, rn_arena_alloc)
-                    types_arr := make([dynamic]string, rn_arena_alloc)
-                    constants_arr := make([dynamic]string, rn_arena_alloc)
+            if "enum_type_name" in trim_prefix {
+                #partial switch etn in trim_prefix["enum_type_name"] {
+                case bool:
+                    t.trim_prefix.enum_type_name = etn
+                case:
+                    err = errors.message(
+                        "\"to.trim_prefix.enum_type_name\" has invalid type %T",
+                        t,
+                    )
+                    return
+                }
+            }
 
-                    if "functions" in trim_suffix {
-                        #partial switch f in trim_suffix["functions"] {
-                        case string:
-                            append(&functions_arr, f)
-                        case yaml.Sequence:
-                            for seq_f, idx in f {
-                                #partial switch f_seq in seq_f {
-                                case string:
-                                    append(&functions_arr, f_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_suffix.functions\"[{}] has invalid type %T",
-                                        idx,
-                                        f_seq,
-                                    )
-                                    return
-                                }
-                            }
-                        case:
-                            err = errors.message(
-                                "\"to.trim_suffix.functions\" has invald type %T",
-                                f,
-                            )
-                            return
-                        }
-                    }
+            t.trim_prefix.functions = functions_arr[:]
+            t.trim_prefix.variables = variables_arr[:]
+            t.trim_prefix.types = types_arr[:]
+            t.trim_prefix.constants = constants_arr[:]
+        case:
+            err = errors.message(
+                "\"to.trim_prefix\" has invalid type %T",
+                trim_prefix,
+            )
+            return
+        }
+    }
+
+    if "trim_suffix" in to {
+        #partial switch trim_suffix in to["trim_suffix"] {
+        case string:
+            arr := make(
+                [dynamic]string,
+                allocator = rn_arena_alloc,
+                len = 1,
+                cap = 1,
+            )
+            arr[0] = trim_suffix
+
+            t.trim_suffix.functions = arr[:]
+            t.trim_suffix.variables = arr[:]
+            t.trim_suffix.types = arr[:]
+            t.trim_suffix.constants = arr[:]
+        case yaml.Sequence:
+            arr := make(
+                [dynamic]string,
+                allocator = rn_arena_alloc,
+                len = 0,
+                cap = len(trim_suffix),
+            )
+
+            for v_seq, idx in trim_suffix {
+                #partial switch seq_v in v_seq {
+                case string:
+                    append(&arr, seq_v)
+                case:
+                    err = errors.message(
+                        "\"to.trim_suffix\"[{}] has invalid type %T",
+                        idx,
+                        seq_v,
+                    )
+                    return
+                }
+            }
 
-                    if "variables" in trim_suffix {
-                        #partial switch var in trim_suffix["variables"] {
+            t.trim_suffix.functions = arr[:]
+            t.trim_suffix.variables = arr[:]
+            t.trim_suffix.types = arr[:]
+            t.trim_suffix.constants = arr[:]
+        case yaml.Mapping:
+            functions_arr := make([dynamic]string, rn_arena_alloc)
+            variables_arr := make([dynamic]string, rn_arena_alloc)
+            types_arr := make([dynamic]string, rn_arena_alloc)
+            constants_arr := make([dynamic]string, rn_arena_alloc)
+
+            if "functions" in trim_suffix {
+                #partial switch f in trim_suffix["functions"] {
+                case string:
+                    append(&functions_arr, f)
+                case yaml.Sequence:
+                    for seq_f, idx in f {
+                        #partial switch f_seq in seq_f {
                         case string:
-                            append(&variables_arr, var)
-                        case yaml.Sequence:
-                            for seq_v, idx in var {
-                                #partial switch v_seq in seq_v {
-                                case string:
-                                    append(&variables_arr, v_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_suffix.variables\"[{}] has invalid type %T",
-                                        idx,
-                                        v_seq,
-                                    )
-                                    return
-                                }
-                            }
+                            append(&functions_arr, f_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_suffix.variables\" has invald type %T",
-                                var,
+                                "\"to.trim_suffix.functions\"[{}] has invalid type %T",
+                                idx,
+                                f_seq,
                             )
                             return
                         }
                     }
+                case:
+                    err = errors.message(
+                        "\"to.trim_suffix.functions\" has invald type %T",
+                        f,
+                    )
+                    return
+                }
+            }
 
-                    if "types" in trim_suffix {
-                        #partial switch t in trim_suffix["types"] {
+            if "variables" in trim_suffix {
+                #partial switch var in trim_suffix["variables"] {
+                case string:
+                    append(&variables_arr, var)
+                case yaml.Sequence:
+                    for seq_v, idx in var {
+                        #partial switch v_seq in seq_v {
                         case string:
-                            append(&types_arr, t)
-                        case yaml.Sequence:
-                            for seq_t, idx in t {
-                                #partial switch t_seq in seq_t {
-                                case string:
-                                    append(&types_arr, t_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_suffix.types\"[{}] has invalid type %T",
-                                        idx,
-                                        t_seq,
-                                    )
-                                    return
-                                }
-                            }
+                            append(&variables_arr, v_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_suffix.types\" has invald type %T",
-                                t,
+                                "\"to.trim_suffix.variables\"[{}] has invalid type %T",
+                                idx,
+                                v_seq,
                             )
                             return
                         }
                     }
+                case:
+                    err = errors.message(
+                        "\"to.trim_suffix.variables\" has invald type %T",
+                        var,
+                    )
+                    return
+                }
+            }
 
-                    if "constants" in trim_suffix {
-                        #partial switch c in trim_suffix["constants"] {
+            if "types" in trim_suffix {
+                #partial switch t in trim_suffix["types"] {
+                case string:
+                    append(&types_arr, t)
+                case yaml.Sequence:
+                    for seq_t, idx in t {
+                        #partial switch t_seq in seq_t {
                         case string:
-                            append(&constants_arr, c)
-                        case yaml.Sequence:
-                            for seq_c, idx in c {
-                                #partial switch c_seq in seq_c {
-                                case string:
-                                    append(&constants_arr, c_seq)
-                                case:
-                                    err = errors.message(
-                                        "\"to.trim_suffix.constants\"[{}] has invalid type %T",
-                                        idx,
-                                        c_seq,
-                                    )
-                                    return
-                                }
-                            }
+                            append(&types_arr, t_seq)
                         case:
                             err = errors.message(
-                                "\"to.trim_suffix.constants\" has invald type %T",
-                                t,
+                                "\"to.trim_suffix.types\"[{}] has invalid type %T",
+                                idx,
+                                t_seq,
                             )
                             return
                         }
                     }
-                    t.trim_suffix.functions = functions_arr[:]
-                    t.trim_suffix.variables = variables_arr[:]
-                    t.trim_suffix.types = types_arr[:]
-                    t.trim_suffix.constants = constants_arr[:]
                 case:
                     err = errors.message(
-                        "\"to.trim_suffix\" has invalid type %T",
-                        trim_suffix,
+                        "\"to.trim_suffix.types\" has invald type %T",
+                        t,
                     )
                     return
                 }
             }
 
-            if "add_prefix" in to {
-                #partial switch add_prfx in to["add_prefix"] {
+            if "constants" in trim_suffix {
+                #partial switch c in trim_suffix["constants"] {
                 case string:
-                    t.add_prefix.functions = add_prfx
-                    t.add_prefix.variables = add_prfx
-                    t.add_prefix.types = add_prfx
-                    t.add_prefix.constants = add_prfx
-                case yaml.Mapping:
-                    ok: bool = ---
-                    if "functions" in add_prfx {
-                        t.add_prefix.functions, ok =
-                        add_prfx["functions"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_prefix.functions\" has invalid type",
-                        ) or_return
-                    }
-
-                    if "variables" in add_prfx {
-                        t.add_prefix.variables, ok =
-                        add_prfx["variables"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_prefix.variables\" has invalid type",
-                        ) or_return
-                    }
-
-                    if "types" in add_prfx {
-                        t.add_prefix.types, ok = add_prfx["types"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_prefix.types\" has invalid type",
-                        ) or_return
-                    }
-
-                    if "constants" in add_prfx {
-                        t.add_prefix.constants, ok =
-                        add_prfx["constants"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_prefix.constants\" has invalid type",
-                        ) or_return
+                    append(&constants_arr, c)
+                case yaml.Sequence:
+                    for seq_c, idx in c {
+                        #partial switch c_seq in seq_c {
+                        case string:
+                            append(&constants_arr, c_seq)
+                        case:
+                            err = errors.message(
+                                "\"to.trim_suffix.constants\"[{}] has invalid type %T",
+                                idx,
+                                c_seq,
+                            )
+                            return
+                        }
                     }
                 case:
                     err = errors.message(
-                        "\"to.add_prefix\" has invalid type %T",
-                        add_prfx,
+                        "\"to.trim_suffix.constants\" has invald type %T",
+                        t,
                     )
                     return
                 }
             }
+            t.trim_suffix.functions = functions_arr[:]
+            t.trim_suffix.variables = variables_arr[:]
+            t.trim_suffix.types = types_arr[:]
+            t.trim_suffix.constants = constants_arr[:]
+        case:
+            err = errors.message(
+                "\"to.trim_suffix\" has invalid type %T",
+                trim_suffix,
+            )
+            return
+        }
+    }
 
-            if "add_suffix" in to {
-                #partial switch add_sfx in to["add_suffix"] {
-                case string:
-                    t.add_suffix.functions = add_sfx
-                    t.add_suffix.variables = add_sfx
-                    t.add_suffix.types = add_sfx
-                    t.add_suffix.constants = add_sfx
-                case yaml.Mapping:
-                    ok: bool = ---
-                    if "functions" in add_sfx {
-                        t.add_suffix.functions, ok =
-                        add_sfx["functions"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_suffix.functions\" has invalid type",
-                        ) or_return
-                    }
-
-                    if "variables" in add_sfx {
-                        t.add_suffix.variables, ok =
-                        add_sfx["variables"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_suffix.variables\" has invalid type",
-                        ) or_return
-                    }
-
-                    if "types" in add_sfx {
-                        t.add_suffix.types, ok = add_sfx["types"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_suffix.types\" has invalid type",
-                        ) or_return
-                    }
+    if "add_prefix" in to {
+        #partial switch add_prfx in to["add_prefix"] {
+        case string:
+            t.add_prefix.functions = add_prfx
+            t.add_prefix.variables = add_prfx
+            t.add_prefix.types = add_prfx
+            t.add_prefix.constants = add_prfx
+        case yaml.Mapping:
+            ok: bool = ---
+            if "functions" in add_prfx {
+                t.add_prefix.functions, ok =
+                add_prfx["functions"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_prefix.functions\" has invalid type",
+                ) or_return
+            }
 
-                    if "constants" in add_sfx {
-                        t.add_suffix.constants, ok =
-                        add_sfx["constants"].(string)
-                        errors.wrap(
-                            ok,
-                            "\"to.add_suffix.constants\" has invalid type",
-                        ) or_return
-                    }
-                case:
-                    err = errors.message(
-                        "\"to.add_suffix\" has invalid type %T",
-                        add_sfx,
-                    )
-                    return
-                }
+            if "variables" in add_prfx {
+                t.add_prefix.variables, ok =
+                add_prfx["variables"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_prefix.variables\" has invalid type",
+                ) or_return
             }
 
-            if ignore_arch, ok := to["ignore_arch"]; ok {
-                t.ignore_arch, ok = ignore_arch.(bool)
+            if "types" in add_prfx {
+                t.add_prefix.types, ok = add_prfx["types"].(string)
                 errors.wrap(
                     ok,
-                    "\"to.ignore_arch\" has invalid type",
+                    "\"to.add_prefix.types\" has invalid type",
                 ) or_return
             }
-            if package_name, ok := to["package"]; ok {
-                t.package_name, ok = package_name.(string)
-                errors.wrap(ok, "\"to.package\" has invalid type") or_return
+
+            if "constants" in add_prfx {
+                t.add_prefix.constants, ok =
+                add_prfx["constants"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_prefix.constants\" has invalid type",
+                ) or_return
             }
+        case:
+            err = errors.message(
+                "\"to.add_prefix\" has invalid type %T",
+                add_prfx,
+            )
+            return
+        }
+    }
 
-            if detect, ok := to["detect"]; ok {
-                #partial switch d in detect {
-                case yaml.Mapping:
-                    if multi_pointer, mp_ok := d["multi_pointer"]; mp_ok {
-                        t.detect.multi_pointer, mp_ok = multi_pointer.(string)
-                        errors.wrap(
-                            mp_ok,
-                            "\"to.detect.multi_pointer\" has invalid type",
-                        ) or_return
-                    }
-                case:
-                    err = errors.message(
-                        "\"to.detect\" has invalid type %T",
-                        d,
-                    )
-                    return
-                }
+    if "add_suffix" in to {
+        #partial switch add_sfx in to["add_suffix"] {
+        case string:
+            t.add_suffix.functions = add_sfx
+            t.add_suffix.variables = add_sfx
+            t.add_suffix.types = add_sfx
+            t.add_suffix.constants = add_sfx
+        case yaml.Mapping:
+            ok: bool = ---
+            if "functions" in add_sfx {
+                t.add_suffix.functions, ok =
+                add_sfx["functions"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_suffix.functions\" has invalid type",
+                ) or_return
             }
 
-            if len(t.detect.multi_pointer) == 0 {
-                t.detect.multi_pointer = "auto"
+            if "variables" in add_sfx {
+                t.add_suffix.variables, ok =
+                add_sfx["variables"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_suffix.variables\" has invalid type",
+                ) or_return
             }
 
-            if no_build_tag, ok := to["no_build_tag"]; ok {
-                t.no_build_tag, ok = no_build_tag.(bool)
+            if "types" in add_sfx {
+                t.add_suffix.types, ok = add_sfx["types"].(string)
                 errors.wrap(
                     ok,
-                    "\"to.no_build_tag\" has invalid type",
+                    "\"to.add_suffix.types\" has invalid type",
                 ) or_return
             }
-            if use_when_else, ok := to["use_when_else"]; ok {
-                t.use_when_else, ok = use_when_else.(bool)
-                errors.wrap(ok, "\"to.use_when_else\" has invalid type")
+
+            if "constants" in add_sfx {
+                t.add_suffix.constants, ok =
+                add_sfx["constants"].(string)
+                errors.wrap(
+                    ok,
+                    "\"to.add_suffix.constants\" has invalid type",
+                ) or_return
             }
+        case:
+            err = errors.message(
+                "\"to.add_suffix\" has invalid type %T",
+                add_sfx,
+            )
+            return
+        }
+    }
 
-            if extern_value, ok := to["extern"]; ok {
-                #partial switch extern in extern_value {
-                case yaml.Mapping:
-                    sources_value, sources_ok := extern["sources"]
-                    errors.assert(
-                        sources_ok,
-                        "\"to.extern.sources\" is missing",
-                    ) or_return
+    if ignore_arch, ok := to["ignore_arch"]; ok {
+        t.ignore_arch, ok = ignore_arch.(bool)
+        errors.wrap(
+            ok,
+            "\"to.ignore_arch\" has invalid type",
+        ) or_return
+    }
+    if package_name, ok := to["package"]; ok {
+        t.package_name, ok = package_name.(string)
+        errors.wrap(ok, "\"to.package\" has invalid type") or_return
+    }
 
-                    #partial switch sources in sources_value {
-                    case yaml.Mapping:
-                        t.extern.sources = make(
-                            map[string]string,
-                            len(sources),
-                            allocator = rn_arena_alloc,
-                        )
+    if detect, ok := to["detect"]; ok {
+        #partial switch d in detect {
+        case yaml.Mapping:
+            if multi_pointer, mp_ok := d["multi_pointer"]; mp_ok {
+                t.detect.multi_pointer, mp_ok = multi_pointer.(string)
+                errors.wrap(
+                    mp_ok,
+                    "\"to.detect.multi_pointer\" has invalid type",
+                ) or_return
+            }
+        case:
+            err = errors.message(
+                "\"to.detect\" has invalid type %T",
+                d,
+            )
+            return
+        }
+    }
 
-                        for source_name, import_name_value in sources {
-                            import_name, import_name_ok := import_name_value.(string)
-                            errors.assert(
-                                import_name_ok,
-                                "\"to.extern.sources\" has invalid entries",
-                            ) or_return
-                            t.extern.sources[source_name] = import_name
-                        }
-                    case:
-                        err = errors.message(
-                            "\"to.extern.sources\" has invalid type",
-                        )
-                        return
-                    }
+    if len(t.detect.multi_pointer) == 0 {
+        t.detect.multi_pointer = "auto"
+    }
 
-                    if remaps_value, remaps_ok := extern["remaps"]; remaps_ok {
-                        #partial switch remaps in remaps_value {
-                        case yaml.Mapping:
-                            t.extern.remaps = make(
-                                map[string]string,
-                                len(remaps),
-                                allocator = rn_arena_alloc,
-                            )
+    if no_build_tag, ok := to["no_build_tag"]; ok {
+        t.no_build_tag, ok = no_build_tag.(bool)
+        errors.wrap(
+            ok,
+            "\"to.no_build_tag\" has invalid type",
+        ) or_return
+    }
+    if use_when_else, ok := to["use_when_else"]; ok {
+        t.use_when_else, ok = use_when_else.(bool)
+        errors.wrap(ok, "\"to.use_when_else\" has invalid type")
+    }
 
-                            for type_name, remap_name_value in remaps {
-                                remap_name, remap_name_ok := remap_name_value.(string)
-                                errors.assert(
-                                    remap_name_ok,
-                                    "\"to.extern.remaps\" has invalid entries",
-                                ) or_return
+    if extern_value, ok := to["extern"]; ok {
+        #partial switch extern in extern_value {
+        case yaml.Mapping:
+            sources_value, sources_ok := extern["sources"]
+            errors.assert(
+                sources_ok,
+                "\"to.extern.sources\" is missing",
+            ) or_return
 
-                                t.extern.remaps[type_name] = remap_name
-                            }
-                        case:
-                            err = errors.message(
-                                "\"to.extern.remaps\" has invalid type",
-                            )
-                            return
-                        }
-                    }
+            #partial switch sources in sources_value {
+            case yaml.Mapping:
+                t.extern.sources = make(
+                    map[string]string,
+                    len(sources),
+                    allocator = rn_arena_alloc,
+                )
 
-                    if trim_prefix_value, tp_ok := extern["trim_prefix"];
-                       tp_ok {
-                        t.extern.trim_prefix, tp_ok = trim_prefix_value.(bool)
-                        errors.assert(
-                            tp_ok,
-                            "\"to.extern.trim_prefix\" has invalid type",
-                        ) or_return
-                    }
+                for source_name, import_name_value in sources {
+                    import_name, import_name_ok := import_name_value.(string)
+                    errors.assert(
+                        import_name_ok,
+                        "\"to.extern.sources\" has invalid entries",
+                    ) or_return
+                    t.extern.sources[source_name] = import_name
+                }
+            case:
+                err = errors.message(
+                    "\"to.extern.sources\" has invalid type",
+                )
+                return
+            }
 
-                    if trim_suffix_value, tp_ok := extern["trim_suffix"];
-                       tp_ok {
-                        t.extern.trim_suffix, tp_ok = trim_suffix_value.(bool)
-                        errors.assert(
-                            tp_ok,
-                            "\"to.extern.trim_suffix\" has invalid type",
-                        ) or_return
-                    }
+            if remaps_value, remaps_ok := extern["remaps"]; remaps_ok {
+                #partial switch remaps in remaps_value {
+                case yaml.Mapping:
+                    t.extern.remaps = make(
+                        map[string]string,
+                        len(remaps),
+                        allocator = rn_arena_alloc,
+                    )
 
-                    if add_prefix_value, tp_ok := extern["add_prefix"]; tp_ok {
-                        t.extern.add_prefix, tp_ok = add_prefix_value.(bool)
+                    for type_name, remap_name_value in remaps {
+                        remap_name, remap_name_ok := remap_name_value.(string)
                         errors.assert(
-                            tp_ok,
-                            "\"to.extern.add_prefix\" has invalid type",
+                            remap_name_ok,
+                            "\"to.extern.remaps\" has invalid entries",
                         ) or_return
-                    }
 
-                    if add_suffix_value, tp_ok := extern["add_suffix"]; tp_ok {
-                        t.extern.add_suffix, tp_ok = add_suffix_value.(bool)
-                        errors.assert(
-                            tp_ok,
-                            "\"to.extern.add_suffix\" has invalid type",
-                        ) or_return
+                        t.extern.remaps[type_name] = remap_name
                     }
-
                 case:
-                    err = errors.message("\"to.extern\" has invalid type")
+                    err = errors.message(
+                        "\"to.extern.remaps\" has invalid type",
+                    )
                     return
                 }
             }
 
-            {
-                context.allocator = rn_arena_alloc
+            if trim_prefix_value, tp_ok := extern["trim_prefix"];
+               tp_ok {
+                t.extern.trim_prefix, tp_ok = trim_prefix_value.(bool)
+                errors.assert(
+                    tp_ok,
+                    "\"to.extern.trim_prefix\" has invalid type",
+                ) or_return
+            }
 
-                t.add_libs_shared = make_platform_value([]string)
-                t.add_libs_static = make_platform_value([]string)
+            if trim_suffix_value, tp_ok := extern["trim_suffix"];
+               tp_ok {
+                t.extern.trim_suffix, tp_ok = trim_suffix_value.(bool)
+                errors.assert(
+                    tp_ok,
+                    "\"to.extern.trim_suffix\" has invalid type",
+                ) or_return
             }
 
-            for key, value in to {
-                splits, alloc_err := strings.split(key, ".")
-                errors.wrap(alloc_err) or_return
+            if add_prefix_value, tp_ok := extern["add_prefix"]; tp_ok {
+                t.extern.add_prefix, tp_ok = add_prefix_value.(bool)
+                errors.assert(
+                    tp_ok,
+                    "\"to.extern.add_prefix\" has invalid type",
+                ) or_return
+            }
 
-                name: string = ---
-                os, arch: Maybe(string)
-                lib_type: Maybe(string)
+            if add_suffix_value, tp_ok := extern["add_suffix"]; tp_ok {
+                t.extern.add_suffix, tp_ok = add_suffix_value.(bool)
+                errors.assert(
+                    tp_ok,
+                    "\"to.extern.add_suffix\" has invalid type",
+                ) or_return
+            }
 
-                #no_bounds_check switch len(splits) {
-                case 0:
-                    err = errors.message("invalid key in \"to\"")
-                    return
-                case 1:
-                    name = splits[0]
-                case 2:
-                    name = splits[0]
-                    if name == "add_libs" {
-                        if splits[1] == "static" || splits[1] == "shared" {
-                            lib_type = splits[1]
-                            break
-                        }
-                    }
+        case:
+            err = errors.message("\"to.extern\" has invalid type")
+            return
+        }
+    }
 
-                    os = splits[1]
-                case 3:
-                    name = splits[0]
-                    if name == "add_libs" {
-                        if splits[1] == "static" || splits[1] == "shared" {
-                            lib_type = splits[1]
-                            os = splits[2]
-                            break
-                        }
-                    }
+    {
+        context.allocator = rn_arena_alloc
 
-                    os = splits[1]
-                    arch = splits[2]
-                case 4:
-                    name = splits[0]
-                    if name == "add_libs" {
-                        if splits[1] != "static" && splits[1] != "shared" {
-                            err = errors.message(
-                                "invalid key in \"from\": {}. Must be either {}.static.{}.{} or {}.shared.{}.{}",
-                                key,
-                                splits[0],
-                                splits[2],
-                                splits[3],
-                                splits[0],
-                                splits[2],
-                                splits[3],
-                            )
-                            return
-                        }
-                        lib_type = splits[1]
-                        os = splits[2]
-                        arch = splits[3]
-                    } else {
-                        err = errors.message(
-                            "invalid key in \"from\": {}",
-                            key,
-                        )
-                        return
-                    }
-                case:
-                    err = errors.message("invalid key in \"from\": {}", key)
-                    return
+        t.add_libs_shared = make_platform_value([]string)
+        t.add_libs_static = make_platform_value([]string)
+    }
+
+    for key, value in to {
+        splits, alloc_err := strings.split(key, ".")
+        errors.wrap(alloc_err) or_return
+
+        name: string = ---
+        os, arch: Maybe(string)
+        lib_type: Maybe(string)
+
+        #no_bounds_check switch len(splits) {
+        case 0:
+            err = errors.message("invalid key in \"to\"")
+            return
+        case 1:
+            name = splits[0]
+        case 2:
+            name = splits[0]
+            if name == "add_libs" {
+                if splits[1] == "static" || splits[1] == "shared" {
+                    lib_type = splits[1]
+                    break
                 }
+            }
 
-                delete(splits)
+            os = splits[1]
+        case 3:
+            name = splits[0]
+            if name == "add_libs" {
+                if splits[1] == "static" || splits[1] == "shared" {
+                    lib_type = splits[1]
+                    os = splits[2]
+                    break
+                }
+            }
 
-                plat, plat_ok := platform_from_strings(os, arch)
-                if !plat_ok {
+            os = splits[1]
+            arch = splits[2]
+        case 4:
+            name = splits[0]
+            if name == "add_libs" {
+                if splits[1] != "static" && splits[1] != "shared" {
                     err = errors.message(
-                        "invalid platform for \"from.{}\" os=\"{}\" arch=\"{}\"",
-                        name,
-                        os,
-                        arch,
+                        "invalid key in \"from\": {}. Must be either {}.static.{}.{} or {}.shared.{}.{}",
+                        key,
+                        splits[0],
+                        splits[2],
+                        splits[3],
+                        splits[0],
+                        splits[2],
+                        splits[3],
                     )
                     return
                 }
+                lib_type = splits[1]
+                os = splits[2]
+                arch = splits[3]
+            } else {
+                err = errors.message(
+                    "invalid key in \"from\": {}",
+                    key,
+                )
+                return
+            }
+        case:
+            err = errors.message("invalid key in \"from\": {}", key)
+            return
+        }
 
-                switch name {
-                case "add_libs":
-                    arr: [dynamic]string = ---
-                    #partial switch v in value {
-                    case string:
-                        arr = make(
-                            [dynamic]string,
-                            len = 1,
-                            cap = 1,
-                            allocator = rn_arena_alloc,
-                        )
-                        arr[0] = relative_to_file(
-                            file_path,
-                            v,
-                            rn_arena_alloc,
-                            true,
-                        )
+        delete(splits)
 
-                    case yaml.Sequence:
-                        arr = make(
-                            [dynamic]string,
-                            len = 0,
-                            cap = len(v),
-                            allocator = rn_arena_alloc,
+        plat, plat_ok := platform_from_strings(os, arch)
+        if !plat_ok {
+            err = errors.message(
+                "invalid platform for \"from.{}\" os=\"{}\" arch=\"{}\"",
+                name,
+                os,
+                arch,
+            )
+            return
+        }
+
+        switch name {
+        case "add_libs":
+            arr: [dynamic]string = ---
+            #partial switch v in value {
+            case string:
+                arr = make(
+                    [dynamic]string,
+                    len = 1,
+                    cap = 1,
+                    allocator = rn_arena_alloc,
+                )
+                arr[0] = relative_to_file(
+                    file_path,
+                    v,
+                    rn_arena_alloc,
+                    true,
+                )
+
+            case yaml.Sequence:
+                arr = make(
+                    [dynamic]string,
+                    len = 0,
+                    cap = len(v),
+                    allocator = rn_arena_alloc,
+                )
+                for lib, lib_idx in v {
+                    #partial switch l in lib {
+                    case string:
+                        append(
+                            &arr,
+                            relative_to_file(
+                                file_path,
+                                l,
+                                rn_arena_alloc,
+                                true,
+                            ),
                         )
-                        for lib, lib_idx in v {
-                            #partial switch l in lib {
-                            case string:
-                                append(
-                                    &arr,
-                                    relative_to_file(
-                                        file_path,
-                                        l,
-                                        rn_arena_alloc,
-                                        true,
-                                    ),
-                                )
-                            case:
-                                err = errors.message(
-                                    "\"to.{}\"[{}] has invalid type: %T",
-                                    key,
-                                    lib_idx,
-                                    l,
-                                )
-                                return
-                            }
-                        }
                     case:
                         err = errors.message(
-                            "\"to.{}\" has invalid type: %T",
+                            "\"to.{}\"[{}] has invalid type: %T",
                             key,
-                            v,
+                            lib_idx,
+                            l,
                         )
                         return
                     }
-
-                    if lt, lt_ok := lib_type.?; lt_ok {
-                        switch lt {
-                        case "static":
-                            t.add_libs_static.d[plat] = arr[:]
-                        case "shared":
-                            t.add_libs_shared.d[plat] = arr[:]
-                        }
-                    } else {
-                        t.add_libs_static.d[plat] = arr[:]
-                        t.add_libs_shared.d[plat] = arr[:]
-                    }
                 }
+            case:
+                err = errors.message(
+                    "\"to.{}\" has invalid type: %T",
+                    key,
+                    v,
+                )
+                return
             }
 
-            rn.to = t
-        case string:
-            if to != "stdout" {
-                rn.to = relative_to_file(file_path, to, rn_arena_alloc)
+            if lt, lt_ok := lib_type.?; lt_ok {
+                switch lt {
+                case "static":
+                    t.add_libs_static.d[plat] = arr[:]
+                case "shared":
+                    t.add_libs_shared.d[plat] = arr[:]
+                }
             } else {
-                rn.to = to
+                t.add_libs_static.d[plat] = arr[:]
+                t.add_libs_shared.d[plat] = arr[:]
             }
-        case:
-            err = errors.message("\"to\" has invalid type %T", to)
         }
-    case:
-        err = errors.message("yaml file has invalid type %T", y)
-        return
     }
 
-    // Add the out header to the header of from if requested
-    if wrapper, wrapper_ok := rn.wrapper.?;
-       wrapper_ok && wrapper.add_header_to_from {
-        #partial switch &from in rn.from {
-        case From:
-            // First gather all different out headers based on the platform
-            out_headers := make(map[Platform]string)
-            defer delete(out_headers)
-
-            if !wrapper.multi_platform || len(rn.platforms) < 2 {
-                out_headers[{}] = wrapper.out_header
-            } else {
-                for rn_plat in rn.platforms {
-                    out_header_platted := platform_file_name(
-                        wrapper.out_header,
-                        rn_plat,
-                        rn_arena_alloc,
-                    )
-
-                    out_headers[rn_plat] = out_header_platted
-                }
-            }
-
-            // Try to insert everyone of these out headers into the headers separately
-            for plat, header in out_headers {
-                inserted: bool
-
-                // If it is already there insert it into them
-                for from_plat, &from_headers in from.headers.d {
-                    if from_plat != plat do continue
-
-                    arr := make(
-                        [dynamic]string,
-                        len = 0,
-                        cap = len(from_headers) + 1,
-                        allocator = rn_arena_alloc,
-                    )
-                    append(&arr, ..from_headers)
-                    append(&arr, header)
-
-                    from_headers = arr[:]
-                    inserted = true
-                }
-
-                // Otherwise find the next most common platform and add them together as a new entry
-                if !inserted {
-                    more_common_headers: Maybe([]string)
-
-                    common_plat := Platform{plat.os, .Any}
-                    if common_plat in from.headers.d {
-                        more_common_headers = from.headers.d[common_plat]
-                    } else {
-                        common_plat = {.Any, .Any}
-                        if common_plat in from.headers.d {
-                            more_common_headers = from.headers.d[common_plat]
-                        }
-                    }
-
-                    cap := 1
-                    if more_common_headers == nil {
-                        common_plat = plat
-                    } else {
-                        cap += len(more_common_headers.?)
-                    }
+    return
+}
 
-                    arr := make(
-                        [dynamic]string,
-                        len = 0,
-                        cap = cap,
-                        allocator = rn_arena_alloc,
-                    )
-                    append(&arr, ..(more_common_headers.? or_else []string{}))
-                    append(&arr, header)
+// Returns the path of the runestone to write. "stdout" is kept as it is
+@(private = "file")
+to_runestone_path :: proc(
+    to: string,
+    file_path: string,
+    rn_arena_alloc: runtime.Allocator,
+) -> string {
+    if to == "stdout" do return to
+    return relative_to_file(file_path, to, rn_arena_alloc)
+}
 
-                    from.headers.d[plat] = arr[:]
-                }
-            }
-        }
+// Returns the file the target is written to. Empty if bindings are written to the default output file
+@(private = "file")
+to_target_out :: proc(target: ToTarget) -> string {
+    switch t in target {
+    case To:
+        return t.out
+    case string:
+        return t
     }
-
-    return
+    return ""
 }
 
 rune_destroy :: proc(rn: ^Rune) {
@@ -2919,53 +3019,48 @@ map_glob :: proc(m: $M/map[$K]$V, v: K) -> (match: V, ok: bool) #optional_ok {
 }
 
 ignore_types :: proc(types: ^om.OrderedMap(string, Type), ignore: IgnoreSet) {
-    for idx := 0; idx < len(types.data); idx += 1 {
-        entry := types.data[idx]
-        name := entry.key
-
-        if single_list_glob(ignore.types, name) {
-            om.delete_key(types, name)
-            idx -= 1
+    ignored := make([dynamic]string, context.temp_allocator)
+    for entry in types.data {
+        if single_list_glob(ignore.types, entry.key) {
+            append(&ignored, entry.key)
         }
     }
+    om.delete_keys(types, ignored[:])
 }
 
 ignore_constants :: proc(
     constants: ^om.OrderedMap(string, Constant),
     ignore: IgnoreSet,
 ) {
-    for idx := 0; idx < len(constants.data); idx += 1 {
-        entry := constants.data[idx]
-        name := entry.key
-
-        if single_list_glob(ignore.constants, name) {
-            om.delete_key(constants, name)
-            idx -= 1
+    ignored := make([dynamic]string, context.temp_allocator)
+    for entry in constants.data {
+        if single_list_glob(ignore.constants, entry.key) {
+            append(&ignored, entry.key)
         }
     }
+    om.delete_keys(constants, ignored[:])
 }
 
 ignore_symbols :: proc(
     symbols: ^om.OrderedMap(string, Symbol),
     ignore: IgnoreSet,
 ) {
-    for idx := 0; idx < len(symbols.data); idx += 1 {
-        entry := symbols.data[idx]
+    ignored := make([dynamic]string, context.temp_allocator)
+    for entry in symbols.data {
         name, sym := entry.key, entry.value
 
         switch _ in sym.value {
         case Type:
             if single_list_glob(ignore.variables, name) {
-                om.delete_key(symbols, name)
-                idx -= 1
+                append(&ignored, name)
             }
         case Function:
             if single_list_glob(ignore.functions, name) {
-                om.delete_key(symbols, name)
-                idx -= 1
+                append(&ignored, name)
             }
         }
     }
+    om.delete_keys(symbols, ignored[:])
 }
 
 overwrite_runestone :: proc(
@@ -21,6 +21,7 @@ package runic
 import "base:runtime"
 import "core:os"
 import "core:path/filepath"
+import "core:strings"
 import "core:testing"
 import "root:errors"
 import om "root:ordered_map"
@@ -105,6 +106,8 @@ test_rune :: proc(t: ^testing.T) {
     load_all_includes_macos := f.load_all_includes.d[Platform{.Macos, .Any}]
     expect_value(t, load_all_includes_any, true)
     expect_value(t, load_all_includes_macos, false)
+    expect_value(t, f.umbrella.d[Platform{.Linux, .Any}], true)
+    expect(t, Platform{.Any, .Any} not_in f.umbrella.d)
 
     forward_decl_type_any := f.forward_decl_type.d[Platform{.Any, .Any}]
     forward_decl_type_linux := f.forward_decl_type.d[Platform{.Linux, .Any}]
@@ -383,3 +386,66 @@ test_overwrite :: proc(t: ^testing.T) {
     expect_value(t, const.type.spec.(Builtin), Builtin.UInt64)
 }
 
+
+@(test)
+test_multiple_to :: proc(t: ^testing.T) {
+    using testing
+
+    RUNE :: `version: 0
+from: foo.runestone
+to:
+  - language: odin
+    package: foo
+    out: foo/foo.odin
+  - language: c
+    out: foo.h
+  - foo.runestone
+  - stdout
+`
+
+    rd: strings.Reader
+    strings.reader_init(&rd, RUNE)
+
+    rn, err := parse_rune(strings.reader_to_stream(&rd), "/rune.yml")
+    defer rune_destroy(&rn)
+    if !expect_value(t, err, nil) do return
+
+    targets := rn.to.([]ToTarget)
+    if !expect_value(t, len(targets), 4) do return
+
+    expect_value(t, targets[0].(To).language, "odin")
+    expect_value(t, targets[0].(To).package_name, "foo")
+    expect_value(t, targets[1].(To).language, "c")
+    expect_value(t, targets[2].(string), "/foo.runestone")
+    expect_value(t, targets[3].(string), "stdout")
+}
+
+@(test)
+test_duplicate_to :: proc(t: ^testing.T) {
+    using testing
+
+    RUNES :: [?]string {
+        `version: 0
+from: foo.runestone
+to:
+  - language: odin
+  - language: c
+`,
+        `version: 0
+from: foo.runestone
+to:
+  - language: odin
+    out: foo.odin
+  - foo.odin
+`,
+    }
+
+    for rune_str in RUNES {
+        rd: strings.Reader
+        strings.reader_init(&rd, rune_str)
+
+        rn, err := parse_rune(strings.reader_to_stream(&rd), "/rune.yml")
+        defer rune_destroy(&rn)
+        expect(t, err != nil)
+    }
+}
@@ -31,10 +31,18 @@ Rune :: struct {
     to:        union {
         To,
         string,
+        // Multiple outputs generated from the same runestones
+        []ToTarget,
     },
     arena:     runtime.Arena,
 }
 
+// Either bindings or the path of a runestone
+ToTarget :: union {
+    To,
+    string,
+}
+
 From :: struct {
     // General
     language:                   string,
@@ -54,6 +62,7 @@ From :: struct {
     disable_stdint_macros:      PlatformValue(bool),
     flags:                      PlatformValue([]cstring),
     load_all_includes:          PlatformValue(bool),
+    umbrella:                   PlatformValue(bool),
     forward_decl_type:          PlatformValue(Type),
     // Odin
     packages:                   PlatformValue([]string),
@@ -18,7 +18,9 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 package runic
 
 import "base:runtime"
+import "core:hash"
 import "core:slice"
+import "core:thread"
 import "root:errors"
 import om "root:ordered_map"
 
@@ -27,6 +29,8 @@ Runecross :: struct {
     cross: [dynamic]PlatformRunestone,
 }
 
+// A cross stone owns its ordered maps. The entries are shallow copies of the entries of the
+// origin runestones, so the origin runestones need to outlive the runecross
 PlatformRunestone :: struct {
     plats:           []Platform,
     using runestone: RunestoneWithFile,
@@ -37,10 +41,17 @@ RunestoneWithFile :: struct {
     using stone: Runestone,
 }
 
+// Minimum number of types, symbols and constants of all runestones per shard when crossing on multiple threads
+CROSS_SHARD_MIN_ENTRIES :: 4096
+
+// Crosses the runestones using up to `jobs` threads. Every thread crosses at least
+// shard_min_entries types, symbols and constants, so that small runestones are crossed on the calling thread
 cross_the_runes :: proc(
     file_paths: []string,
     stones: []Runestone,
     extern_sources: map[string]string = nil,
+    jobs := 1,
+    shard_min_entries := CROSS_SHARD_MIN_ENTRIES,
 ) -> (
     rc: Runecross,
     err: errors.Error,
@@ -103,8 +114,65 @@ cross_the_runes :: proc(
         )
     }
 
+    // Hash everything once, so that only entries with the same hash need to be compared.
+    // Entries that have been found to be the same as an entry of a previous runestone
+    // are already part of the runecross and are skipped.
+    crossing_arena: runtime.Arena
+    defer runtime.arena_destroy(&crossing_arena)
+    crossing := make(
+        []CrossingStone,
+        om.length(origin),
+        runtime.arena_allocator(&crossing_arena),
+    )
+    for entry0, stone_idx in origin.data {
+        crossing_stone_init(
+            &crossing[stone_idx],
+            entry0.value,
+            runtime.arena_allocator(&crossing_arena),
+        )
+    }
+
+    // The platforms of every name are independent of all other names, which is why
+    // the names are split into shards that are grouped in parallel
+    entry_count: int
     for entry0 in origin.data {
+        stone := entry0.value
+        entry_count +=
+            om.length(stone.types) +
+            om.length(stone.symbols) +
+            om.length(stone.constants)
+    }
+    shards := make(
+        []CrossShard,
+        clamp(entry_count / max(shard_min_entries, 1), 1, max(jobs, 1)),
+        runtime.arena_allocator(&crossing_arena),
+    )
+    defer for &shard in shards {
+        runtime.arena_destroy(&shard.arena)
+    }
+    for &shard, idx in shards {
+        shard.shard = idx
+        shard.shard_count = len(shards)
+        shard.origin = &origin
+        shard.crossing = crossing
+    }
+    run_cross_shards(shards)
+
+    cross_index: CrossIndex
+    defer delete(cross_index.stones)
+    for entry0 in origin.data {
+        cross_index.origin += {platform_bit(entry0.key)}
+    }
+
+    // The groups are assigned to the cross stones in the same order as they would have been found sequentially,
+    // so that the runecross does not depend on the number of shards
+    counts := make(
+        [dynamic]CrossCounts,
+        runtime.arena_allocator(&crossing_arena),
+    )
+    for entry0, stone1_idx in origin.data {
         stone1 := entry0.value
+        cs := &crossing[stone1_idx]
 
         {
             plats := get_same_platforms(
@@ -122,7 +190,7 @@ cross_the_runes :: proc(
             set_for_same_platforms(
                 stone1,
                 plats,
-                om.length(origin),
+                &cross_index,
                 &rc,
                 proc(
                     stone1: RunestoneWithFile,
@@ -136,160 +204,123 @@ cross_the_runes :: proc(
             )
         }
 
-        // types
-        for entry1 in stone1.types.data {
-            name1 := entry1.key
-
-            plats := get_same_platforms(
+        for &group in cs.type_groups {
+            if len(group.plats) == 0 do continue
+            group.cross_idx = assign_cross_group(
                 stone1,
-                origin,
-                proc(
-                    stone1, stone2: RunestoneWithFile,
-                    user_data: rawptr,
-                ) -> bool {
-                    name1 := cast(^string)user_data
-                    type1 := om.get(stone1.types, name1^)
-
-                    if type2, ok := om.get(stone2.types, name1^); ok {
-                        if is_same(type1, type2) {
-                            return true
-                        }
-                    }
-
-                    return false
-                },
-                &name1,
+                group.plats,
+                &cross_index,
+                &rc,
+                &counts,
+                rn_arena_alloc,
             )
-            defer delete(plats)
-
-            set_for_same_platforms(
+            counts[group.cross_idx].types += 1
+        }
+        for &group in cs.symbol_groups {
+            if len(group.plats) == 0 do continue
+            group.cross_idx = assign_cross_group(
                 stone1,
-                plats,
-                om.length(origin),
+                group.plats,
+                &cross_index,
                 &rc,
-                proc(
-                    stone1: RunestoneWithFile,
-                    stone2: ^RunestoneWithFile,
-                    user_data: rawptr,
-                ) {
-                    name1 := cast(^string)user_data
-                    om.insert(
-                        &stone2.types,
-                        name1^,
-                        om.get(stone1.types, name1^),
-                    )
-                },
-                &name1,
-                allocator = rn_arena_alloc,
+                &counts,
+                rn_arena_alloc,
             )
+            counts[group.cross_idx].symbols += 1
         }
-
-        // symbols
-        for entry1 in stone1.symbols.data {
-            name1 := entry1.key
-
-            plats := get_same_platforms(
+        for &group in cs.constant_groups {
+            if len(group.plats) == 0 do continue
+            group.cross_idx = assign_cross_group(
                 stone1,
-                origin,
-                proc(
-                    stone1, stone2: RunestoneWithFile,
-                    user_data: rawptr,
-                ) -> bool {
-                    name1 := cast(^string)user_data
-                    symbol1 := om.get(stone1.symbols, name1^)
-
-                    if symbol2, ok := om.get(stone2.symbols, name1^); ok {
-                        if is_same(symbol1, symbol2) {
-                            return true
-                        }
-                    }
-
-                    return false
-                },
-                &name1,
+                group.plats,
+                &cross_index,
+                &rc,
+                &counts,
+                rn_arena_alloc,
             )
-            defer delete(plats)
+            counts[group.cross_idx].constants += 1
+        }
+    }
 
-            set_for_same_platforms(
-                stone1,
-                plats,
-                om.length(origin),
-                &rc,
-                proc(
-                    stone1: RunestoneWithFile,
-                    stone2: ^RunestoneWithFile,
-                    user_data: rawptr,
-                ) {
-                    name1 := cast(^string)user_data
-                    symbol1 := om.get(stone1.symbols, name1^)
+    // The cross stones are allocated with their final size, so that no memory is wasted for growing them
+    for count, cross_idx in counts {
+        cross := &rc.cross[cross_idx]
+        om.reserve(&cross.types, count.types)
+        om.reserve(&cross.symbols, count.symbols)
+        om.reserve(&cross.constants, count.constants)
+    }
 
-                    if symbol2, ok := om.get(stone2.symbols, name1^); ok {
-                        for alias in symbol1.aliases {
-                            if !slice.contains(symbol2.aliases[:], alias) {
-                                append(&symbol2.aliases, alias)
-                            }
-                        }
+    for entry0, stone1_idx in origin.data {
+        stone1 := entry0.value
+        cs := &crossing[stone1_idx]
 
-                        om.insert(&stone2.symbols, name1^, symbol2)
-                    } else {
-                        om.insert(&stone2.symbols, name1^, symbol1)
-                    }
-                },
-                &name1,
-                allocator = rn_arena_alloc,
+        for entry1, idx1 in stone1.types.data {
+            group := cs.type_groups[idx1]
+            if len(group.plats) == 0 do continue
+
+            om.insert(
+                &rc.cross[group.cross_idx].types,
+                entry1.key,
+                entry1.value,
             )
         }
 
-        // constants
-        for entry1 in stone1.constants.data {
-            name1 := entry1.key
+        for entry1, idx1 in stone1.symbols.data {
+            group := cs.symbol_groups[idx1]
+            if len(group.plats) == 0 do continue
 
-            plats := get_same_platforms(
-                stone1,
+            merge_symbol(
+                &rc.cross[group.cross_idx],
+                entry1.key,
+                entry1.value,
+                group.same[:],
                 origin,
-                proc(
-                    stone1, stone2: RunestoneWithFile,
-                    user_data: rawptr,
-                ) -> bool {
-                    name1 := cast(^string)user_data
-                    constant1 := om.get(stone1.constants, name1^)
-
-                    if constant2, ok := om.get(stone2.constants, name1^); ok {
-                        if is_same(constant1, constant2) {
-                            return true
-                        }
-                    }
-
-                    return false
-                },
-                &name1,
+                rn_arena_alloc,
             )
-            defer delete(plats)
+        }
 
-            set_for_same_platforms(
-                stone1,
-                plats,
-                om.length(origin),
-                &rc,
-                proc(
-                    stone1: RunestoneWithFile,
-                    stone2: ^RunestoneWithFile,
-                    user_data: rawptr,
-                ) {
-                    name1 := cast(^string)user_data
-                    constant1 := om.get(stone1.constants, name1^)
-                    om.insert(&stone2.constants, name1^, constant1)
-                },
-                &name1,
-                allocator = rn_arena_alloc,
+        for entry1, idx1 in stone1.constants.data {
+            group := cs.constant_groups[idx1]
+            if len(group.plats) == 0 do continue
+
+            om.insert(
+                &rc.cross[group.cross_idx].constants,
+                entry1.key,
+                entry1.value,
             )
         }
     }
 
     // extern
-    for &stone, stone_idx in rc.cross {
+    // Count how many cross stones contain every platform, to know wether there is a more common runestone than another one
+    plat_stone_count := make(map[Platform]int)
+    defer delete(plat_stone_count)
+    for stone in rc.cross {
+        for plat in stone.plats {
+            plat_stone_count[plat] += 1
+        }
+    }
+
+    for &stone in rc.cross {
         externs := &stone.externs
 
+        // NOTE: The algorithm for determining wether there is a more common runestone is not perfect
+        has_more_common: bool
+        more_common_loop: for stone_plat in stone.plats {
+            // Go one step higher in commonality per iteration
+            for sp := stone_plat; sp != Platform{.Any, .Any}; {
+                sp = more_common_platform(sp)
+
+                count := plat_stone_count[sp]
+                if slice.contains(stone.plats, sp) do count -= 1
+
+                if count != 0 {
+                    has_more_common = true
+                    break more_common_loop
+                }
+            }
+        }
+
         // Loop over all plaforms of a runestone
         // if it has any platforms then handle it
         // as if it has all of them
@@ -298,87 +329,42 @@ cross_the_runes :: proc(
         //  Linux Any -> it needs to be part of all Linux runestones
         //  Any x86_64 -> it needs to be part of all x86_64 runestones
         for plat in stone.plats {
-            stone_oses: [dynamic]OS
-            stone_archs: [dynamic]Architecture
-            defer delete(stone_oses)
-            defer delete(stone_archs)
-
-            if plat.os == .Any {
-                for os in OS_MIN ..= OS_MAX {
-                    append(&stone_oses, os)
-                }
-            } else {
-                append(&stone_oses, plat.os)
-            }
-
-            if plat.arch == .Any {
-                for arch in Architecture_MIN ..= Architecture_MAX {
-                    append(&stone_archs, arch)
-                }
-            } else {
-                append(&stone_archs, plat.arch)
-            }
-
             // Look up every runestone of every platform
             // and add the externs of it
-            for os in stone_oses {
-                for arch in stone_archs {
-                    look_up_plat := Platform{os, arch}
-                    if origin_stone, ok := om.get(origin, look_up_plat); ok {
-                        origin_extern_loop: for entry in origin_stone.externs.data {
-                            type_name, extern := entry.key, entry.value
-
-                            // If there is no source defined for the extern type only add it if it is not part of a more common runestone
-                            // NOTE: The algorithm for determining wether there is a more common runestone is not perfect
-                            source_defined: bool
-                            if extern_sources != nil do _, source_defined = map_glob(extern_sources, extern.source)
-                            if !source_defined {
-                                // Loop over all plats of the stone
-                                for stone_plat in stone.plats {
-                                    // Go one step higher in commonality per iteration
-                                    for sp := stone_plat;
-                                        sp.os != .Any || sp.arch != .Any; {
-                                        if sp.arch == .Any {
-                                            sp.os = .Any
-                                        } else {
-                                            sp.arch = .Any
-                                        }
-
-                                        // Go through all cross stones and check wether a stone with this more common platform exists
-                                        for common_cross, common_idx in rc.cross {
-                                            if common_idx == stone_idx do continue
-
-                                            for common_plat in common_cross.plats {
-                                                if common_plat == sp do continue origin_extern_loop
-                                            }
-                                        }
-                                    }
-                                }
-                            }
+            for bit in platform_set_of(plat, cross_index.origin) {
+                origin_stone := om.get(origin, platform_of_bit(bit))
 
-                            // if the extern already exists check if it has the same type
-                            // the source does not matter
-                            if already_extern, already := om.get(
-                                externs^,
-                                type_name,
-                            ); already {
-                                // If it already exists and does not have the same type
-                                // set the spec to Untyped since it is invalid
-                                if !is_same(extern.type, already_extern.type) {
-                                    already_extern.type = Type {
-                                        spec = Builtin.Untyped,
-                                    }
-                                    om.insert(
-                                        externs,
-                                        type_name,
-                                        already_extern,
-                                    )
-                                }
-                            } else {
-                                // if it does not yet exist just insert it
-                                om.insert(externs, type_name, extern)
+                for entry in origin_stone.externs.data {
+                    type_name, extern := entry.key, entry.value
+
+                    // If there is no source defined for the extern type only add it if it is not part of a more common runestone
+                    if has_more_common {
+                        source_defined: bool
+                        if extern_sources != nil do _, source_defined = map_glob(extern_sources, extern.source)
+                        if !source_defined do continue
+                    }
+
+                    // if the extern already exists check if it has the same type
+                    // the source does not matter
+                    if already_extern, already := om.get(
+                        externs^,
+                        type_name,
+                    ); already {
+                        // If it already exists and does not have the same type
+                        // set the spec to Untyped since it is invalid
+                        if !is_same(extern.type, already_extern.type) {
+                            already_extern.type = Type {
+                                spec = Builtin.Untyped,
                             }
+                            om.insert(
+                                externs,
+                                type_name,
+                                already_extern,
+                            )
                         }
+                    } else {
+                        // if it does not yet exist just insert it
+                        om.insert(externs, type_name, extern)
                     }
                 }
             }
@@ -397,6 +383,326 @@ cross_the_runes :: proc(
     return
 }
 
+@(private = "file")
+CrossingStone :: struct {
+    type_hashes:       []u64,
+    symbol_hashes:     []u64,
+    constant_hashes:   []u64,
+    types_crossed:     []bool,
+    symbols_crossed:   []bool,
+    constants_crossed: []bool,
+    type_groups:       []CrossGroup,
+    symbol_groups:     []CrossGroup,
+    constant_groups:   []CrossGroup,
+}
+
+// The platforms that have the same entry. Only set for the first runestone of the platforms
+@(private = "file")
+CrossGroup :: struct {
+    plats:     [dynamic]Platform,
+    // Indices into origin of the other runestones that have the same entry
+    same:      [dynamic]int,
+    // Index of the cross stone of plats
+    cross_idx: int,
+}
+
+@(private = "file")
+CrossCounts :: struct {
+    types:     int,
+    symbols:   int,
+    constants: int,
+}
+
+@(private = "file")
+CrossEntry :: struct {
+    name:     string,
+    hash:     u64,
+    crossing: []CrossingStone,
+    origin:   ^om.OrderedMap(Platform, RunestoneWithFile),
+    same:     [dynamic]int,
+}
+
+@(private = "file")
+CrossShard :: struct {
+    shard:       int,
+    shard_count: int,
+    origin:      ^om.OrderedMap(Platform, RunestoneWithFile),
+    crossing:    []CrossingStone,
+    // The groups of the names of the shard are allocated here
+    arena:       runtime.Arena,
+}
+
+@(private = "file")
+crossing_stone_init :: proc(
+    cs: ^CrossingStone,
+    stone: RunestoneWithFile,
+    allocator: runtime.Allocator,
+) {
+    cs.type_hashes = make([]u64, len(stone.types.data), allocator)
+    cs.symbol_hashes = make([]u64, len(stone.symbols.data), allocator)
+    cs.constant_hashes = make([]u64, len(stone.constants.data), allocator)
+    cs.types_crossed = make([]bool, len(stone.types.data), allocator)
+    cs.symbols_crossed = make([]bool, len(stone.symbols.data), allocator)
+    cs.constants_crossed = make([]bool, len(stone.constants.data), allocator)
+    cs.type_groups = make([]CrossGroup, len(stone.types.data), allocator)
+    cs.symbol_groups = make([]CrossGroup, len(stone.symbols.data), allocator)
+    cs.constant_groups = make(
+        []CrossGroup,
+        len(stone.constants.data),
+        allocator,
+    )
+
+    for entry, idx in stone.types.data {
+        cs.type_hashes[idx] = structural_hash(entry.value)
+    }
+    for entry, idx in stone.symbols.data {
+        cs.symbol_hashes[idx] = structural_hash(entry.value)
+    }
+    for entry, idx in stone.constants.data {
+        cs.constant_hashes[idx] = structural_hash(entry.value)
+    }
+}
+
+// Runs every shard on its own thread
+@(private = "file")
+run_cross_shards :: proc(shards: []CrossShard) {
+    if len(shards) == 1 {
+        cross_shard(&shards[0])
+        return
+    }
+
+    pool: thread.Pool
+    thread.pool_init(&pool, context.allocator, len(shards))
+    defer thread.pool_destroy(&pool)
+
+    for &shard, idx in shards {
+        thread.pool_add_task(
+            &pool,
+            context.allocator,
+            proc(task: thread.Task) {
+                cross_shard(cast(^CrossShard)task.data)
+            },
+            &shard,
+            idx,
+        )
+    }
+
+    thread.pool_start(&pool)
+    thread.pool_finish(&pool)
+}
+
+// Finds the platforms of every type, symbol and constant whose name belongs to the shard.
+// Entries of different names never touch the same memory, which is why shards do not need to be synchronized
+@(private = "file")
+cross_shard :: proc(shard: ^CrossShard) {
+    context.allocator = runtime.arena_allocator(&shard.arena)
+
+    for entry0, stone1_idx in shard.origin.data {
+        stone1 := entry0.value
+        cs := &shard.crossing[stone1_idx]
+
+        for entry1, idx1 in stone1.types.data {
+            if cs.types_crossed[idx1] do continue
+            if !name_in_shard(entry1.key, shard^) do continue
+
+            ce := CrossEntry {
+                name     = entry1.key,
+                hash     = cs.type_hashes[idx1],
+                crossing = shard.crossing,
+                origin   = shard.origin,
+            }
+
+            plats := get_same_platforms(
+                stone1,
+                shard.origin^,
+                proc(
+                    stone1, stone2: RunestoneWithFile,
+                    user_data: rawptr,
+                ) -> bool {
+                    ce := cast(^CrossEntry)user_data
+                    idx2 := om.index(stone2.types, ce.name) or_return
+                    stone2_idx := om.index(ce.origin^, stone2.platform)
+                    cs2 := &ce.crossing[stone2_idx]
+
+                    if cs2.type_hashes[idx2] != ce.hash do return false
+                    if !is_same(
+                        om.get(stone1.types, ce.name),
+                        stone2.types.data[idx2].value,
+                    ) {
+                        return false
+                    }
+
+                    cs2.types_crossed[idx2] = true
+                    append(&ce.same, stone2_idx)
+                    return true
+                },
+                &ce,
+            )
+
+            cs.type_groups[idx1] = CrossGroup {
+                plats = plats,
+                same  = ce.same,
+            }
+        }
+
+        for entry1, idx1 in stone1.symbols.data {
+            if cs.symbols_crossed[idx1] do continue
+            if !name_in_shard(entry1.key, shard^) do continue
+
+            ce := CrossEntry {
+                name     = entry1.key,
+                hash     = cs.symbol_hashes[idx1],
+                crossing = shard.crossing,
+                origin   = shard.origin,
+            }
+
+            plats := get_same_platforms(
+                stone1,
+                shard.origin^,
+                proc(
+                    stone1, stone2: RunestoneWithFile,
+                    user_data: rawptr,
+                ) -> bool {
+                    ce := cast(^CrossEntry)user_data
+                    idx2 := om.index(stone2.symbols, ce.name) or_return
+                    stone2_idx := om.index(ce.origin^, stone2.platform)
+                    cs2 := &ce.crossing[stone2_idx]
+
+                    if cs2.symbol_hashes[idx2] != ce.hash do return false
+                    if !is_same(
+                        om.get(stone1.symbols, ce.name),
+                        stone2.symbols.data[idx2].value,
+                    ) {
+                        return false
+                    }
+
+                    cs2.symbols_crossed[idx2] = true
+                    append(&ce.same, stone2_idx)
+                    return true
+                },
+                &ce,
+            )
+
+            cs.symbol_groups[idx1] = CrossGroup {
+                plats = plats,
+                same  = ce.same,
+            }
+        }
+
+        for entry1, idx1 in stone1.constants.data {
+            if cs.constants_crossed[idx1] do continue
+            if !name_in_shard(entry1.key, shard^) do continue
+
+            ce := CrossEntry {
+                name     = entry1.key,
+                hash     = cs.constant_hashes[idx1],
+                crossing = shard.crossing,
+                origin   = shard.origin,
+            }
+
+            plats := get_same_platforms(
+                stone1,
+                shard.origin^,
+                proc(
+                    stone1, stone2: RunestoneWithFile,
+                    user_data: rawptr,
+                ) -> bool {
+                    ce := cast(^CrossEntry)user_data
+                    idx2 := om.index(stone2.constants, ce.name) or_return
+                    stone2_idx := om.index(ce.origin^, stone2.platform)
+                    cs2 := &ce.crossing[stone2_idx]
+
+                    if cs2.constant_hashes[idx2] != ce.hash do return false
+                    if !is_same(
+                        om.get(stone1.constants, ce.name),
+                        stone2.constants.data[idx2].value,
+                    ) {
+                        return false
+                    }
+
+                    cs2.constants_crossed[idx2] = true
+                    append(&ce.same, stone2_idx)
+                    return true
+                },
+                &ce,
+            )
+
+            cs.constant_groups[idx1] = CrossGroup {
+                plats = plats,
+                same  = ce.same,
+            }
+        }
+    }
+}
+
+@(private = "file")
+name_in_shard :: #force_inline proc(name: string, shard: CrossShard) -> bool {
+    if shard.shard_count == 1 do return true
+    name_hash := hash.fnv32a(transmute([]byte)name)
+    return int(name_hash % u32(shard.shard_count)) == shard.shard
+}
+
+// Returns the index of the cross stone of plats and adds it if it does not exist yet
+@(private = "file")
+assign_cross_group :: proc(
+    stone1: RunestoneWithFile,
+    plats: [dynamic]Platform,
+    index: ^CrossIndex,
+    rc: ^Runecross,
+    counts: ^[dynamic]CrossCounts,
+    allocator: runtime.Allocator,
+) -> int {
+    cross_idx := set_for_same_platforms(
+        stone1,
+        plats,
+        index,
+        rc,
+        proc(_: RunestoneWithFile, _: ^RunestoneWithFile, _: rawptr) {},
+        allocator = allocator,
+    )
+    if cross_idx >= len(counts) {
+        resize(counts, cross_idx + 1)
+    }
+    return cross_idx
+}
+
+// Inserts symbol into stone2 and adds the aliases of the same symbol of all other platforms.
+// The aliases are only copied if the other platforms have aliases that symbol does not have
+@(private = "file")
+merge_symbol :: proc(
+    stone2: ^PlatformRunestone,
+    name: string,
+    symbol: Symbol,
+    same: []int,
+    origin: om.OrderedMap(Platform, RunestoneWithFile),
+    allocator: runtime.Allocator,
+) {
+    merged := symbol
+    aliases_copied: bool
+
+    for same_idx in same {
+        other := om.get(origin.data[same_idx].value.symbols, name)
+
+        for alias in other.aliases {
+            if slice.contains(merged.aliases[:], alias) do continue
+
+            if !aliases_copied {
+                merged.aliases = make(
+                    [dynamic]string,
+                    len(symbol.aliases),
+                    len(symbol.aliases) + len(other.aliases),
+                    allocator,
+                )
+                copy(merged.aliases[:], symbol.aliases[:])
+                aliases_copied = true
+            }
+            append(&merged.aliases, alias)
+        }
+    }
+
+    om.insert(&stone2.symbols, name, merged)
+}
+
 runecross_destroy :: proc(rc: ^Runecross, destroy_cross := true) {
     if destroy_cross {
         for &stone in rc.cross {
@@ -506,12 +812,14 @@ is_same_type_specifier :: proc(s1, s2: TypeSpecifier) -> bool {
             switch c1 in e1.value {
             case i64:
                 c2 := e2.value.(i64) or_return
-                return c1 == c2
+                if c1 != c2 do return false
             case string:
                 c2 := e2.value.(string) or_return
-                return c1 == c2
+                if c1 != c2 do return false
             }
         }
+
+        return true
     case Union:
         t2 := s2.(Union) or_return
         if len(t1.members) != len(t2.members) do return false
@@ -685,10 +993,20 @@ get_same_platforms :: proc(
     return
 }
 
+// Maps the platforms of every cross stone to its index in the cross
+@(private = "file")
+CrossIndex :: struct {
+    origin: PlatformSet,
+    stones: map[PlatformSet]int,
+}
+
+// Returns the index of the cross stone of plats and adds it if it does not exist yet.
+// set_proc is called with the cross stone to modify it
+@(private = "file")
 set_for_same_platforms :: proc(
     stone1: RunestoneWithFile,
     plats: [dynamic]Platform,
-    len_origin: int,
+    index: ^CrossIndex,
     rc: ^Runecross,
     set_proc: #type proc(
         stone1: RunestoneWithFile,
@@ -697,22 +1015,19 @@ set_for_same_platforms :: proc(
     ),
     user_data: rawptr = nil,
     allocator := context.allocator,
+) -> (
+    cross_idx: int,
 ) {
-    stone2_loop: for &stone2 in rc.cross {
-        if len(stone2.plats) == len(plats) {
-            for plat2 in stone2.plats {
-                if !slice.contains(plats[:], plat2) {
-                    continue stone2_loop
-                }
-            }
+    plats_set := platform_set_of(plats[:], index.origin)
 
-            if len(plats) == 1 {
-                stone2.platform = plats[0]
-                stone2.file_path = stone1.file_path
-            }
-            set_proc(stone1, &stone2.runestone, user_data)
-            return
+    if stone2_idx, ok := index.stones[plats_set]; ok {
+        stone2 := &rc.cross[stone2_idx]
+        if len(plats) == 1 {
+            stone2.platform = plats[0]
+            stone2.file_path = stone1.file_path
         }
+        set_proc(stone1, &stone2.runestone, user_data)
+        return stone2_idx
     }
 
     stone2: RunestoneWithFile
@@ -723,6 +1038,8 @@ set_for_same_platforms :: proc(
         stone2.file_path = stone1.file_path
     }
     set_proc(stone1, &stone2, user_data)
+    cross_idx = len(rc.cross)
+    index.stones[plats_set] = cross_idx
 
     context.allocator = allocator
     plats_copy := make([]Platform, len(plats), allocator = allocator)
@@ -731,22 +1048,25 @@ set_for_same_platforms :: proc(
         &rc.cross,
         PlatformRunestone{plats = plats_copy, runestone = stone2},
     )
+    return
 }
 
-source_of_extern_type_from_runecross :: proc(
-    extern: ExternType,
+// Maps the name of every extern type of the runecross to its source.
+// If multiple cross stones contain the same extern the source of the first one is used
+extern_sources_of_runecross :: proc(
     rc: Runecross,
-) -> (
-    string,
-    bool,
-) #optional_ok {
+    allocator := context.allocator,
+) -> map[string]string {
+    sources := make(map[string]string, allocator = allocator)
+
     for rs in rc.cross {
-        if ex, ok := om.get(rs.externs, string(extern)); ok {
-            return ex.source, true
+        for entry in rs.externs.data {
+            if entry.key in sources do continue
+            sources[entry.key] = entry.value.source
         }
     }
 
-    return "", false
+    return sources
 }
 
 all_platforms_of_runecross :: proc(
@@ -74,6 +74,27 @@ test_is_same :: proc(t: ^testing.T) {
     expect(t, is_same(om.get(rs1.symbols, "b"), om.get(rs2.symbols, "b")))
     expect(t, !is_same(om.get(rs1.symbols, "a"), om.get(rs2.symbols, "b")))
     expect(t, !is_same(om.get(rs1.symbols, "c"), om.get(rs2.symbols, "c")))
+
+    expect_value(
+        t,
+        structural_hash(om.get(rs1.symbols, "a")),
+        structural_hash(om.get(rs2.symbols, "a")),
+    )
+    expect_value(
+        t,
+        structural_hash(om.get(rs1.symbols, "b")),
+        structural_hash(om.get(rs2.symbols, "b")),
+    )
+    expect(
+        t,
+        structural_hash(om.get(rs1.symbols, "a")) !=
+        structural_hash(om.get(rs1.symbols, "b")),
+    )
+    expect(
+        t,
+        structural_hash(om.get(rs1.symbols, "c")) !=
+        structural_hash(om.get(rs2.symbols, "c")),
+    )
 }
 
 
@@ -188,3 +209,70 @@ test_runecross :: proc(t: ^testing.T) {
     expect_value(t, om.length(windows_cross.symbols), 1)
 }
 
+
+@(test)
+test_runecross_jobs :: proc(t: ^testing.T) {
+    using testing
+
+    linux_rd, windows_rd: strings.Reader
+    strings.reader_init(&linux_rd, LINUX_RUNESTONE)
+    strings.reader_init(&windows_rd, WINDOWS_RUNESTONE)
+
+    linux_stone, linux_err := parse_runestone(
+        strings.reader_to_stream(&linux_rd),
+        "/linux",
+    )
+    if !expect_value(t, linux_err, nil) do return
+    defer runestone_destroy(&linux_stone)
+
+    windows_stone, windows_err := parse_runestone(
+        strings.reader_to_stream(&windows_rd),
+        "/windows",
+    )
+    if !expect_value(t, windows_err, nil) do return
+    defer runestone_destroy(&windows_stone)
+
+    sequential, seq_err := cross_the_runes(
+        {"/linux", "/windows"},
+        {linux_stone, windows_stone},
+    )
+    if !expect_value(t, seq_err, nil) do return
+    defer runecross_destroy(&sequential)
+
+    parallel, par_err := cross_the_runes(
+        {"/linux", "/windows"},
+        {linux_stone, windows_stone},
+        jobs = 3,
+        shard_min_entries = 1,
+    )
+    if !expect_value(t, par_err, nil) do return
+    defer runecross_destroy(&parallel)
+
+    if !expect_value(t, len(parallel.cross), len(sequential.cross)) do return
+
+    for seq_stone, idx in sequential.cross {
+        par_stone := parallel.cross[idx]
+
+        expect(t, slice.equal(par_stone.plats, seq_stone.plats))
+
+        if expect_value(
+            t,
+            om.length(par_stone.types),
+            om.length(seq_stone.types),
+        ) {
+            for entry, type_idx in seq_stone.types.data {
+                expect_value(t, par_stone.types.data[type_idx].key, entry.key)
+            }
+        }
+
+        if expect_value(
+            t,
+            om.length(par_stone.symbols),
+            om.length(seq_stone.symbols),
+        ) {
+            for entry, sym_idx in seq_stone.symbols.data {
+                expect_value(t, par_stone.symbols.data[sym_idx].key, entry.key)
+            }
+        }
+    }
+}
@@ -18,18 +18,23 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 package runic
 
 import "base:runtime"
+import "core:bufio"
 import "core:fmt"
 import "core:io"
-import odintz "core:odin/tokenizer"
+import "core:mem/virtual"
 import "core:path/filepath"
 import "core:slice"
 import "core:strconv"
 import "core:strings"
 import "core:unicode"
+import "root:console"
 import "root:errors"
 import "root:ini"
 import om "root:ordered_map"
+import "root:trace"
 
+// Parses a runestone in the text format. The runestone is parsed in a single pass over the lines of in_stm
+// and all entries are parsed directly into the arena of the runestone
 parse_runestone :: proc(
     in_stm: io.Reader,
     file_path: string,
@@ -46,257 +51,406 @@ parse_runestone :: proc(
 
     arena_alloc := runtime.arena_allocator(&temp_arena)
 
-    ini_file := ini.parse(in_stm, file_path) or_return
+    p := RunestoneParser {
+        rs         = &rs,
+        file_path  = file_path,
+        remaps     = make([dynamic]KeyValue, arena_alloc),
+        aliases    = make([dynamic]KeyValue, arena_alloc),
+        methods    = make([dynamic]KeyValue, arena_alloc),
+        type_cache = {
+            types = make(map[string]Type, allocator = arena_alloc),
+        },
+    }
 
-    using rs
+    line_reader: bufio.Reader
+    bufio.reader_init(&line_reader, in_stm, allocator = arena_alloc)
+    defer bufio.reader_destroy(&line_reader)
 
-    global: {
-        sect, ok := ini_file[""]
-        errors.wrap(ok) or_return
-        defer delete_key(&ini_file, "")
+    long_line := make([dynamic]u8, arena_alloc)
 
-        version_str, ok1 := om.get(sect, "version")
-        errors.wrap(ok1) or_return
-
-        version, ok = strconv.parse_uint(version_str, 10)
-        errors.wrap(ok) or_return
-
-        os_str, ok2 := om.get(sect, "os")
-        errors.wrap(ok2) or_return
-
-        switch platform.os {
-        case .Linux, .Windows, .Macos, .BSD, .Any:
-        // Just a reminder to update this when platforms change
-        }
-        switch os_str {
-        case "Linux":
-            platform.os = .Linux
-        case "Windows":
-            platform.os = .Windows
-        case "Macos":
-            platform.os = .Macos
-        case "BSD":
-            platform.os = .BSD
-        case "Any":
-            err = errors.message("a runestone can not have any os")
-            return
-        case:
-            err = errors.message("invalid os \"{}\"", os_str)
+    for line_count: uint = 1;; line_count += 1 {
+        line, read_err := read_runestone_line(&line_reader, &long_line)
+        if read_err != .None && read_err != .EOF {
+            err = errors.wrap(read_err)
             return
         }
 
-        arch_str, ok3 := om.get(sect, "arch")
-        errors.wrap(ok3) or_return
-
-        switch platform.arch {
-        case .x86_64, .arm64, .Any, .x86, .arm32:
-        // Just a reminder to update this when platforms change
-        }
-        switch arch_str {
-        case "x86_64":
-            platform.arch = .x86_64
-        case "arm64":
-            platform.arch = .arm64
-        case "x86":
-            platform.arch = .x86
-        case "arm32":
-            platform.arch = .arm32
-        case "Any":
-            err = errors.message("a runestone can not have any architecture")
-            return
-        case:
-            err = errors.message("invalid arch \"{}\"", arch_str)
-            return
+        line_str := strings.trim_space(string(line))
+        if len(line_str) != 0 {
+            parse_runestone_line(&p, line_str, line_count) or_return
         }
+
+        if read_err == .EOF do break
     }
 
-    lib_section: {
-        sect, ok := ini_file["lib"]
-        errors.wrap(ok) or_return
-        defer delete_key(&ini_file, "lib")
+    finish_runestone(&p) or_return
+    return
+}
+
+// Parses a runestone in the text format from data without copying it.
+// The strings of the runestone point into data, which therefore needs to outlive it
+parse_runestone_bytes :: proc(
+    data: []byte,
+    file_path: string,
+) -> (
+    rs: Runestone,
+    err: errors.Error,
+) {
+    context.allocator = init_runestone(&rs)
 
-        shared, shared_ok := om.get(sect, "shared")
-        static, static_ok := om.get(sect, "static")
+    def_alloc := runtime.default_allocator()
+    temp_arena: runtime.Arena
+    errors.wrap(runtime.arena_init(&temp_arena, 0, def_alloc)) or_return
+    defer runtime.arena_destroy(&temp_arena)
 
-        if shared_ok && len(shared) != 0 {
-            lib.shared = relative_to_file(file_path, shared, needs_dir = true)
-        }
-        if static_ok && len(static) != 0 {
-            lib.static = relative_to_file(file_path, static, needs_dir = true)
-        }
+    arena_alloc := runtime.arena_allocator(&temp_arena)
 
-        errors.assert(
-            lib.shared != nil || lib.static != nil,
-            "No libraries have been specified",
-        ) or_return
+    p := RunestoneParser {
+        rs         = &rs,
+        file_path  = file_path,
+        zero_copy  = true,
+        remaps     = make([dynamic]KeyValue, arena_alloc),
+        aliases    = make([dynamic]KeyValue, arena_alloc),
+        methods    = make([dynamic]KeyValue, arena_alloc),
+        type_cache = {
+            types = make(map[string]Type, allocator = arena_alloc),
+        },
     }
 
-    symbols_section: {
-        sect, ok := ini_file["symbols"]
-        errors.wrap(ok, "no symbols") or_return
-        defer delete_key(&ini_file, "symbols")
+    str := string(data)
+    line_count: uint
+    for line in strings.split_lines_iterator(&str) {
+        line_count += 1
+
+        line_str := strings.trim_space(line)
+        if len(line_str) != 0 {
+            parse_runestone_line(&p, line_str, line_count) or_return
+        }
+    }
 
-        for value in sect.data {
-            name, def := value.key, value.value
-            symbol_type: string = ---
-            symbol_name: string = ---
+    finish_runestone(&p) or_return
+    return
+}
 
-            arr, alloc_err := strings.split(name, ".", arena_alloc)
-            errors.wrap(alloc_err) or_return
+@(private = "file")
+RunestoneSection :: enum {
+    Global,
+    Lib,
+    Symbols,
+    Remap,
+    Alias,
+    Extern,
+    Types,
+    Methods,
+    Constants,
+}
 
-            if len(arr) != 2 do return rs, errors.message("\"{}\" none or too much dots in symbol name. a symbol needs the pattern var.name or func.name", name)
+@(private = "file")
+KeyValue :: struct {
+    key, value: string,
+}
 
-            symbol_type = arr[0]
-            symbol_name = arr[1]
+@(private = "file")
+RunestoneParser :: struct {
+    rs:          ^Runestone,
+    file_path:   string,
+    section:     RunestoneSection,
+    sections:    bit_set[RunestoneSection],
+    has_version: bool,
+    has_os:      bool,
+    has_arch:    bool,
+    // If set, the lines are stored in the runestone without copying them
+    zero_copy:   bool,
+    remaps:      [dynamic]KeyValue,
+    aliases:     [dynamic]KeyValue,
+    methods:     [dynamic]KeyValue,
+    type_cache:  TypeCache,
+}
 
-            switch symbol_type {
-            case "func":
-                func := parse_func(def) or_return
+// Checks that all required entries have been parsed and adds the entries that refer to symbols
+@(private = "file")
+finish_runestone :: proc(p: ^RunestoneParser) -> (err: errors.Error) {
+    rs := p.rs
+    using rs
 
-                om.insert(&symbols, symbol_name, Symbol{value = func})
-            case "var":
-                var := parse_type(def) or_return
+    errors.wrap(p.has_version, "no version") or_return
+    errors.wrap(p.has_os, "no os") or_return
+    errors.wrap(p.has_arch, "no arch") or_return
 
-                om.insert(&symbols, symbol_name, Symbol{value = var})
-            case:
-                err = errors.message("invalid symbol type {}", symbol_type)
-                return
-            }
-        }
-    }
+    errors.wrap(.Lib in p.sections, "no lib") or_return
+    errors.assert(
+        lib.shared != nil || lib.static != nil,
+        "No libraries have been specified",
+    ) or_return
 
-    remap: {
-        sect, ok := ini_file["remap"]
-        if !ok do break remap
-        defer delete_key(&ini_file, "remap")
+    errors.wrap(.Symbols in p.sections, "no symbols") or_return
 
-        for value in sect.data {
-            remap_name, symbol_name := value.key, value.value
-            symbol, sym_ok := om.get(symbols, symbol_name)
-            errors.wrap(sym_ok) or_return
+    // Remaps, aliases and methods refer to symbols which is why they are added after all symbols have been parsed
+    for value in p.remaps {
+        remap_name, symbol_name := value.key, value.value
+        symbol, sym_ok := om.get(symbols, symbol_name)
+        errors.wrap(sym_ok) or_return
 
-            if symbol.remap != nil do return rs, errors.message("remap has already been set for {}", symbol_name)
+        if symbol.remap != nil do return errors.message("remap has already been set for {}", symbol_name)
 
-            symbol.remap = symbol_name
-            om.replace(&symbols, symbol_name, remap_name, symbol)
-        }
+        symbol.remap = symbol_name
+        om.replace(&symbols, symbol_name, remap_name, symbol)
     }
 
-    alias: {
-        sect, ok := ini_file["alias"]
-        if !ok do break alias
-        defer delete_key(&ini_file, "alias")
-
-        for value in sect.data {
-            alias_name, symbol_name := value.key, value.value
-            symbol, sym_ok := om.get(symbols, symbol_name)
-            errors.wrap(sym_ok) or_return
+    for value in p.aliases {
+        alias_name, symbol_name := value.key, value.value
+        symbol, sym_ok := om.get(symbols, symbol_name)
+        errors.wrap(sym_ok) or_return
 
-            append(&symbol.aliases, alias_name)
-            om.insert(&symbols, symbol_name, symbol)
-        }
+        append(&symbol.aliases, alias_name)
+        om.insert(&symbols, symbol_name, symbol)
     }
 
-    extern_section: {
-        sect, ok := ini_file["extern"]
-        if !ok do break extern_section
-        defer delete_key(&ini_file, "extern")
+    for value in p.methods {
+        method_def, symbol_name := value.key, value.value
 
-        for value in sect.data {
-            type_name, extern_value := value.key, value.value
+        dot_idx := strings.index_byte(method_def, '.')
+        errors.wrap(
+            dot_idx != -1 &&
+            strings.index_byte(method_def[dot_idx + 1:], '.') == -1,
+        ) or_return
 
-            str_idx := strings.index(extern_value, "\"")
-            EXTERN_SOURCE_MISSING :: "\"extern\" entries require a string specifying the source at the front"
-            errors.assert(str_idx != -1, EXTERN_SOURCE_MISSING) or_return
+        method_caller := method_def[:dot_idx]
+        method_name := method_def[dot_idx + 1:]
 
-            source_start := str_idx + 1
-            // TODO: handle strings containg '"' character
-            str_idx = strings.index(extern_value[source_start:], "\"")
-            errors.assert(str_idx != -1, EXTERN_SOURCE_MISSING) or_return
-            str_idx += source_start
+        symbol, sym_ok := om.get(symbols, symbol_name)
+        errors.wrap(sym_ok) or_return
 
-            source_end := str_idx
-            source_string := extern_value[source_start:source_end]
+        func, ok1 := symbol.value.(Function)
+        errors.wrap(ok1) or_return
 
-            extern_type := parse_type(extern_value[str_idx + 1:]) or_return
+        errors.wrap(func.method_info == nil) or_return
 
-            om.insert(
-                &rs.externs,
-                type_name,
-                Extern{type = extern_type, source = source_string},
-            )
+        func.method_info = MethodInfo {
+            type = method_caller,
+            name = method_name,
         }
+
+        symbol.value = func
+        om.insert(&symbols, symbol_name, symbol)
     }
 
-    types: {
-        sect, ok := ini_file["types"]
-        if !ok do break types
-        defer delete_key(&ini_file, "types")
+    return
+}
 
-        for value in sect.data {
-            type_name, type_def := value.key, value.value
-            type := parse_type(type_def) or_return
-            om.insert(&rs.types, type_name, type)
-        }
+// Reads the next line. Lines that do not fit into the buffer of rd are collected in long_line
+@(private = "file")
+read_runestone_line :: proc(
+    rd: ^bufio.Reader,
+    long_line: ^[dynamic]u8,
+) -> (
+    line: []u8,
+    err: io.Error,
+) {
+    line, err = bufio.reader_read_slice(rd, '\n')
+    if err != .Buffer_Full do return
+
+    clear(long_line)
+    append(long_line, ..line)
+    for err == .Buffer_Full {
+        line, err = bufio.reader_read_slice(rd, '\n')
+        append(long_line, ..line)
     }
 
-    methods: {
-        sect, ok := ini_file["methods"]
-        if !ok do break methods
-        defer delete_key(&ini_file, "methods")
+    line = long_line[:]
+    return
+}
 
-        for value in sect.data {
-            method_def, symbol_name := value.key, value.value
-            method_caller: string = ---
-            method_name: string = ---
-            arr, alloc_err := strings.split(method_def, ".", arena_alloc)
-            errors.wrap(alloc_err) or_return
-            errors.wrap(len(arr) == 2) or_return
+// Parses one trimmed line of a runestone into the runestone of p
+@(private = "file")
+parse_runestone_line :: proc(
+    p: ^RunestoneParser,
+    line: string,
+    line_count: uint,
+) -> (
+    err: errors.Error,
+) {
+    rs := p.rs
+    using rs
 
-            method_caller = arr[0]
-            method_name = arr[1]
+    if strings.has_prefix(line, "[") {
+        if !strings.has_suffix(line, "]") {
+            err = errors.message(
+                "{}:{}: invalid section statement; \"]\" expected",
+                p.file_path,
+                line_count,
+            )
+            return
+        }
 
-            symbol, sym_ok := om.get(symbols, symbol_name)
-            errors.wrap(sym_ok) or_return
+        switch line[1:len(line) - 1] {
+        case "lib":
+            p.section = .Lib
+        case "symbols":
+            p.section = .Symbols
+        case "remap":
+            p.section = .Remap
+        case "alias":
+            p.section = .Alias
+        case "extern":
+            p.section = .Extern
+        case "types":
+            p.section = .Types
+        case "methods":
+            p.section = .Methods
+        case "constants":
+            p.section = .Constants
+        case:
+            err = errors.message(
+                "{}:{}: unrecognized section \"{}\"",
+                p.file_path,
+                line_count,
+                line[1:len(line) - 1],
+            )
+            return
+        }
 
-            func, ok1 := symbol.value.(Function)
-            errors.wrap(ok1) or_return
+        p.sections += {p.section}
+        return
+    }
 
-            errors.wrap(func.method_info == nil) or_return
+    // Everything that is stored in the runestone needs to outlive the buffer of the line reader
+    stored_line := line
+    #partial switch p.section {
+    case .Global, .Lib:
+    case:
+        if !p.zero_copy do stored_line = strings.clone(line)
+    }
+
+    key, value, ok := ini.split_key_value(stored_line)
+    if !ok {
+        err = errors.message(
+            "{}:{}: \"=\" expected",
+            p.file_path,
+            line_count,
+        )
+        return
+    }
 
-            func.method_info = MethodInfo {
-                type = method_caller,
-                name = method_name,
+    switch p.section {
+    case .Global:
+        switch key {
+        case "version":
+            version, ok = strconv.parse_uint(value, 10)
+            errors.wrap(ok) or_return
+            p.has_version = true
+        case "os":
+            switch platform.os {
+            case .Linux, .Windows, .Macos, .BSD, .Any:
+            // Just a reminder to update this when platforms change
+            }
+            switch value {
+            case "Linux":
+                platform.os = .Linux
+            case "Windows":
+                platform.os = .Windows
+            case "Macos":
+                platform.os = .Macos
+            case "BSD":
+                platform.os = .BSD
+            case "Any":
+                err = errors.message("a runestone can not have any os")
+                return
+            case:
+                err = errors.message("invalid os \"{}\"", value)
+                return
+            }
+            p.has_os = true
+        case "arch":
+            switch platform.arch {
+            case .x86_64, .arm64, .Any, .x86, .arm32:
+            // Just a reminder to update this when platforms change
+            }
+            switch value {
+            case "x86_64":
+                platform.arch = .x86_64
+            case "arm64":
+                platform.arch = .arm64
+            case "x86":
+                platform.arch = .x86
+            case "arm32":
+                platform.arch = .arm32
+            case "Any":
+                err = errors.message(
+                    "a runestone can not have any architecture",
+                )
+                return
+            case:
+                err = errors.message("invalid arch \"{}\"", value)
+                return
             }
+            p.has_arch = true
+        }
+    case .Lib:
+        if len(value) == 0 do return
 
-            symbol.value = func
-            om.insert(&symbols, symbol_name, symbol)
+        switch key {
+        case "shared":
+            lib.shared = relative_to_file(p.file_path, value, needs_dir = true)
+        case "static":
+            lib.static = relative_to_file(p.file_path, value, needs_dir = true)
         }
-    }
+    case .Symbols:
+        dot_idx := strings.index_byte(key, '.')
+        if dot_idx == -1 || strings.index_byte(key[dot_idx + 1:], '.') != -1 do return errors.message("\"{}\" none or too much dots in symbol name. a symbol needs the pattern var.name or func.name", key)
 
-    constants: {
-        sect, ok := ini_file["constants"]
-        if !ok do break constants
-        defer delete_key(&ini_file, "constants")
+        symbol_type := key[:dot_idx]
+        symbol_name := key[dot_idx + 1:]
 
-        for value in sect.data {
-            name, value_type := value.key, value.value
-            c := parse_constant(value_type) or_return
-            om.insert(&rs.constants, name, c)
-        }
-    }
+        switch symbol_type {
+        case "func":
+            func := parse_func(value, &p.type_cache) or_return
 
-    if len(ini_file) != 0 {
-        when ODIN_DEBUG {
-            fmt.eprintln("Sections")
-            for sec in ini_file {
-                fmt.eprintfln("\"{}\"", sec)
-            }
+            om.insert(&symbols, symbol_name, Symbol{value = func})
+        case "var":
+            var := parse_type(value, &p.type_cache) or_return
+
+            om.insert(&symbols, symbol_name, Symbol{value = var})
+        case:
+            err = errors.message("invalid symbol type {}", symbol_type)
+            return
         }
-        return rs, errors.message(
-            "unrecognized sections in ini: {}",
-            len(ini_file),
+    case .Remap:
+        append(&p.remaps, KeyValue{key, value})
+    case .Alias:
+        append(&p.aliases, KeyValue{key, value})
+    case .Methods:
+        append(&p.methods, KeyValue{key, value})
+    case .Extern:
+        str_idx := strings.index(value, "\"")
+        EXTERN_SOURCE_MISSING :: "\"extern\" entries require a string specifying the source at the front"
+        errors.assert(str_idx != -1, EXTERN_SOURCE_MISSING) or_return
+
+        source_start := str_idx + 1
+        // TODO: handle strings containg '"' character
+        str_idx = strings.index(value[source_start:], "\"")
+        errors.assert(str_idx != -1, EXTERN_SOURCE_MISSING) or_return
+        str_idx += source_start
+
+        source_end := str_idx
+        source_string := value[source_start:source_end]
+
+        extern_type := parse_type(
+            value[str_idx + 1:],
+            &p.type_cache,
+        ) or_return
+
+        om.insert(
+            &externs,
+            key,
+            Extern{type = extern_type, source = source_string},
         )
+    case .Types:
+        type := parse_type(value, &p.type_cache) or_return
+        om.insert(&types, key, type)
+    case .Constants:
+        c := parse_constant(value, &p.type_cache) or_return
+        om.insert(&constants, key, c)
     }
 
     return
@@ -304,18 +458,18 @@ parse_runestone :: proc(
 
 runestone_destroy :: proc(rs: ^Runestone) {
     when ODIN_DEBUG {
-        fmt.eprintfln(
+        console.eprintfln(
             "------ Runestone {}-{} Memory Report -------",
             rs.platform.os,
             rs.platform.arch,
         )
-        fmt.eprintfln("--- total_used:         {}B", rs.arena.total_used)
-        fmt.eprintfln("--- total_capacity:     {}B", rs.arena.total_capacity)
-        fmt.eprintfln(
+        console.eprintfln("--- total_used:         {}B", rs.arena.total_used)
+        console.eprintfln("--- total_capacity:     {}B", rs.arena.total_capacity)
+        console.eprintfln(
             "--- minimum_block_size: {}B",
             rs.arena.minimum_block_size,
         )
-        fmt.eprintln("-------------------------------------")
+        console.eprintln("-------------------------------------")
     }
 
     om.delete(rs.symbols)
@@ -323,6 +477,9 @@ runestone_destroy :: proc(rs: ^Runestone) {
     om.delete(rs.constants)
     om.delete(rs.externs)
     runtime.arena_destroy(&rs.arena)
+    if rs.mapping != nil {
+        virtual.release(raw_data(rs.mapping), uint(len(rs.mapping)))
+    }
 }
 
 init_runestone :: proc(
@@ -366,46 +523,18 @@ write_runestone :: proc(
 
     if shared, ok := rs.lib.shared.?; ok {
         io.write_string(wd, "shared = ") or_return
-
-        if filepath.is_abs(shared) {
-            dir_name := filepath.dir(file_path)
-            defer delete(dir_name)
-            rel_shared, err := filepath.rel(dir_name, shared)
-            if err == .None && len(rel_shared) < len(shared) {
-                if !strings.contains(rel_shared, "/") &&
-                   !strings.contains(rel_shared, "\\") {
-                    io.write_string(wd, "./") or_return
-                }
-                io.write_string(wd, rel_shared) or_return
-            } else {
-                io.write_string(wd, shared) or_return
-            }
-        } else {
-            io.write_string(wd, shared) or_return
-        }
-
+        io.write_string(
+            wd,
+            runestone_library_path(file_path, shared, context.temp_allocator),
+        ) or_return
         io.write_rune(wd, '\n') or_return
     }
     if static, ok := rs.lib.static.?; ok {
         io.write_string(wd, "static = ") or_return
-
-        if filepath.is_abs(static) {
-            dir_name := filepath.dir(file_path)
-            defer delete(dir_name)
-            rel_static, err := filepath.rel(dir_name, static)
-            if err == .None && len(rel_static) < len(static) {
-                if !strings.contains(rel_static, "/") &&
-                   !strings.contains(rel_static, "\\") {
-                    io.write_string(wd, "./") or_return
-                }
-                io.write_string(wd, rel_static) or_return
-            } else {
-                io.write_string(wd, static) or_return
-            }
-        } else {
-            io.write_string(wd, static) or_return
-        }
-
+        io.write_string(
+            wd,
+            runestone_library_path(file_path, static, context.temp_allocator),
+        ) or_return
         io.write_rune(wd, '\n') or_return
     }
     io.write_rune(wd, '\n') or_return
@@ -567,41 +696,106 @@ write_runestone :: proc(
     return .None
 }
 
+// Returns the path of lib relative to the directory of the runestone at file_path if it is shorter.
+// Relative paths without a directory are prefixed with "./", since they would otherwise be treated as system libraries
+@(private)
+runestone_library_path :: proc(
+    file_path, lib: string,
+    allocator := context.allocator,
+) -> string {
+    if !filepath.is_abs(lib) do return lib
+
+    dir_name := filepath.dir(file_path, allocator)
+    defer delete(dir_name, allocator)
+
+    rel_lib, err := filepath.rel(dir_name, lib, allocator)
+    if err != .None || len(rel_lib) >= len(lib) do return lib
+
+    if !strings.contains(rel_lib, "/") && !strings.contains(rel_lib, "\\") {
+        return strings.concatenate({"./", rel_lib}, allocator)
+    }
+    return rel_lib
+}
+
+// If cache is set, simple types are looked up in and added to it
 @(private)
-parse_func :: proc(def: string) -> (func: Function, err: errors.Error) {
-    // TODO: Add Error_Handler to odin tokenizer
-    tokenizer: odintz.Tokenizer = ---
-    odintz.init(&tokenizer, def, "func", nil)
-    func, _ = parse_func_token(&tokenizer) or_return
-    errors.assert(tokenizer.error_count == 0, "failed to tokenize func")
+parse_func :: proc(
+    def: string,
+    cache: ^TypeCache = nil,
+) -> (
+    func: Function,
+    err: errors.Error,
+) {
+    lx: TypeLexer = ---
+    type_lexer_init(&lx, def, cache)
+    func, _ = parse_func_token(&lx) or_return
     return
 }
 
+// If cache is set, simple types are looked up in and added to it
 @(private)
-parse_type :: proc(def: string) -> (type: Type, err: errors.Error) {
-    // TODO: Add Error_Handler to odin tokenizer
-    tokenizer: odintz.Tokenizer
-    odintz.init(&tokenizer, def, "type", nil)
-    type, _ = parse_type_token(&tokenizer) or_return
-    errors.assert(
-        tokenizer.error_count == 0,
-        "failed to tokenizer type",
-    ) or_return
+parse_type :: proc(
+    def: string,
+    cache: ^TypeCache = nil,
+) -> (
+    type: Type,
+    err: errors.Error,
+) {
+    lx: TypeLexer = ---
+    type_lexer_init(&lx, def, cache)
+    type, _ = parse_type_token(&lx) or_return
     return
 }
 
 @(private = "file")
 parse_type_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
+) -> (
+    type: Type,
+    token: TypeToken,
+    err: errors.Error,
+) {
+    if lx.cache == nil do return parse_type_token_uncached(lx)
+
+    start, end, simple := type_lexer_simple_type(lx^)
+    if !simple do return parse_type_token_uncached(lx)
+
+    def := lx.src[start:end]
+    if cached, ok := lx.cache.types[def]; ok {
+        // Only the arrays need to be copied, since everything else of a simple type is a value
+        type = cached
+        if len(cached.array_info) != 0 {
+            type.array_info = make([dynamic]Array, len(cached.array_info))
+            copy(type.array_info[:], cached.array_info[:])
+        }
+
+        lx.offset = end
+        token = type_lexer_scan(lx)
+        return
+    }
+
+    type, token = parse_type_token_uncached(lx) or_return
+
+    // Only cache the type if it has been parsed from exactly the definition
+    token_start := lx.offset - len(token.text)
+    if len(strings.trim_right_space(lx.src[:token_start])) == end {
+        lx.cache.types[def] = type
+    }
+    return
+}
+
+@(private = "file")
+parse_type_token_uncached :: proc(
+    lx: ^TypeLexer,
 ) -> (
     type: Type,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
 
     if token.kind == .Hash {
-        token = odintz.scan(tokenizer)
+        token = type_lexer_scan(lx)
         errors.assert(token.kind == .Ident) or_return
 
         switch token.text {
@@ -653,31 +847,31 @@ parse_type_token :: proc(
             type.spec = Builtin.Opaque
         case "Struct":
             s: Struct = ---
-            s, token = parse_struct_token(tokenizer) or_return
+            s, token = parse_struct_token(lx) or_return
             type.spec = s
             return
         case "Enum":
             e: Enum = ---
-            e, token = parse_enum_token(tokenizer) or_return
+            e, token = parse_enum_token(lx) or_return
             type.spec = e
             return
         case "Union":
             u: Union = ---
-            u, token = parse_union_token(tokenizer) or_return
+            u, token = parse_union_token(lx) or_return
             type.spec = u
             return
         case "Unknown":
-            token = odintz.scan(tokenizer)
+            token = type_lexer_scan(lx)
             errors.assert(token.kind == .Ident) or_return
 
             type.spec = Unknown(token.text)
         case "FuncPtr":
             func: Function = ---
-            func, token = parse_func_token(tokenizer) or_return
+            func, token = parse_func_token(lx) or_return
             type.spec = cast(FunctionPointer)new_clone(func)
             return
         case "Extern":
-            token = odintz.scan(tokenizer)
+            token = type_lexer_scan(lx)
             errors.assert(token.kind == .Ident) or_return
 
             type.spec = ExternType(token.text)
@@ -686,7 +880,7 @@ parse_type_token :: proc(
             return
         }
 
-        token = odintz.scan(tokenizer)
+        token = type_lexer_scan(lx)
     } else if token.kind != .Ident {
         err = errors.message(
             "invalid type specifier \"{}\"",
@@ -695,28 +889,28 @@ parse_type_token :: proc(
         return
     } else {
         type.spec = token.text
-        token = odintz.scan(tokenizer)
+        token = type_lexer_scan(lx)
     }
 
     if token.kind == .Hash {
-        if p, ptz := odin_tokenizer_peek(tokenizer); p.text == "Attr" {
+        if p, ptz := type_lexer_peek(lx); p.text == "Attr" {
             current_pointer_info := &type.pointer_info
             current_array: ^Array
             current_read_only := &type.read_only
             current_write_only := &type.write_only
 
 
-            tokenizer^ = ptz
+            lx^ = ptz
 
-            for token = odintz.scan(tokenizer);
+            for token = type_lexer_scan(lx);
                 token.kind != .EOF && token.kind != .Hash;
-                token = odintz.scan(tokenizer) {
+                token = type_lexer_scan(lx) {
 
                 errors.assert(token.kind == .Ident) or_return
 
                 switch token.text {
                 case "Ptr":
-                    token = odintz.scan(tokenizer)
+                    token = type_lexer_scan(lx)
                     errors.assert(token.kind == .Integer) or_return
 
                     count, ok := strconv.parse_uint(token.text)
@@ -726,7 +920,7 @@ parse_type_token :: proc(
                     current_read_only = &current_pointer_info.read_only
                     current_write_only = &current_pointer_info.write_only
                 case "Arr":
-                    token = odintz.scan(tokenizer)
+                    token = type_lexer_scan(lx)
 
                     append(&type.array_info, Array{})
                     current_array = &type.array_info[len(type.array_info) - 1]
@@ -766,14 +960,14 @@ parse_type_token :: proc(
                     return
                 }
             }
-            token = odintz.scan(tokenizer)
+            token = type_lexer_scan(lx)
 
             errors.assert(
                 token.text == "AttrEnd",
                 "#AttrEnd expected",
             ) or_return
 
-            token = odintz.scan(tokenizer)
+            token = type_lexer_scan(lx)
         }
     }
 
@@ -782,31 +976,31 @@ parse_type_token :: proc(
 
 @(private = "file")
 parse_func_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
 ) -> (
     func: Function,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
-    func.return_type, token = parse_type_token(tokenizer) or_return
+    func.return_type, token = parse_type_token(lx) or_return
 
     for token.kind != .EOF {
         errors.assert(token.kind == .Ident) or_return
 
         name := token.text
 
-        if p, ptz := odin_tokenizer_peek(tokenizer); p.kind == .Hash {
-            if p = odintz.scan(&ptz);
+        if p, ptz := type_lexer_peek(lx); p.kind == .Hash {
+            if p = type_lexer_scan(&ptz);
                p.kind == .Ident && p.text == "Variadic" {
                 func.variadic = true
-                tokenizer^ = ptz
-                token = odintz.scan(tokenizer)
+                lx^ = ptz
+                token = type_lexer_scan(lx)
                 continue
             }
         }
 
         type: Type = ---
-        type, token = parse_type_token(tokenizer) or_return
+        type, token = parse_type_token(lx) or_return
 
         append(&func.parameters, Member{name = name, type = type})
     }
@@ -816,26 +1010,21 @@ parse_func_token :: proc(
 
 @(private = "file")
 parse_struct :: proc(def: string) -> (s: Struct, err: errors.Error) {
-    // TODO: ErrorHandler
-    tokenizer: odintz.Tokenizer = ---
-    odintz.init(&tokenizer, def, "struct", nil)
-    s, _ = parse_struct_token(&tokenizer) or_return
-    errors.assert(
-        tokenizer.error_count == 0,
-        "failed to tokenize struct",
-    ) or_return
+    lx: TypeLexer = ---
+    type_lexer_init(&lx, def)
+    s, _ = parse_struct_token(&lx) or_return
     return
 }
 
 @(private = "file")
 parse_struct_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
 ) -> (
     s: Struct,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
 
     for token.kind != .EOF {
         errors.assert(token.kind == .Ident) or_return
@@ -843,7 +1032,7 @@ parse_struct_token :: proc(
         name := token.text
 
         type: Type = ---
-        type, token = parse_type_token(tokenizer) or_return
+        type, token = parse_type_token(lx) or_return
 
         append(&s.members, Member{name = name, type = type})
     }
@@ -853,29 +1042,24 @@ parse_struct_token :: proc(
 
 @(private = "file")
 parse_enum :: proc(def: string) -> (e: Enum, err: errors.Error) {
-    // TODO: ErrorHandler
-    tokenizer: odintz.Tokenizer = ---
-    odintz.init(&tokenizer, def, "enum", nil)
-    e, _ = parse_enum_token(&tokenizer) or_return
-    errors.assert(
-        tokenizer.error_count == 0,
-        "failed to tokenize enum",
-    ) or_return
+    lx: TypeLexer = ---
+    type_lexer_init(&lx, def)
+    e, _ = parse_enum_token(&lx) or_return
     return
 }
 
 @(private = "file")
 parse_enum_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
 ) -> (
     e: Enum,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
 
     errors.assert(token.kind == .Hash) or_return
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
     errors.assert(token.kind == .Ident) or_return
 
     switch token.text {
@@ -908,13 +1092,13 @@ parse_enum_token :: proc(
         return
     }
 
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
 
     for token.kind != .EOF {
         errors.assert(token.kind == .Ident) or_return
 
         name := token.text
-        token = odintz.scan(tokenizer)
+        token = type_lexer_scan(lx)
 
         value: EnumConstant
 
@@ -934,7 +1118,7 @@ parse_enum_token :: proc(
             return
         }
 
-        token = odintz.scan(tokenizer)
+        token = type_lexer_scan(lx)
 
         append(&e.entries, EnumEntry{name = name, value = value})
     }
@@ -953,39 +1137,44 @@ parse_union :: proc(def: string) -> (u: Union, err: errors.Error) {
 
 @(private = "file")
 parse_union_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
 ) -> (
     u: Union,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
     s: Struct = ---
-    s, token = parse_struct_token(tokenizer) or_return
+    s, token = parse_struct_token(lx) or_return
     u = Union {
         members = s.members,
     }
     return
 }
 
+// If cache is set, simple types are looked up in and added to it
 @(private)
-parse_constant :: proc(def: string) -> (c: Constant, err: errors.Error) {
-    // TODO: ErrorHandler
-    tokenizer: odintz.Tokenizer = ---
-    odintz.init(&tokenizer, def, "constant", nil)
-    c, _ = parse_constant_token(&tokenizer) or_return
-    errors.assert(tokenizer.error_count == 0, "failed to tokenize constant")
+parse_constant :: proc(
+    def: string,
+    cache: ^TypeCache = nil,
+) -> (
+    c: Constant,
+    err: errors.Error,
+) {
+    lx: TypeLexer = ---
+    type_lexer_init(&lx, def, cache)
+    c, _ = parse_constant_token(&lx) or_return
     return
 }
 
 @(private = "file")
 parse_constant_token :: proc(
-    tokenizer: ^odintz.Tokenizer,
+    lx: ^TypeLexer,
 ) -> (
     c: Constant,
-    token: odintz.Token,
+    token: TypeToken,
     err: errors.Error,
 ) {
-    token = odintz.scan(tokenizer)
+    token = type_lexer_scan(lx)
 
     #partial switch token.kind {
     case .Integer:
@@ -1004,16 +1193,16 @@ parse_constant_token :: proc(
     case:
         err = errors.message(
             "{}: int, float or string expected but got \"{}\"",
-            token.pos.column,
+            lx.offset - len(token.text) + 1,
             token.text,
         )
         return
     }
 
-    p, _ := odin_tokenizer_peek(tokenizer)
+    p, _ := type_lexer_peek(lx)
     errors.assert(p.kind == .Hash) or_return
 
-    c.type, token = parse_type_token(tokenizer) or_return
+    c.type, token = parse_type_token(lx) or_return
     return
 }
 
@@ -1208,11 +1397,17 @@ create_anon_type :: proc(
 }
 
 from_postprocess_runestone :: proc(rs: ^Runestone, from: From) {
-    fmt.eprintfln(
+    console.eprintfln(
         "Postprocessing Runestone {}.{} ...",
         rs.platform.os,
         rs.platform.arch,
     )
+    trace.scope(
+        "from_postprocess_runestone",
+        rs.platform.os,
+        ".",
+        rs.platform.arch,
+    )
 
     rs_arena_alloc := runtime.arena_allocator(&rs.arena)
 
@@ -1224,7 +1419,7 @@ from_postprocess_runestone :: proc(rs: ^Runestone, from: From) {
 
     overwrite := platform_value_get(OverwriteSet, from.overwrite, rs.platform)
     if err := overwrite_runestone(rs, overwrite); err != nil {
-        fmt.eprintfln("failed to overwrite runestone: {}", err)
+        console.eprintfln("failed to overwrite runestone: {}", err)
     }
 
     // Validate unknown types
@@ -1252,110 +1447,9 @@ from_postprocess_runestone :: proc(rs: ^Runestone, from: From) {
     }
 
     // Make sure that the types and externs are sorted according to their dependencies (types they refer to)
-    sorted: bool
-    for !sorted {
-        sorted = true
-
-        for i := 0; i < om.length(rs.types); i += 1 {
-            name := rs.types.data[i].key
-            type := rs.types.data[i].value
-
-            deps := compute_dependencies(type)
-            defer delete(deps)
-
-            for dep in deps {
-                dep_idx, dep_ok := om.index(rs.types, dep)
-                if !dep_ok do continue // Should not happen, but just in case
-
-                if dep_idx > i {
-                    cyclic_dependency_detected, dependency_path :=
-                        start_compute_cyclic_dependency(
-                            name,
-                            dep,
-                            rs.types.data[dep_idx].value,
-                            rs.types,
-                        )
-                    defer delete(dependency_path)
-
-                    if cyclic_dependency_detected {
-                        when ODIN_DEBUG {
-                            if !references_type_as_pointer_or_array(
-                                type,
-                                dep,
-                            ) {
-                                fmt.eprintln(
-                                    "debug: dependency cycle detected ",
-                                )
-                                for dp in dependency_path {
-                                    fmt.eprintf("{}->", dp)
-                                }
-                                fmt.eprintfln("{}", name)
-                                fmt.eprintfln(
-                                    "debug: {} will not be moved above {} which depends on it",
-                                    dep,
-                                    name,
-                                )
-                            }
-                        }
-                    } else {
-                        om.move(&rs.types, dep, i)
-                        sorted = false
-                        i += 1
-                    }
-                }
-            }
-        }
-    }
-
-    sorted = false
-    for !sorted {
-        sorted = true
-
-        for i := 0; i < om.length(rs.externs); i += 1 {
-            name := rs.externs.data[i].key
-            type := rs.externs.data[i].value.type
-
-            deps := compute_dependencies(type)
-            defer delete(deps)
-
-            for dep in deps {
-                dep_idx, dep_ok := om.index(rs.externs, dep)
-                if !dep_ok do continue // Should not happen, but just in case
-
-                if dep_idx > i {
-                    cyclic_dependency_detected, dependency_path :=
-                        start_compute_cyclic_dependency(
-                            name,
-                            dep,
-                            rs.externs.data[dep_idx].value,
-                            rs.externs,
-                        )
-                    defer delete(dependency_path)
-
-                    if cyclic_dependency_detected {
-                        if !references_type_as_pointer_or_array(type, dep) {
-                            fmt.eprintln(
-                                "warning: dependency cycle in externs detected ",
-                            )
-                            for dp in dependency_path {
-                                fmt.eprintf("{}->", dp)
-                            }
-                            fmt.eprintfln("{}", name)
-                            fmt.eprintfln(
-                                "warning: {} will not be moved above {} which depends on it",
-                                dep,
-                                name,
-                            )
-                        }
-                    } else {
-                        om.move(&rs.externs, dep, i)
-                        sorted = false
-                        i += 1
-                    }
-                }
-            }
-        }
-    }
+    trace.scope("sort dependencies")
+    sort_by_dependencies(&rs.types)
+    sort_by_dependencies(&rs.externs)
 }
 
 to_preprocess_runestone :: proc(
@@ -1363,7 +1457,7 @@ to_preprocess_runestone :: proc(
     to: To,
     reserved_keywords: []string,
 ) {
-    fmt.eprintfln(
+    console.eprintfln(
         "Preprocessing Runestone {}.{} ...",
         rs.platform.os,
         rs.platform.arch,
@@ -1662,96 +1756,288 @@ to_preprocess_runestone :: proc(
     }
 }
 
-compute_dependencies :: proc(type: Type) -> (deps: [dynamic]string) {
+compute_dependencies :: proc(
+    type: Type,
+    allocator := context.allocator,
+) -> (
+    deps: [dynamic]string,
+) {
+    deps = make([dynamic]string, allocator)
+    append_dependencies(&deps, type)
+    return
+}
+
+// Appends the names of all types that type refers to
+append_dependencies :: proc(deps: ^[dynamic]string, type: Type) {
     #partial switch spec in type.spec {
     case string:
-        append(&deps, spec)
+        append(deps, spec)
     case Struct:
         for member in spec.members {
             #partial switch member_spec in member.type.spec {
             case string:
-                append(&deps, member_spec)
+                append(deps, member_spec)
             }
         }
     case Union:
         for member in spec.members {
             #partial switch member_spec in member.type.spec {
             case string:
-                append(&deps, member_spec)
+                append(deps, member_spec)
             }
         }
     case FunctionPointer:
         #partial switch return_spec in spec.return_type.spec {
         case string:
-            append(&deps, return_spec)
+            append(deps, return_spec)
         }
 
         for param in spec.parameters {
             #partial switch param_spec in param.type.spec {
             case string:
-                append(&deps, param_spec)
+                append(deps, param_spec)
             }
         }
     }
-    return
 }
 
-start_compute_cyclic_dependency :: #force_inline proc(
-    start: string,
-    dep: string,
-    type: Type,
-    types: om.OrderedMap(string, $TypeOrExtern),
+// Sorts the types (or externs) so that every type comes after the types it depends on.
+// The strongly connected components are computed using Tarjan's algorithm which also yields the topological order.
+// A type is placed right before the first type that depends on it, otherwise the order stays the same.
+// Types that are part of a dependency cycle keep their order relative to each other.
+// Returns the number of dependency cycles
+sort_by_dependencies :: proc(
+    types: ^om.OrderedMap(string, $TypeOrExtern),
 ) -> (
-    connected: bool,
-    visited_path: [dynamic]string,
+    cycles: int,
 ) {
-    append(&visited_path, start)
-    append(&visited_path, dep)
-    connected = compute_cyclic_dependency(start, &visited_path, type, types)
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    arena_alloc := runtime.arena_allocator(&arena)
+
+    count := om.length(types^)
+    if count < 2 do return
+
+    // The dependency graph as adjacency lists stored in one array. The edges of node i are edges[edge_start[i]:edge_start[i + 1]]
+    edge_start := make([]int, count + 1, arena_alloc)
+    edges := make([dynamic]int, arena_alloc)
+    deps := make([dynamic]string, arena_alloc)
+
+    for entry, idx in types.data {
+        edge_start[idx] = len(edges)
+
+        clear(&deps)
+        append_dependencies(&deps, dependency_type(entry.value))
+        for dep in deps {
+            // Dependencies that are not part of types are ignored
+            if dep_idx, ok := om.index(types^, dep); ok {
+                append(&edges, dep_idx)
+            }
+        }
+    }
+    edge_start[count] = len(edges)
+
+    UNVISITED :: -1
+
+    Frame :: struct {
+        node: int,
+        edge: int,
+    }
+
+    visit_index := make([]int, count, arena_alloc)
+    lowlink := make([]int, count, arena_alloc)
+    on_stack := make([]bool, count, arena_alloc)
+    component := make([]int, count, arena_alloc)
+    slice.fill(visit_index, UNVISITED)
+
+    stack := make([dynamic]int, arena_alloc)
+    frames := make([dynamic]Frame, arena_alloc)
+    order := make([dynamic]int, 0, count, arena_alloc)
+    next_index, next_component: int
+
+    // The recursion is unrolled, because the dependency chains can be very long
+    for root in 0 ..< count {
+        if visit_index[root] != UNVISITED do continue
+
+        visit_index[root] = next_index
+        lowlink[root] = next_index
+        next_index += 1
+        append(&stack, root)
+        on_stack[root] = true
+        append(&frames, Frame{node = root, edge = edge_start[root]})
+
+        for len(frames) != 0 {
+            frame := &frames[len(frames) - 1]
+            node := frame.node
+
+            if frame.edge < edge_start[node + 1] {
+                dep := edges[frame.edge]
+                frame.edge += 1
+
+                if visit_index[dep] == UNVISITED {
+                    visit_index[dep] = next_index
+                    lowlink[dep] = next_index
+                    next_index += 1
+                    append(&stack, dep)
+                    on_stack[dep] = true
+                    append(&frames, Frame{node = dep, edge = edge_start[dep]})
+                } else if on_stack[dep] {
+                    lowlink[node] = min(lowlink[node], visit_index[dep])
+                }
+                continue
+            }
+
+            pop(&frames)
+            if len(frames) != 0 {
+                parent := frames[len(frames) - 1].node
+                lowlink[parent] = min(lowlink[parent], lowlink[node])
+            }
+
+            if lowlink[node] != visit_index[node] do continue
+
+            // node is the root of a strongly connected component. All of its dependencies have already been added to order
+            component_start := len(order)
+            for {
+                member := pop(&stack)
+                on_stack[member] = false
+                component[member] = next_component
+                append(&order, member)
+                if member == node do break
+            }
+
+            members := order[component_start:]
+            if len(members) > 1 {
+                cycles += 1
+                slice.sort(members)
+                when TypeOrExtern == Extern || ODIN_DEBUG {
+                    report_dependency_cycles(
+                        types^,
+                        members,
+                        component,
+                        edges[:],
+                        edge_start,
+                        arena_alloc,
+                    )
+                }
+            }
+
+            next_component += 1
+        }
+    }
+
+    sorted_data := slice.clone(types.data[:], arena_alloc)
+    for old_idx, new_idx in order {
+        entry := sorted_data[old_idx]
+        types.data[new_idx] = entry
+        types.indices[entry.key] = new_idx
+    }
+
     return
 }
 
-compute_cyclic_dependency :: proc(
-    start: string,
-    visited_path: ^[dynamic]string,
-    type: Type,
+// Reports every dependency of a cycle that comes after the type depending on it and that is not referenced as a pointer or array
+@(private = "file")
+report_dependency_cycles :: proc(
     types: om.OrderedMap(string, $TypeOrExtern),
-) -> (
-    connected_to_start: bool,
+    members: []int,
+    component: []int,
+    edges: []int,
+    edge_start: []int,
+    allocator: runtime.Allocator,
 ) {
-    deps := compute_dependencies(type)
-    defer delete(deps)
+    for node in members {
+        name := types.data[node].key
+        type := dependency_type(types.data[node].value)
 
-    for dep in deps {
-        if dep == start {
-            connected_to_start = true
-            return
-        } else if !slice.contains(visited_path^[:], dep) {
-            dep_visited: [dynamic]string
-            defer delete(dep_visited)
+        for dep in edges[edge_start[node]:edge_start[node + 1]] {
+            if dep <= node || component[dep] != component[node] do continue
 
-            append(&dep_visited, ..visited_path^[:])
-            append(&dep_visited, dep)
+            dep_name := types.data[dep].key
+            if references_type_as_pointer_or_array(type, dep_name) do continue
 
-            dep_type, ok := om.get(types, dep)
-            assert(ok)
+            path := dependency_path(dep, node, component, edges, edge_start, allocator)
 
-            dep_con_start := compute_cyclic_dependency(
-                start,
-                &dep_visited,
-                Type(dep_type),
-                types,
-            )
+            when TypeOrExtern == Extern {
+                console.eprintln("warning: dependency cycle in externs detected ")
+                console.eprintf("{}->", name)
+                for dp in path {
+                    console.eprintf("{}->", types.data[dp].key)
+                }
+                console.eprintfln("{}", name)
+                console.eprintfln(
+                    "warning: {} will not be moved above {} which depends on it",
+                    dep_name,
+                    name,
+                )
+            } else {
+                console.eprintln("debug: dependency cycle detected ")
+                console.eprintf("{}->", name)
+                for dp in path {
+                    console.eprintf("{}->", types.data[dp].key)
+                }
+                console.eprintfln("{}", name)
+                console.eprintfln(
+                    "debug: {} will not be moved above {} which depends on it",
+                    dep_name,
+                    name,
+                )
+            }
+        }
+    }
+}
 
-            if dep_con_start {
-                append(visited_path, ..dep_visited[len(visited_path):])
-                connected_to_start = true
-                return
+@(private = "file")
+dependency_type :: proc {
+    dependency_type_of_type,
+    dependency_type_of_extern,
+}
+
+@(private = "file")
+dependency_type_of_type :: #force_inline proc(type: Type) -> Type {
+    return type
+}
+
+@(private = "file")
+dependency_type_of_extern :: #force_inline proc(extern: Extern) -> Type {
+    return extern.type
+}
+
+// Returns the shortest path from start to the last node before end staying inside the component of start
+@(private = "file")
+dependency_path :: proc(
+    start, end: int,
+    component: []int,
+    edges: []int,
+    edge_start: []int,
+    allocator: runtime.Allocator,
+) -> []int {
+    prev := make(map[int]int, allocator = allocator)
+    prev[start] = -1
+
+    queue := make([dynamic]int, allocator)
+    append(&queue, start)
+
+    last := start
+    search: for head := 0; head < len(queue); head += 1 {
+        node := queue[head]
+        for dep in edges[edge_start[node]:edge_start[node + 1]] {
+            if dep == end {
+                last = node
+                break search
             }
+            if component[dep] != component[start] || dep in prev do continue
+
+            prev[dep] = node
+            append(&queue, dep)
         }
     }
 
-    return
+    path := make([dynamic]int, allocator)
+    for node := last; node != -1; node = prev[node] {
+        append(&path, node)
+    }
+    slice.reverse(path[:])
+    return path[:]
 }
 
 references_type_as_pointer_or_array :: proc(type: Type, dep: string) -> bool {
@@ -1960,14 +2246,3 @@ trim_enum_type_names :: proc(
         }
     }
 }
-
-@(private = "file")
-odin_tokenizer_peek :: #force_inline proc(
-    tokenizer: ^odintz.Tokenizer,
-) -> (
-    odintz.Token,
-    odintz.Tokenizer,
-) {
-    tokenizer_copy := tokenizer^
-    return odintz.scan(&tokenizer_copy), tokenizer_copy
-}
@@ -0,0 +1,984 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package runic
+
+import "base:runtime"
+import "core:io"
+import "core:mem"
+import "core:mem/virtual"
+import "core:slice"
+import "root:errors"
+import om "root:ordered_map"
+
+// The binary encoding of a runestone. It is read directly from a memory mapping of the file.
+// The file starts with a BinaryHeader followed by the string table and the record tables
+// which are referenced by the header. All integers are little endian.
+// Strings are referenced by their offset and length inside of the string table,
+// so that they can be used without copying them out of the mapping.
+// Types that are referenced by other records (members, parameters etc.) always come before them.
+RUNESTONE_BINARY_MAGIC :: "RUNESTNB"
+// Needs to be increased whenever the layout of the binary encoding changes
+RUNESTONE_BINARY_VERSION :: 1
+
+@(private = "file")
+BINARY_NIL :: max(u32)
+
+@(private = "file")
+BinaryString :: struct #packed {
+    // Offset into the string table. BINARY_NIL if the string is not set
+    offset: u32le,
+    len:    u32le,
+}
+
+@(private = "file")
+BinaryRange :: struct #packed {
+    first: u32le,
+    count: u32le,
+}
+
+@(private = "file")
+BinaryHeader :: struct #packed {
+    magic:      [len(RUNESTONE_BINARY_MAGIC)]u8,
+    // RUNESTONE_BINARY_VERSION
+    version:    u32le,
+    // Version of the runestone itself (Runestone.version)
+    rs_version: u32le,
+    os:         u8,
+    arch:       u8,
+    _:          [2]u8,
+    shared:     BinaryString,
+    static:     BinaryString,
+    // The first of a range is the offset of the table inside of the file
+    strings:    BinaryRange,
+    types:      BinaryRange,
+    members:    BinaryRange,
+    entries:    BinaryRange,
+    arrays:     BinaryRange,
+    functions:  BinaryRange,
+    aliases:    BinaryRange,
+    symbols:    BinaryRange,
+    externs:    BinaryRange,
+    type_defs:  BinaryRange,
+    constants:  BinaryRange,
+}
+
+@(private = "file")
+BinarySpec :: enum u8 {
+    None,
+    Builtin,
+    Struct,
+    Enum,
+    Union,
+    Name,
+    Unknown,
+    FunctionPointer,
+    Extern,
+}
+
+@(private = "file")
+BinaryFlag :: enum u8 {
+    ReadOnly,
+    WriteOnly,
+    PointerReadOnly,
+    PointerWriteOnly,
+}
+
+@(private = "file")
+BinaryFlags :: bit_set[BinaryFlag;u8]
+
+@(private = "file")
+BinaryValue :: enum u8 {
+    None,
+    Int,
+    Float,
+    String,
+}
+
+@(private = "file")
+BinaryType :: struct #packed {
+    spec:          BinarySpec,
+    builtin:       u8,
+    flags:         BinaryFlags,
+    _:             u8,
+    pointer_count: u32le,
+    // Name of a type reference, an unknown or an extern type
+    name:          BinaryString,
+    // Members of structs and unions, entries of enums or the function of a function pointer
+    children:      BinaryRange,
+    arrays:        BinaryRange,
+}
+
+@(private = "file")
+BinaryMember :: struct #packed {
+    name: BinaryString,
+    type: u32le,
+}
+
+@(private = "file")
+BinaryEnumEntry :: struct #packed {
+    name:  BinaryString,
+    kind:  BinaryValue,
+    _:     [3]u8,
+    str:   BinaryString,
+    value: i64le,
+}
+
+@(private = "file")
+BinaryArray :: struct #packed {
+    flags:         BinaryFlags,
+    size_kind:     BinaryValue,
+    _:             [2]u8,
+    pointer_count: u32le,
+    size_str:      BinaryString,
+    size:          u64le,
+}
+
+@(private = "file")
+BinaryFunction :: struct #packed {
+    return_type: u32le,
+    parameters:  BinaryRange,
+    variadic:    b8,
+    has_method:  b8,
+    _:           [2]u8,
+    method_type: BinaryString,
+    method_name: BinaryString,
+}
+
+@(private = "file")
+BinarySymbol :: struct #packed {
+    name:     BinaryString,
+    remap:    BinaryString,
+    function: b8,
+    _:        [3]u8,
+    // Index of the function or the type of the variable
+    value:    u32le,
+    aliases:  BinaryRange,
+}
+
+@(private = "file")
+BinaryExtern :: struct #packed {
+    name:   BinaryString,
+    source: BinaryString,
+    type:   u32le,
+}
+
+@(private = "file")
+BinaryTypeDef :: struct #packed {
+    name: BinaryString,
+    type: u32le,
+}
+
+@(private = "file")
+BinaryConstant :: struct #packed {
+    name:  BinaryString,
+    kind:  BinaryValue,
+    _:     [3]u8,
+    type:  u32le,
+    str:   BinaryString,
+    int:   i64le,
+    float: f64le,
+}
+
+// Returns true if data starts like a runestone in the binary encoding
+is_runestone_binary :: proc(data: []byte) -> bool {
+    return(
+        len(data) >= len(RUNESTONE_BINARY_MAGIC) &&
+        string(data[:len(RUNESTONE_BINARY_MAGIC)]) == RUNESTONE_BINARY_MAGIC \
+    )
+}
+
+// Maps the runestone at file_path into memory and parses it in the binary or text encoding depending on its contents.
+// The strings of the runestone point into the mapping, which is released by runestone_destroy
+load_runestone :: proc(file_path: string) -> (rs: Runestone, err: errors.Error) {
+    data, map_err := virtual.map_file_from_path(file_path, {.Read})
+    if map_err != .None {
+        err = errors.message(
+            "failed to map runestone \"{}\": {}",
+            file_path,
+            map_err,
+        )
+        return
+    }
+
+    if is_runestone_binary(data) {
+        rs, err = parse_runestone_binary(data, file_path)
+    } else {
+        rs, err = parse_runestone_bytes(data, file_path)
+    }
+    rs.mapping = data
+    return
+}
+
+// Parses a runestone in the binary encoding. The strings of the runestone point into data,
+// which therefore needs to outlive it
+parse_runestone_binary :: proc(
+    data: []byte,
+    file_path: string,
+) -> (
+    rs: Runestone,
+    err: errors.Error,
+) {
+    rs_arena_alloc := init_runestone(&rs)
+
+    errors.assert(
+        len(data) >= size_of(BinaryHeader),
+        "binary runestone is too small",
+    ) or_return
+    header := (cast(^BinaryHeader)raw_data(data))^
+
+    errors.assert(
+        is_runestone_binary(data),
+        "binary runestone has an invalid magic",
+    ) or_return
+    if header.version != RUNESTONE_BINARY_VERSION {
+        err = errors.message(
+            "binary runestone version {} is not supported",
+            header.version,
+        )
+        return
+    }
+
+    errors.assert(
+        header.os >= u8(OS_MIN) && header.os <= u8(OS_MAX),
+        "binary runestone has an invalid os",
+    ) or_return
+    errors.assert(
+        header.arch >= u8(Architecture_MIN) &&
+        header.arch <= u8(Architecture_MAX),
+        "binary runestone has an invalid architecture",
+    ) or_return
+
+    rs.version = uint(header.rs_version)
+    rs.platform = {OS(header.os), Architecture(header.arch)}
+
+    rd := BinaryReader {
+        allocator = rs_arena_alloc,
+    }
+    rd.strings = binary_table(data, header.strings, u8) or_return
+    rd.types = binary_table(data, header.types, BinaryType) or_return
+    rd.members = binary_table(data, header.members, BinaryMember) or_return
+    rd.entries = binary_table(data, header.entries, BinaryEnumEntry) or_return
+    rd.arrays = binary_table(data, header.arrays, BinaryArray) or_return
+    rd.functions = binary_table(
+        data,
+        header.functions,
+        BinaryFunction,
+    ) or_return
+    rd.aliases = binary_table(data, header.aliases, BinaryString) or_return
+
+    symbols := binary_table(data, header.symbols, BinarySymbol) or_return
+    externs := binary_table(data, header.externs, BinaryExtern) or_return
+    type_defs := binary_table(data, header.type_defs, BinaryTypeDef) or_return
+    constants := binary_table(
+        data,
+        header.constants,
+        BinaryConstant,
+    ) or_return
+
+    if shared, ok := binary_read_maybe_string(&rd, header.shared) or_return;
+       ok {
+        rs.lib.shared = relative_to_file(
+            file_path,
+            shared,
+            rs_arena_alloc,
+            needs_dir = true,
+        )
+    }
+    if static, ok := binary_read_maybe_string(&rd, header.static) or_return;
+       ok {
+        rs.lib.static = relative_to_file(
+            file_path,
+            static,
+            rs_arena_alloc,
+            needs_dir = true,
+        )
+    }
+    errors.assert(
+        rs.lib.shared != nil || rs.lib.static != nil,
+        "No libraries have been specified",
+    ) or_return
+
+    om.reserve(&rs.symbols, len(symbols))
+    for bsym in symbols {
+        name := binary_read_string(&rd, bsym.name) or_return
+
+        sym: Symbol
+        if remap, ok := binary_read_maybe_string(&rd, bsym.remap) or_return;
+           ok {
+            sym.remap = remap
+        }
+
+        if bsym.function {
+            sym.value = binary_read_function(
+                &rd,
+                bsym.value,
+                len(rd.types),
+            ) or_return
+        } else {
+            sym.value = binary_read_type(
+                &rd,
+                bsym.value,
+                len(rd.types),
+            ) or_return
+        }
+
+        aliases := binary_range(rd.aliases, bsym.aliases) or_return
+        if len(aliases) != 0 {
+            sym.aliases = make(
+                [dynamic]string,
+                len(aliases),
+                rs_arena_alloc,
+            )
+            for alias, idx in aliases {
+                sym.aliases[idx] = binary_read_string(&rd, alias) or_return
+            }
+        }
+
+        om.insert(&rs.symbols, name, sym)
+    }
+
+    om.reserve(&rs.externs, len(externs))
+    for bextern in externs {
+        name := binary_read_string(&rd, bextern.name) or_return
+        source := binary_read_string(&rd, bextern.source) or_return
+        type := binary_read_type(&rd, bextern.type, len(rd.types)) or_return
+        om.insert(&rs.externs, name, Extern{type = type, source = source})
+    }
+
+    om.reserve(&rs.types, len(type_defs))
+    for btype_def in type_defs {
+        name := binary_read_string(&rd, btype_def.name) or_return
+        type := binary_read_type(
+            &rd,
+            btype_def.type,
+            len(rd.types),
+        ) or_return
+        om.insert(&rs.types, name, type)
+    }
+
+    om.reserve(&rs.constants, len(constants))
+    for bconst in constants {
+        name := binary_read_string(&rd, bconst.name) or_return
+
+        c: Constant
+        switch bconst.kind {
+        case .Int:
+            c.value = i64(bconst.int)
+        case .Float:
+            c.value = f64(bconst.float)
+        case .String:
+            c.value = binary_read_string(&rd, bconst.str) or_return
+        case .None:
+            err = errors.message("constant \"{}\" has no value", name)
+            return
+        }
+        c.type = binary_read_type(&rd, bconst.type, len(rd.types)) or_return
+
+        om.insert(&rs.constants, name, c)
+    }
+
+    return
+}
+
+// Writes the runestone in the binary encoding. The paths of the libraries are written relative to file_path
+write_runestone_binary :: proc(
+    rs: Runestone,
+    wd: io.Writer,
+    file_path: string,
+) -> io.Error {
+    arena: runtime.Arena
+    if runtime.arena_init(&arena, 0, context.allocator) != .None {
+        return .Unknown
+    }
+    defer runtime.arena_destroy(&arena)
+    arena_alloc := runtime.arena_allocator(&arena)
+
+    w := BinaryWriter {
+        strings   = make([dynamic]u8, arena_alloc),
+        offsets   = make(map[string]u32, allocator = arena_alloc),
+        types     = make([dynamic]BinaryType, arena_alloc),
+        members   = make([dynamic]BinaryMember, arena_alloc),
+        entries   = make([dynamic]BinaryEnumEntry, arena_alloc),
+        arrays    = make([dynamic]BinaryArray, arena_alloc),
+        functions = make([dynamic]BinaryFunction, arena_alloc),
+        aliases   = make([dynamic]BinaryString, arena_alloc),
+    }
+
+    header := BinaryHeader {
+        version    = RUNESTONE_BINARY_VERSION,
+        rs_version = u32le(rs.version),
+        os         = u8(rs.platform.os),
+        arch       = u8(rs.platform.arch),
+        shared     = {offset = BINARY_NIL},
+        static     = {offset = BINARY_NIL},
+    }
+    copy(header.magic[:], RUNESTONE_BINARY_MAGIC)
+
+    if shared, ok := rs.lib.shared.?; ok {
+        header.shared = binary_write_string(
+            &w,
+            runestone_library_path(file_path, shared, arena_alloc),
+        )
+    }
+    if static, ok := rs.lib.static.?; ok {
+        header.static = binary_write_string(
+            &w,
+            runestone_library_path(file_path, static, arena_alloc),
+        )
+    }
+
+    symbols := make([]BinarySymbol, om.length(rs.symbols), arena_alloc)
+    for entry, idx in rs.symbols.data {
+        bsym := BinarySymbol {
+            name  = binary_write_string(&w, entry.key),
+            remap = {offset = BINARY_NIL},
+        }
+        if remap, ok := entry.value.remap.?; ok {
+            bsym.remap = binary_write_string(&w, remap)
+        }
+
+        switch v in entry.value.value {
+        case Type:
+            bsym.value = binary_write_type(&w, v)
+        case Function:
+            bsym.function = true
+            bsym.value = binary_write_function(&w, v)
+        }
+
+        bsym.aliases.first = u32le(len(w.aliases))
+        bsym.aliases.count = u32le(len(entry.value.aliases))
+        for alias in entry.value.aliases {
+            append(&w.aliases, binary_write_string(&w, alias))
+        }
+
+        symbols[idx] = bsym
+    }
+
+    externs := make([]BinaryExtern, om.length(rs.externs), arena_alloc)
+    for entry, idx in rs.externs.data {
+        externs[idx] = BinaryExtern {
+            name   = binary_write_string(&w, entry.key),
+            source = binary_write_string(&w, entry.value.source),
+            type   = binary_write_type(&w, entry.value.type),
+        }
+    }
+
+    type_defs := make([]BinaryTypeDef, om.length(rs.types), arena_alloc)
+    for entry, idx in rs.types.data {
+        type_defs[idx] = BinaryTypeDef {
+            name = binary_write_string(&w, entry.key),
+            type = binary_write_type(&w, entry.value),
+        }
+    }
+
+    constants := make([]BinaryConstant, om.length(rs.constants), arena_alloc)
+    for entry, idx in rs.constants.data {
+        bconst := BinaryConstant {
+            name = binary_write_string(&w, entry.key),
+            type = binary_write_type(&w, entry.value.type),
+            str  = {offset = BINARY_NIL},
+        }
+
+        switch v in entry.value.value {
+        case i64:
+            bconst.kind = .Int
+            bconst.int = i64le(v)
+        case f64:
+            bconst.kind = .Float
+            bconst.float = f64le(v)
+        case string:
+            bconst.kind = .String
+            bconst.str = binary_write_string(&w, v)
+        }
+
+        constants[idx] = bconst
+    }
+
+    offset := u32le(size_of(BinaryHeader))
+    header.strings, offset = binary_table_range(offset, w.strings[:])
+    header.types, offset = binary_table_range(offset, w.types[:])
+    header.members, offset = binary_table_range(offset, w.members[:])
+    header.entries, offset = binary_table_range(offset, w.entries[:])
+    header.arrays, offset = binary_table_range(offset, w.arrays[:])
+    header.functions, offset = binary_table_range(offset, w.functions[:])
+    header.aliases, offset = binary_table_range(offset, w.aliases[:])
+    header.symbols, offset = binary_table_range(offset, symbols)
+    header.externs, offset = binary_table_range(offset, externs)
+    header.type_defs, offset = binary_table_range(offset, type_defs)
+    header.constants, offset = binary_table_range(offset, constants)
+
+    io.write(wd, mem.ptr_to_bytes(&header)) or_return
+    io.write(wd, w.strings[:]) or_return
+    io.write(wd, slice.to_bytes(w.types[:])) or_return
+    io.write(wd, slice.to_bytes(w.members[:])) or_return
+    io.write(wd, slice.to_bytes(w.entries[:])) or_return
+    io.write(wd, slice.to_bytes(w.arrays[:])) or_return
+    io.write(wd, slice.to_bytes(w.functions[:])) or_return
+    io.write(wd, slice.to_bytes(w.aliases[:])) or_return
+    io.write(wd, slice.to_bytes(symbols)) or_return
+    io.write(wd, slice.to_bytes(externs)) or_return
+    io.write(wd, slice.to_bytes(type_defs)) or_return
+    io.write(wd, slice.to_bytes(constants)) or_return
+
+    return .None
+}
+
+@(private = "file")
+BinaryWriter :: struct {
+    strings:   [dynamic]u8,
+    // Offsets of the strings that have already been written, so that every string is only stored once
+    offsets:   map[string]u32,
+    types:     [dynamic]BinaryType,
+    members:   [dynamic]BinaryMember,
+    entries:   [dynamic]BinaryEnumEntry,
+    arrays:    [dynamic]BinaryArray,
+    functions: [dynamic]BinaryFunction,
+    aliases:   [dynamic]BinaryString,
+}
+
+@(private = "file")
+BinaryReader :: struct {
+    strings:   []u8,
+    types:     []BinaryType,
+    members:   []BinaryMember,
+    entries:   []BinaryEnumEntry,
+    arrays:    []BinaryArray,
+    functions: []BinaryFunction,
+    aliases:   []BinaryString,
+    allocator: runtime.Allocator,
+}
+
+@(private = "file")
+binary_write_string :: proc(w: ^BinaryWriter, str: string) -> BinaryString {
+    if offset, ok := w.offsets[str]; ok {
+        return {offset = u32le(offset), len = u32le(len(str))}
+    }
+
+    offset := u32(len(w.strings))
+    append(&w.strings, str)
+    w.offsets[str] = offset
+    return {offset = u32le(offset), len = u32le(len(str))}
+}
+
+@(private = "file")
+binary_flags :: proc(
+    read_only, write_only: bool,
+    pointer_info: PointerInfo,
+) -> (
+    flags: BinaryFlags,
+) {
+    if read_only do flags += {.ReadOnly}
+    if write_only do flags += {.WriteOnly}
+    if pointer_info.read_only do flags += {.PointerReadOnly}
+    if pointer_info.write_only do flags += {.PointerWriteOnly}
+    return
+}
+
+// Appends the type and all types it refers to and returns its index.
+// The types it refers to are appended first, so that a type only refers to types with lower indices
+@(private = "file")
+binary_write_type :: proc(w: ^BinaryWriter, type: Type) -> u32le {
+    btype := BinaryType {
+        flags         = binary_flags(
+            type.read_only,
+            type.write_only,
+            type.pointer_info,
+        ),
+        pointer_count = u32le(type.pointer_info.count),
+        name          = {offset = BINARY_NIL},
+    }
+
+    switch spec in type.spec {
+    case Builtin:
+        btype.spec = .Builtin
+        btype.builtin = u8(spec)
+    case Struct:
+        btype.spec = .Struct
+        btype.children = binary_write_members(w, spec.members[:])
+    case Union:
+        btype.spec = .Union
+        btype.children = binary_write_members(w, spec.members[:])
+    case Enum:
+        btype.spec = .Enum
+        btype.builtin = u8(spec.type)
+        btype.children.first = u32le(len(w.entries))
+        btype.children.count = u32le(len(spec.entries))
+        for entry in spec.entries {
+            bentry := BinaryEnumEntry {
+                name = binary_write_string(w, entry.name),
+                str  = {offset = BINARY_NIL},
+            }
+            switch v in entry.value {
+            case i64:
+                bentry.kind = .Int
+                bentry.value = i64le(v)
+            case string:
+                bentry.kind = .String
+                bentry.str = binary_write_string(w, v)
+            }
+            append(&w.entries, bentry)
+        }
+    case string:
+        btype.spec = .Name
+        btype.name = binary_write_string(w, spec)
+    case Unknown:
+        btype.spec = .Unknown
+        btype.name = binary_write_string(w, string(spec))
+    case ExternType:
+        btype.spec = .Extern
+        btype.name = binary_write_string(w, string(spec))
+    case FunctionPointer:
+        btype.spec = .FunctionPointer
+        btype.children.first = binary_write_function(w, spec^)
+        btype.children.count = 1
+    }
+
+    btype.arrays.first = u32le(len(w.arrays))
+    btype.arrays.count = u32le(len(type.array_info))
+    for arr in type.array_info {
+        barr := BinaryArray {
+            flags         = binary_flags(
+                arr.read_only,
+                arr.write_only,
+                arr.pointer_info,
+            ),
+            pointer_count = u32le(arr.pointer_info.count),
+            size_str      = {offset = BINARY_NIL},
+        }
+        switch size in arr.size {
+        case u64:
+            barr.size_kind = .Int
+            barr.size = u64le(size)
+        case string:
+            barr.size_kind = .String
+            barr.size_str = binary_write_string(w, size)
+        }
+        append(&w.arrays, barr)
+    }
+
+    append(&w.types, btype)
+    return u32le(len(w.types) - 1)
+}
+
+@(private = "file")
+binary_write_members :: proc(
+    w: ^BinaryWriter,
+    members: []Member,
+) -> BinaryRange {
+    // The types are written before the members, since they may contain members themselves
+    types := make([]u32le, len(members), context.temp_allocator)
+    for member, idx in members {
+        types[idx] = binary_write_type(w, member.type)
+    }
+
+    first := u32le(len(w.members))
+    for member, idx in members {
+        append(
+            &w.members,
+            BinaryMember {
+                name = binary_write_string(w, member.name),
+                type = types[idx],
+            },
+        )
+    }
+    return {first = first, count = u32le(len(members))}
+}
+
+@(private = "file")
+binary_write_function :: proc(w: ^BinaryWriter, func: Function) -> u32le {
+    bfunc := BinaryFunction {
+        return_type = binary_write_type(w, func.return_type),
+        parameters  = binary_write_members(w, func.parameters[:]),
+        variadic    = b8(func.variadic),
+        method_type = {offset = BINARY_NIL},
+        method_name = {offset = BINARY_NIL},
+    }
+    if mi, ok := func.method_info.?; ok {
+        bfunc.has_method = true
+        bfunc.method_type = binary_write_string(w, mi.type)
+        bfunc.method_name = binary_write_string(w, mi.name)
+    }
+
+    append(&w.functions, bfunc)
+    return u32le(len(w.functions) - 1)
+}
+
+@(private = "file")
+binary_table_range :: proc(
+    offset: u32le,
+    table: []$T,
+) -> (
+    range: BinaryRange,
+    next_offset: u32le,
+) {
+    range = {
+        first = offset,
+        count = u32le(len(table)),
+    }
+    next_offset = offset + u32le(len(table) * size_of(T))
+    return
+}
+
+// Returns the table of range inside of data without copying it
+@(private = "file")
+binary_table :: proc(
+    data: []byte,
+    range: BinaryRange,
+    $T: typeid,
+) -> (
+    table: []T,
+    err: errors.Error,
+) {
+    first, count := int(range.first), int(range.count)
+    errors.assert(
+        first <= len(data) && count <= (len(data) - first) / size_of(T),
+        "binary runestone table is out of bounds",
+    ) or_return
+    if count == 0 do return
+
+    table = ([^]T)(raw_data(data[first:]))[:count]
+    return
+}
+
+@(private = "file")
+binary_range :: proc(
+    table: []$T,
+    range: BinaryRange,
+) -> (
+    sub: []T,
+    err: errors.Error,
+) {
+    first, count := int(range.first), int(range.count)
+    errors.assert(
+        first <= len(table) && count <= len(table) - first,
+        "binary runestone range is out of bounds",
+    ) or_return
+    sub = table[first:][:count]
+    return
+}
+
+@(private = "file")
+binary_read_string :: proc(
+    rd: ^BinaryReader,
+    bstr: BinaryString,
+) -> (
+    str: string,
+    err: errors.Error,
+) {
+    str_bytes := binary_range(
+        rd.strings,
+        {first = bstr.offset, count = bstr.len},
+    ) or_return
+    str = string(str_bytes)
+    return
+}
+
+@(private = "file")
+binary_read_maybe_string :: proc(
+    rd: ^BinaryReader,
+    bstr: BinaryString,
+) -> (
+    str: string,
+    ok: bool,
+    err: errors.Error,
+) {
+    if bstr.offset == BINARY_NIL do return
+    str = binary_read_string(rd, bstr) or_return
+    ok = true
+    return
+}
+
+// Reads the type at index idx. Every type may only refer to types with a lower index than limit,
+// so that a corrupt runestone can not create cycles
+@(private = "file")
+binary_read_type :: proc(
+    rd: ^BinaryReader,
+    idx: u32le,
+    limit: int,
+) -> (
+    type: Type,
+    err: errors.Error,
+) {
+    errors.assert(
+        int(idx) < limit && int(idx) < len(rd.types),
+        "binary runestone type is out of bounds",
+    ) or_return
+    btype := rd.types[idx]
+
+    type.read_only = .ReadOnly in btype.flags
+    type.write_only = .WriteOnly in btype.flags
+    type.pointer_info = {
+        count      = uint(btype.pointer_count),
+        read_only  = .PointerReadOnly in btype.flags,
+        write_only = .PointerWriteOnly in btype.flags,
+    }
+
+    switch btype.spec {
+    case .None:
+    case .Builtin:
+        errors.assert(
+            btype.builtin <= u8(max(Builtin)),
+            "binary runestone has an invalid builtin",
+        ) or_return
+        type.spec = Builtin(btype.builtin)
+    case .Struct:
+        type.spec = Struct {
+            members = binary_read_members(
+                rd,
+                btype.children,
+                int(idx),
+            ) or_return,
+        }
+    case .Union:
+        type.spec = Union {
+            members = binary_read_members(
+                rd,
+                btype.children,
+                int(idx),
+            ) or_return,
+        }
+    case .Enum:
+        errors.assert(
+            btype.builtin <= u8(max(Builtin)),
+            "binary runestone has an invalid builtin",
+        ) or_return
+
+        bentries := binary_range(rd.entries, btype.children) or_return
+        entries := make([dynamic]EnumEntry, len(bentries), rd.allocator)
+        for bentry, entry_idx in bentries {
+            entries[entry_idx].name = binary_read_string(
+                rd,
+                bentry.name,
+            ) or_return
+            switch bentry.kind {
+            case .Int:
+                entries[entry_idx].value = i64(bentry.value)
+            case .String:
+                entries[entry_idx].value = binary_read_string(
+                    rd,
+                    bentry.str,
+                ) or_return
+            case .None, .Float:
+            }
+        }
+
+        type.spec = Enum {
+            type    = Builtin(btype.builtin),
+            entries = entries,
+        }
+    case .Name:
+        type.spec = binary_read_string(rd, btype.name) or_return
+    case .Unknown:
+        type.spec = Unknown(binary_read_string(rd, btype.name) or_return)
+    case .Extern:
+        type.spec = ExternType(binary_read_string(rd, btype.name) or_return)
+    case .FunctionPointer:
+        func := binary_read_function(
+            rd,
+            btype.children.first,
+            int(idx),
+        ) or_return
+        type.spec = cast(FunctionPointer)new_clone(func, rd.allocator)
+    case:
+        err = errors.message("binary runestone has an invalid type specifier")
+        return
+    }
+
+    barrays := binary_range(rd.arrays, btype.arrays) or_return
+    if len(barrays) != 0 {
+        type.array_info = make([dynamic]Array, len(barrays), rd.allocator)
+        for barr, arr_idx in barrays {
+            arr := &type.array_info[arr_idx]
+            arr.read_only = .ReadOnly in barr.flags
+            arr.write_only = .WriteOnly in barr.flags
+            arr.pointer_info = {
+                count      = uint(barr.pointer_count),
+                read_only  = .PointerReadOnly in barr.flags,
+                write_only = .PointerWriteOnly in barr.flags,
+            }
+
+            switch barr.size_kind {
+            case .Int:
+                arr.size = u64(barr.size)
+            case .String:
+                arr.size = binary_read_string(rd, barr.size_str) or_return
+            case .None, .Float:
+            }
+        }
+    }
+
+    return
+}
+
+@(private = "file")
+binary_read_members :: proc(
+    rd: ^BinaryReader,
+    range: BinaryRange,
+    limit: int,
+) -> (
+    members: [dynamic]Member,
+    err: errors.Error,
+) {
+    bmembers := binary_range(rd.members, range) or_return
+    members = make([dynamic]Member, len(bmembers), rd.allocator)
+    for bmember, idx in bmembers {
+        members[idx] = Member {
+            name = binary_read_string(rd, bmember.name) or_return,
+            type = binary_read_type(rd, bmember.type, limit) or_return,
+        }
+    }
+    return
+}
+
+// Reads the function at index idx. Its types may only refer to types with a lower index than limit
+@(private = "file")
+binary_read_function :: proc(
+    rd: ^BinaryReader,
+    idx: u32le,
+    limit: int,
+) -> (
+    func: Function,
+    err: errors.Error,
+) {
+    errors.assert(
+        int(idx) < len(rd.functions),
+        "binary runestone function is out of bounds",
+    ) or_return
+    bfunc := rd.functions[idx]
+
+    func.return_type = binary_read_type(
+        rd,
+        bfunc.return_type,
+        limit,
+    ) or_return
+    func.parameters = binary_read_members(
+        rd,
+        bfunc.parameters,
+        limit,
+    ) or_return
+    func.variadic = bool(bfunc.variadic)
+
+    if bfunc.has_method {
+        func.method_info = MethodInfo {
+            type = binary_read_string(rd, bfunc.method_type) or_return,
+            name = binary_read_string(rd, bfunc.method_name) or_return,
+        }
+    }
+
+    return
+}
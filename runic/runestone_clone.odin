@@ -0,0 +1,166 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package runic
+
+import om "root:ordered_map"
+
+// Returns a copy of rs whose types, symbols, externs and constants can be modified without
+// changing rs. Strings are shared with rs, so rs needs to outlive the clone.
+runestone_clone :: proc(
+    rs: Runestone,
+    backing_allocator := context.allocator,
+) -> (
+    clone: Runestone,
+) {
+    rs_arena_alloc := init_runestone(&clone, backing_allocator)
+
+    clone.version = rs.version
+    clone.platform = rs.platform
+    clone.lib = rs.lib
+
+    om.reserve(&clone.symbols, om.length(rs.symbols))
+    for entry in rs.symbols.data {
+        om.insert(
+            &clone.symbols,
+            entry.key,
+            symbol_clone(entry.value, rs_arena_alloc),
+        )
+    }
+
+    om.reserve(&clone.externs, om.length(rs.externs))
+    for entry in rs.externs.data {
+        om.insert(
+            &clone.externs,
+            entry.key,
+            Extern {
+                type = type_clone(entry.value.type, rs_arena_alloc),
+                source = entry.value.source,
+            },
+        )
+    }
+
+    om.reserve(&clone.types, om.length(rs.types))
+    for entry in rs.types.data {
+        om.insert(
+            &clone.types,
+            entry.key,
+            type_clone(entry.value, rs_arena_alloc),
+        )
+    }
+
+    om.reserve(&clone.constants, om.length(rs.constants))
+    for entry in rs.constants.data {
+        om.insert(
+            &clone.constants,
+            entry.key,
+            Constant {
+                value = entry.value.value,
+                type = type_clone(entry.value.type, rs_arena_alloc),
+            },
+        )
+    }
+
+    return
+}
+
+type_clone :: proc(type: Type, allocator := context.allocator) -> Type {
+    clone := type
+
+    if len(type.array_info) != 0 {
+        clone.array_info = make(
+            [dynamic]Array,
+            len(type.array_info),
+            allocator,
+        )
+        copy(clone.array_info[:], type.array_info[:])
+    } else {
+        clone.array_info = nil
+    }
+
+    #partial switch spec in type.spec {
+    case Struct:
+        clone.spec = Struct {
+            members = members_clone(spec.members, allocator),
+        }
+    case Union:
+        clone.spec = Union {
+            members = members_clone(spec.members, allocator),
+        }
+    case Enum:
+        entries := make([dynamic]EnumEntry, len(spec.entries), allocator)
+        copy(entries[:], spec.entries[:])
+        clone.spec = Enum {
+            type    = spec.type,
+            entries = entries,
+        }
+    case FunctionPointer:
+        clone.spec = cast(FunctionPointer)new_clone(
+            function_clone(spec^, allocator),
+            allocator,
+        )
+    }
+
+    return clone
+}
+
+function_clone :: proc(
+    func: Function,
+    allocator := context.allocator,
+) -> Function {
+    return Function {
+        return_type = type_clone(func.return_type, allocator),
+        parameters = members_clone(func.parameters, allocator),
+        variadic = func.variadic,
+        method_info = func.method_info,
+    }
+}
+
+symbol_clone :: proc(sym: Symbol, allocator := context.allocator) -> Symbol {
+    clone := Symbol {
+        remap = sym.remap,
+    }
+
+    switch value in sym.value {
+    case Type:
+        clone.value = type_clone(value, allocator)
+    case Function:
+        clone.value = function_clone(value, allocator)
+    }
+
+    if len(sym.aliases) != 0 {
+        clone.aliases = make([dynamic]string, len(sym.aliases), allocator)
+        copy(clone.aliases[:], sym.aliases[:])
+    }
+
+    return clone
+}
+
+@(private = "file")
+members_clone :: proc(
+    members: [dynamic]Member,
+    allocator := context.allocator,
+) -> [dynamic]Member {
+    clone := make([dynamic]Member, len(members), allocator)
+    for member, idx in members {
+        clone[idx] = Member {
+            name = member.name,
+            type = type_clone(member.type, allocator),
+        }
+    }
+    return clone
+}
@@ -18,6 +18,7 @@ along with runic.  If not, see <http://www.gnu.org/licenses/>.
 
 package runic
 
+import "base:runtime"
 import "core:fmt"
 import "core:io"
 import "core:os"
@@ -207,122 +208,78 @@ test_example_runestone :: proc(t: ^testing.T) {
 test_cyclic_dependency :: proc(t: ^testing.T) {
     using testing
 
-    types := om.OrderedMap(string, Type) {
-        indices = {
-            "little_foo" = 0,
-            "big_foo" = 1,
-            "cycle_0" = 2,
-            "cycle_1" = 3,
-            "cycle_2" = 4,
-            "cycle_3" = 5,
-            "struct_cycle_0" = 6,
-            "random_thing" = 7,
-            "random_int" = 8,
-            "struct_cycle_1" = 9,
-            "struct_cycle_2" = 10,
-        },
-        data = {
-            {key = "little_foo", value = {spec = string("big_foo")}},
-            {key = "big_foo", value = {spec = string("little_foo")}},
-            {key = "cycle_0", value = {spec = string("cycle_1")}},
-            {key = "cycle_1", value = {spec = string("cycle_2")}},
-            {key = "cycle_2", value = {spec = string("cycle_3")}},
-            {key = "cycle_3", value = {spec = string("cycle_0")}},
-            {
-                key = "struct_cycle_0",
-                value = {
-                    spec = Struct {
-                        members = {
-                            {type = {spec = string("random_thing")}},
-                            {type = {spec = string("struct_cycle_1")}},
-                        },
-                    },
-                },
-            },
-            {
-                key = "random_thing",
-                value = {
-                    spec = Struct {
-                        members = {{type = {spec = string("random_int")}}},
-                    },
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    context.allocator = runtime.arena_allocator(&arena)
+
+    types := om.make(string, Type)
+
+    om.insert(&types, "little_foo", Type{spec = string("big_foo")})
+    om.insert(&types, "big_foo", Type{spec = string("little_foo")})
+    om.insert(&types, "cycle_0", Type{spec = string("cycle_1")})
+    om.insert(&types, "cycle_1", Type{spec = string("cycle_2")})
+    om.insert(&types, "cycle_2", Type{spec = string("cycle_3")})
+    om.insert(&types, "cycle_3", Type{spec = string("cycle_0")})
+    om.insert(
+        &types,
+        "struct_cycle_0",
+        Type {
+            spec = Struct {
+                members = {
+                    {type = {spec = string("random_thing")}},
+                    {type = {spec = string("struct_cycle_1")}},
                 },
             },
-            {key = "random_int", value = {spec = Builtin.SInt32}},
-            {
-                key = "struct_cycle_1",
-                value = {spec = string("struct_cycle_2")},
-            },
-            {
-                key = "struct_cycle_2",
-                value = {
-                    spec = Struct {
-                        members = {
-                            {type = {spec = string("struct_cycle_1")}},
-                            {type = {spec = string("struct_cycle_0")}},
-                        },
-                    },
+        },
+    )
+    om.insert(
+        &types,
+        "random_thing",
+        Type {
+            spec = Struct{members = {{type = {spec = string("random_int")}}}},
+        },
+    )
+    om.insert(&types, "random_int", Type{spec = Builtin.SInt32})
+    om.insert(
+        &types,
+        "struct_cycle_1",
+        Type{spec = string("struct_cycle_2")},
+    )
+    om.insert(
+        &types,
+        "struct_cycle_2",
+        Type {
+            spec = Struct {
+                members = {
+                    {type = {spec = string("struct_cycle_1")}},
+                    {type = {spec = string("struct_cycle_0")}},
                 },
             },
         },
-    }
-    defer delete(types.indices)
-    defer delete(types.data)
-    defer for &entry in types.data {
-        #partial switch &spec in entry.value.spec {
-        case Struct:
-            delete(spec.members)
-        }
-    }
-
-    connected, visited_path := start_compute_cyclic_dependency(
-        "little_foo",
-        "big_foo",
-        om.get(types, "big_foo"),
-        types,
     )
 
-    expect(t, connected)
-    if expect_value(t, len(visited_path), 2) {
-        expect_value(t, visited_path[0], "little_foo")
-        expect_value(t, visited_path[1], "big_foo")
-    }
-
-    delete(visited_path)
+    expect_value(t, sort_by_dependencies(&types), 3)
 
-    connected, visited_path = start_compute_cyclic_dependency(
+    // The types of a cycle stay together in their original order
+    expected := [?]string {
+        "little_foo",
+        "big_foo",
         "cycle_0",
         "cycle_1",
-        om.get(types, "cycle_1"),
-        types,
-    )
-
-    expect(t, connected)
-    if expect_value(t, len(visited_path), 4) {
-        expect_value(t, visited_path[0], "cycle_0")
-        expect_value(t, visited_path[1], "cycle_1")
-        expect_value(t, visited_path[2], "cycle_2")
-        expect_value(t, visited_path[3], "cycle_3")
-    } else {
-        fmt.printfln("visited_path: {}", visited_path)
-    }
-
-    delete(visited_path)
-
-    connected, visited_path = start_compute_cyclic_dependency(
+        "cycle_2",
+        "cycle_3",
+        "random_int",
+        "random_thing",
         "struct_cycle_0",
         "struct_cycle_1",
-        om.get(types, "struct_cycle_1"),
-        types,
-    )
-
-    expect(t, connected)
-    if expect_value(t, len(visited_path), 3) {
-        expect_value(t, visited_path[0], "struct_cycle_0")
-        expect_value(t, visited_path[1], "struct_cycle_1")
-        expect_value(t, visited_path[2], "struct_cycle_2")
+        "struct_cycle_2",
     }
+    if !expect_value(t, om.length(types), len(expected)) do return
 
-    delete(visited_path)
+    for name, idx in expected {
+        expect_value(t, types.data[idx].key, name)
+        expect_value(t, om.index(types, name), idx)
+    }
 
     pointer_type := Type {
         spec = string("pointed"),
@@ -335,11 +292,54 @@ test_cyclic_dependency :: proc(t: ^testing.T) {
         spec       = string("arrayed"),
         array_info = {{size = 5}},
     }
-    defer delete(array_type.array_info)
 
     expect(t, references_type_as_pointer_or_array(array_type, "arrayed"))
 }
 
+@(test)
+test_sort_by_dependencies :: proc(t: ^testing.T) {
+    using testing
+
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    context.allocator = runtime.arena_allocator(&arena)
+
+    types := om.make(string, Type)
+
+    om.insert(&types, "a", Type{spec = string("b")})
+    om.insert(&types, "c", Type{spec = Builtin.SInt32})
+    om.insert(
+        &types,
+        "b",
+        Type {
+            spec = Struct {
+                members = {
+                    {name = "d", type = {spec = string("d")}},
+                    {name = "e", type = {spec = string("e")}},
+                },
+            },
+        },
+    )
+    om.insert(&types, "d", Type{spec = Builtin.Float32})
+    om.insert(
+        &types,
+        "cycle_0",
+        Type{spec = string("cycle_1"), pointer_info = {count = 1}},
+    )
+    om.insert(&types, "cycle_1", Type{spec = string("cycle_0")})
+    om.insert(&types, "e", Type{spec = string("unknown")})
+
+    expect_value(t, sort_by_dependencies(&types), 1)
+
+    expected := [?]string{"d", "e", "b", "a", "c", "cycle_0", "cycle_1"}
+    if !expect_value(t, om.length(types), len(expected)) do return
+
+    for name, idx in expected {
+        expect_value(t, types.data[idx].key, name)
+        expect_value(t, om.index(types, name), idx)
+    }
+}
+
 @(test)
 test_trim_enum_type_names :: proc(t: ^testing.T) {
     using testing
@@ -414,3 +414,164 @@ test_trim_enum_type_names :: proc(t: ^testing.T) {
         expect_value(t, e.entries[3].name, "right")
     }
 }
+
+@(test)
+test_runestone_clone :: proc(t: ^testing.T) {
+    using testing
+
+    rd: strings.Reader
+    strings.reader_init(&rd, string(EXAMPLE_RUNESTONE))
+
+    rs, err := parse_runestone(strings.reader_to_stream(&rd), "/example")
+    defer runestone_destroy(&rs)
+    if !expect_value(t, err, nil) do return
+
+    clone := runestone_clone(rs)
+    defer runestone_destroy(&clone)
+
+    expect_value(t, clone.platform, rs.platform)
+    expect_value(t, om.length(clone.symbols), om.length(rs.symbols))
+    expect_value(t, om.length(clone.externs), om.length(rs.externs))
+    expect_value(t, om.length(clone.types), om.length(rs.types))
+    expect_value(t, om.length(clone.constants), om.length(rs.constants))
+
+    for entry, idx in rs.types.data {
+        expect_value(t, clone.types.data[idx].key, entry.key)
+        expect(t, is_same(clone.types.data[idx].value, entry.value))
+    }
+
+    members := om.get(clone.types, "output").spec.(Struct).members
+    members[0].name = "z"
+    entries := om.get(clone.types, "output_flags").spec.(Enum).entries
+    entries[0].name = "VISIBLE"
+
+    expect_value(
+        t,
+        om.get(rs.types, "output").spec.(Struct).members[0].name,
+        "x",
+    )
+    expect_value(
+        t,
+        om.get(rs.types, "output_flags").spec.(Enum).entries[0].name,
+        "SHOWN",
+    )
+}
+
+@(test)
+test_runestone_binary :: proc(t: ^testing.T) {
+    using testing
+
+    rd: strings.Reader
+    strings.reader_init(&rd, string(EXAMPLE_RUNESTONE))
+
+    rs, err := parse_runestone(strings.reader_to_stream(&rd), "/example")
+    defer runestone_destroy(&rs)
+    if !expect_value(t, err, nil) do return
+
+    binary: strings.Builder
+    strings.builder_init(&binary)
+    defer strings.builder_destroy(&binary)
+
+    io_err := write_runestone_binary(
+        rs,
+        strings.to_writer(&binary),
+        "/example",
+    )
+    if !expect_value(t, io_err, io.Error.None) do return
+    expect(t, is_runestone_binary(binary.buf[:]))
+
+    rs_bin: Runestone = ---
+    rs_bin, err = parse_runestone_binary(binary.buf[:], "/example")
+    defer runestone_destroy(&rs_bin)
+    if !expect_value(t, err, nil) do return
+
+    text, text_bin: strings.Builder
+    strings.builder_init(&text)
+    strings.builder_init(&text_bin)
+    defer strings.builder_destroy(&text)
+    defer strings.builder_destroy(&text_bin)
+
+    write_runestone(rs, strings.to_writer(&text), "/example")
+    write_runestone(rs_bin, strings.to_writer(&text_bin), "/example")
+
+    expect_value(t, strings.to_string(text_bin), strings.to_string(text))
+
+    _, err = parse_runestone_binary(binary.buf[:64], "/example")
+    expect(t, err != nil)
+}
+
+@(test)
+test_runestone_long_line :: proc(t: ^testing.T) {
+    using testing
+
+    MEMBER_COUNT :: 1000
+
+    contents: strings.Builder
+    strings.builder_init(&contents)
+    defer strings.builder_destroy(&contents)
+
+    strings.write_string(
+        &contents,
+        "version = 0\nos = Linux\narch = x86_64\n[lib]\nshared = libfoo.so\n[remap]\nfoo = foo_impl\n[symbols]\nfunc.foo_impl = #Untyped\n[types]\nbig = #Struct",
+    )
+    for idx in 0 ..< MEMBER_COUNT {
+        fmt.sbprintf(&contents, " member{} #SInt32", idx)
+    }
+    strings.write_rune(&contents, '\n')
+
+    rd: strings.Reader
+    strings.reader_init(&rd, strings.to_string(contents))
+
+    rs, err := parse_runestone(strings.reader_to_stream(&rd), "/long_line")
+    defer runestone_destroy(&rs)
+    if !expect_value(t, err, nil) do return
+
+    big := om.get(rs.types, "big")
+    members := big.spec.(Struct).members
+    if !expect_value(t, len(members), MEMBER_COUNT) do return
+    expect_value(t, members[MEMBER_COUNT - 1].name, "member999")
+
+    foo, ok := om.get(rs.symbols, "foo")
+    if !expect(t, ok) do return
+    expect_value(t, foo.remap.?, "foo_impl")
+}
+
+@(test)
+test_type_cache :: proc(t: ^testing.T) {
+    using testing
+
+    arena: runtime.Arena
+    defer runtime.arena_destroy(&arena)
+    context.allocator = runtime.arena_allocator(&arena)
+
+    cache := TypeCache {
+        types = make(map[string]Type),
+    }
+
+    DEF :: "#UInt8 #Attr Ptr 1 Arr 4 #AttrEnd"
+
+    type1, err := parse_type(DEF, &cache)
+    if !expect_value(t, err, nil) do return
+    expect_value(t, len(cache.types), 1)
+
+    type2: Type = ---
+    type2, err = parse_type(DEF, &cache)
+    if !expect_value(t, err, nil) do return
+    expect(t, is_same(type1, type2))
+
+    type2.array_info[0].size = u64(8)
+    expect_value(t, type1.array_info[0].size.(u64), 4)
+
+    func: Function = ---
+    func, err = parse_func("#SInt32 a " + DEF + " b size_t", &cache)
+    if !expect_value(t, err, nil) do return
+    expect_value(t, len(cache.types), 3)
+    expect_value(t, len(func.parameters), 2)
+    expect(t, is_same(func.parameters[0].type, type1))
+    expect_value(t, func.parameters[1].type.spec.(string), "size_t")
+
+    c: Constant = ---
+    c, err = parse_constant("-5 #SInt32", &cache)
+    if !expect_value(t, err, nil) do return
+    expect_value(t, c.value.(i64), -5)
+}
@@ -29,6 +29,8 @@ Runestone :: struct {
     types:     om.OrderedMap(string, Type),
     constants: om.OrderedMap(string, Constant),
     arena:     runtime.Arena,
+    // The memory mapped file of a loaded runestone into which the strings point
+    mapping:   []byte,
 }
 
 Builtin :: enum {
@@ -0,0 +1,184 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+package runic
+
+// Structural hashes of types, symbols and constants. Two values that are the same according to is_same
+// always have the same hash, so comparing the hashes first rules out most values that differ without
+// walking them. Equal hashes still need to be confirmed by is_same.
+
+@(private = "file")
+FNV64_OFFSET_BASIS :: u64(0xcbf29ce484222325)
+@(private = "file")
+FNV64_PRIME :: u64(0x100000001b3)
+
+structural_hash_type :: proc(type: Type) -> u64 {
+    h := FNV64_OFFSET_BASIS
+    hash_write_type(&h, type)
+    return h
+}
+
+structural_hash_symbol :: proc(symbol: Symbol) -> u64 {
+    h := FNV64_OFFSET_BASIS
+
+    remap, has_remap := symbol.remap.?
+    hash_write_bool(&h, has_remap)
+    if has_remap do hash_write_string(&h, remap)
+
+    switch value in symbol.value {
+    case Type:
+        hash_write_u64(&h, 1)
+        hash_write_type(&h, value)
+    case Function:
+        hash_write_u64(&h, 2)
+        hash_write_function(&h, value)
+    }
+
+    return h
+}
+
+structural_hash_constant :: proc(constant: Constant) -> u64 {
+    h := FNV64_OFFSET_BASIS
+
+    switch value in constant.value {
+    case i64:
+        hash_write_u64(&h, 1)
+        hash_write_u64(&h, u64(value))
+    case f64:
+        hash_write_u64(&h, 2)
+        // 0.0 and -0.0 compare as equal
+        hash_write_u64(&h, 0 if value == 0 else transmute(u64)value)
+    case string:
+        hash_write_u64(&h, 3)
+        hash_write_string(&h, value)
+    }
+
+    hash_write_type(&h, constant.type)
+    return h
+}
+
+structural_hash :: proc {
+    structural_hash_type,
+    structural_hash_symbol,
+    structural_hash_constant,
+}
+
+@(private = "file")
+hash_write_bytes :: #force_inline proc(h: ^u64, data: []byte) {
+    for b in data {
+        h^ = (h^ ~ u64(b)) * FNV64_PRIME
+    }
+}
+
+@(private = "file")
+hash_write_u64 :: #force_inline proc(h: ^u64, value: u64) {
+    bytes := transmute([8]byte)value
+    hash_write_bytes(h, bytes[:])
+}
+
+@(private = "file")
+hash_write_bool :: #force_inline proc(h: ^u64, value: bool) {
+    hash_write_u64(h, 1 if value else 0)
+}
+
+@(private = "file")
+hash_write_string :: #force_inline proc(h: ^u64, value: string) {
+    hash_write_u64(h, u64(len(value)))
+    hash_write_bytes(h, transmute([]byte)value)
+}
+
+@(private = "file")
+hash_write_pointer_info :: proc(h: ^u64, pointer_info: PointerInfo) {
+    hash_write_u64(h, u64(pointer_info.count))
+    hash_write_bool(h, pointer_info.read_only)
+    hash_write_bool(h, pointer_info.write_only)
+}
+
+@(private = "file")
+hash_write_members :: proc(h: ^u64, members: [dynamic]Member) {
+    hash_write_u64(h, u64(len(members)))
+    for member in members {
+        hash_write_string(h, member.name)
+        hash_write_type(h, member.type)
+    }
+}
+
+@(private = "file")
+hash_write_function :: proc(h: ^u64, function: Function) {
+    hash_write_type(h, function.return_type)
+    hash_write_members(h, function.parameters)
+    hash_write_bool(h, function.variadic)
+}
+
+@(private = "file")
+hash_write_type :: proc(h: ^u64, type: Type) {
+    switch spec in type.spec {
+    case Builtin:
+        hash_write_u64(h, 1)
+        hash_write_u64(h, u64(spec))
+    case Struct:
+        hash_write_u64(h, 2)
+        hash_write_members(h, spec.members)
+    case Enum:
+        hash_write_u64(h, 3)
+        hash_write_u64(h, u64(spec.type))
+        hash_write_u64(h, u64(len(spec.entries)))
+        for entry in spec.entries {
+            hash_write_string(h, entry.name)
+            switch value in entry.value {
+            case i64:
+                hash_write_u64(h, u64(value))
+            case string:
+                hash_write_string(h, value)
+            }
+        }
+    case Union:
+        hash_write_u64(h, 4)
+        hash_write_members(h, spec.members)
+    case string:
+        hash_write_u64(h, 5)
+        hash_write_string(h, spec)
+    case Unknown:
+        // All unknown types are the same
+        hash_write_u64(h, 6)
+    case FunctionPointer:
+        hash_write_u64(h, 7)
+        if spec != nil do hash_write_function(h, spec^)
+    case ExternType:
+        hash_write_u64(h, 8)
+        hash_write_string(h, string(spec))
+    }
+
+    hash_write_bool(h, type.read_only)
+    hash_write_bool(h, type.write_only)
+    hash_write_pointer_info(h, type.pointer_info)
+
+    hash_write_u64(h, u64(len(type.array_info)))
+    for arr in type.array_info {
+        hash_write_pointer_info(h, arr.pointer_info)
+        hash_write_bool(h, arr.read_only)
+        hash_write_bool(h, arr.write_only)
+
+        switch size in arr.size {
+        case u64:
+            hash_write_u64(h, 1)
+            hash_write_u64(h, size)
+        case string:
+            hash_write_u64(h, 2)
+            hash_write_string(h, size)
+        }
+    }
+}
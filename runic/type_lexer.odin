@@ -0,0 +1,268 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package runic
+
+import "core:strings"
+import "core:unicode"
+import "core:unicode/utf8"
+
+// Lexer for the type, function and constant definitions of runestones
+
+@(private)
+TypeTokenKind :: enum u8 {
+    EOF,
+    Invalid,
+    Hash,
+    Ident,
+    Integer,
+    Float,
+    String,
+}
+
+@(private)
+TypeToken :: struct {
+    kind: TypeTokenKind,
+    text: string,
+}
+
+@(private)
+TypeLexer :: struct {
+    src:    string,
+    offset: int,
+    // If set, simple types are looked up in and added to the cache
+    cache:  ^TypeCache,
+}
+
+// Caches simple types (builtins and type names with their attributes) by their definition.
+// Since the same definitions are repeated all over a runestone, most of them only need to be parsed once.
+// The cache is only valid as long as the definitions it has been filled with
+@(private)
+TypeCache :: struct {
+    types: map[string]Type,
+}
+
+@(private)
+type_lexer_init :: proc(lx: ^TypeLexer, src: string, cache: ^TypeCache = nil) {
+    lx^ = TypeLexer {
+        src   = src,
+        cache = cache,
+    }
+}
+
+@(private)
+type_lexer_scan :: proc(lx: ^TypeLexer) -> (token: TypeToken) {
+    type_lexer_skip_space(lx)
+    if lx.offset >= len(lx.src) do return
+
+    start := lx.offset
+    c := lx.src[start]
+
+    if c == '#' {
+        lx.offset += 1
+        token.kind = .Hash
+    } else if c == '"' || c == '`' {
+        lx.offset += 1
+        for lx.offset < len(lx.src) && lx.src[lx.offset] != c {
+            if c == '"' && lx.src[lx.offset] == '\\' do lx.offset += 1
+            lx.offset += 1
+        }
+
+        if lx.offset >= len(lx.src) {
+            lx.offset = len(lx.src)
+            token.kind = .Invalid
+        } else {
+            lx.offset += 1
+            token.kind = .String
+        }
+    } else if is_decimal(c) ||
+       (c == '-' && start + 1 < len(lx.src) && is_decimal(lx.src[start + 1])) {
+        token.kind = type_lexer_number(lx)
+    } else if is_ident_start(c) {
+        token.kind = .Ident
+        for lx.offset < len(lx.src) {
+            b := lx.src[lx.offset]
+            if b < utf8.RUNE_SELF {
+                if !is_ident_start(b) && !is_decimal(b) do break
+                lx.offset += 1
+                continue
+            }
+
+            r, size := utf8.decode_rune_in_string(lx.src[lx.offset:])
+            if !unicode.is_letter(r) && !unicode.is_digit(r) do break
+            lx.offset += size
+        }
+
+        if lx.offset == start {
+            _, size := utf8.decode_rune_in_string(lx.src[start:])
+            lx.offset += size
+            token.kind = .Invalid
+        }
+    } else {
+        lx.offset += 1
+        token.kind = .Invalid
+    }
+
+    token.text = lx.src[start:lx.offset]
+    return
+}
+
+// Returns the next token without advancing lx
+@(private)
+type_lexer_peek :: #force_inline proc(
+    lx: ^TypeLexer,
+) -> (
+    TypeToken,
+    TypeLexer,
+) {
+    lx_copy := lx^
+    return type_lexer_scan(&lx_copy), lx_copy
+}
+
+// Returns the bounds of the simple type (builtin, type name, unknown or extern with attributes) starting at lx.
+// ok is false if the type is not simple (struct, enum, union, function pointer or invalid)
+@(private)
+type_lexer_simple_type :: proc(
+    lx: TypeLexer,
+) -> (
+    start, end: int,
+    ok: bool,
+) {
+    lx := lx
+
+    type_lexer_skip_space(&lx)
+    start = lx.offset
+
+    token := type_lexer_scan(&lx)
+    #partial switch token.kind {
+    case .Ident:
+    case .Hash:
+        token = type_lexer_scan(&lx)
+        if token.kind != .Ident do return
+
+        switch token.text {
+        case "Struct", "Enum", "Union", "FuncPtr":
+            return
+        case "Unknown", "Extern":
+            if token = type_lexer_scan(&lx); token.kind != .Ident do return
+        }
+    case:
+        return
+    }
+
+    end = lx.offset
+    ok = true
+
+    type_lexer_skip_space(&lx)
+    ATTR :: "#Attr"
+    ATTR_END :: "#AttrEnd"
+    if !strings.has_prefix(lx.src[lx.offset:], ATTR) do return
+    if strings.has_prefix(lx.src[lx.offset:], ATTR_END) do return
+
+    attr_end := strings.index(lx.src[lx.offset:], ATTR_END)
+    if attr_end == -1 {
+        ok = false
+        return
+    }
+
+    end = lx.offset + attr_end + len(ATTR_END)
+    return
+}
+
+@(private = "file")
+type_lexer_skip_space :: #force_inline proc(lx: ^TypeLexer) {
+    for lx.offset < len(lx.src) {
+        switch lx.src[lx.offset] {
+        case ' ', '\t', '\r', '\n':
+            lx.offset += 1
+        case:
+            return
+        }
+    }
+}
+
+@(private = "file")
+is_decimal :: #force_inline proc(c: u8) -> bool {
+    return '0' <= c && c <= '9'
+}
+
+@(private = "file")
+is_ident_start :: #force_inline proc(c: u8) -> bool {
+    return(
+        c == '_' ||
+        ('a' <= c && c <= 'z') ||
+        ('A' <= c && c <= 'Z') ||
+        c >= utf8.RUNE_SELF \
+    )
+}
+
+@(private = "file")
+type_lexer_number :: proc(lx: ^TypeLexer) -> TypeTokenKind {
+    is_digit :: #force_inline proc(c: u8) -> bool {
+        return is_decimal(c) || c == '_'
+    }
+
+    if lx.src[lx.offset] == '-' do lx.offset += 1
+
+    // Integers with a base prefix (0x, 0b, 0o, 0z)
+    if lx.offset + 1 < len(lx.src) && lx.src[lx.offset] == '0' {
+        switch lx.src[lx.offset + 1] {
+        case 'x', 'b', 'o', 'z':
+            lx.offset += 2
+            for lx.offset < len(lx.src) {
+                c := lx.src[lx.offset]
+                if !is_digit(c) &&
+                   !('a' <= c && c <= 'f') &&
+                   !('A' <= c && c <= 'F') {
+                    break
+                }
+                lx.offset += 1
+            }
+            return .Integer
+        }
+    }
+
+    kind := TypeTokenKind.Integer
+    for lx.offset < len(lx.src) && is_digit(lx.src[lx.offset]) {
+        lx.offset += 1
+    }
+
+    if lx.offset + 1 < len(lx.src) &&
+       lx.src[lx.offset] == '.' &&
+       is_digit(lx.src[lx.offset + 1]) {
+        kind = .Float
+        lx.offset += 1
+        for lx.offset < len(lx.src) && is_digit(lx.src[lx.offset]) {
+            lx.offset += 1
+        }
+    }
+
+    if lx.offset < len(lx.src) &&
+       (lx.src[lx.offset] == 'e' || lx.src[lx.offset] == 'E') {
+        kind = .Float
+        lx.offset += 1
+        if lx.offset < len(lx.src) &&
+           (lx.src[lx.offset] == '+' || lx.src[lx.offset] == '-') {
+            lx.offset += 1
+        }
+        for lx.offset < len(lx.src) && is_digit(lx.src[lx.offset]) {
+            lx.offset += 1
+        }
+    }
+
+    return kind
+}
@@ -0,0 +1,35 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#+build linux, darwin, freebsd, openbsd, netbsd
+package stats
+
+import "core:sys/posix"
+
+// Returns the peak resident set size of the process in bytes
+@(private)
+peak_rss :: proc() -> uint {
+    usage: posix.rusage
+    if posix.getrusage(.SELF, &usage) != .OK do return 0
+
+    when ODIN_OS == .Darwin {
+        return uint(usage.ru_maxrss)
+    } else {
+        // The other systems report kilobytes
+        return uint(usage.ru_maxrss) * 1024
+    }
+}
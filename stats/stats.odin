@@ -0,0 +1,240 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// Collects memory and size statistics of the runestones throughout the phases of runic.
+// Unlike the memory reports under ODIN_DEBUG it is also available in release builds.
+package stats
+
+import "base:runtime"
+import "core:encoding/json"
+import "core:fmt"
+import "core:io"
+import "core:os"
+import "core:slice"
+import "core:strings"
+import "core:sync"
+import "root:errors"
+import "root:runic"
+
+Entry :: struct {
+    phase:          string,
+    platform:       string,
+    arena_used:     uint,
+    arena_capacity: uint,
+    types:          int,
+    symbols:        int,
+    constants:      int,
+    externs:        int,
+}
+
+Report :: struct {
+    entries:         []Entry,
+    // Number of cursors visited by libclang per platform
+    cursors_visited: map[string]int,
+    peak_rss:        uint,
+}
+
+@(private)
+State :: struct {
+    enabled: bool,
+    mutex:   sync.Mutex,
+    arena:   runtime.Arena,
+    entries: [dynamic]Entry,
+    cursors: map[string]int,
+}
+
+@(private)
+state: State
+
+// Starts collecting statistics. Needs to be called before any threads are started
+enable :: proc() {
+    arena_alloc := runtime.arena_allocator(&state.arena)
+    state.enabled = true
+    state.entries = make([dynamic]Entry, arena_alloc)
+    state.cursors = make(map[string]int, allocator = arena_alloc)
+}
+
+enabled :: #force_inline proc "contextless" () -> bool {
+    return state.enabled
+}
+
+record_runestone :: proc(phase: string, rs: runic.Runestone) {
+    if !state.enabled do return
+
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    append(
+        &state.entries,
+        Entry {
+            phase = phase,
+            platform = platform_name(rs.platform),
+            arena_used = rs.arena.total_used,
+            arena_capacity = rs.arena.total_capacity,
+            types = len(rs.types.data),
+            symbols = len(rs.symbols.data),
+            constants = len(rs.constants.data),
+            externs = len(rs.externs.data),
+        },
+    )
+}
+
+// Records the arena of the runecross and every runestone of it
+record_runecross :: proc(phase: string, rc: runic.Runecross) {
+    if !state.enabled do return
+
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    append(
+        &state.entries,
+        Entry {
+            phase = phase,
+            platform = "runecross",
+            arena_used = rc.arena.total_used,
+            arena_capacity = rc.arena.total_capacity,
+        },
+    )
+
+    arena_alloc := runtime.arena_allocator(&state.arena)
+    for stone in rc.cross {
+        plat_names := make([]string, len(stone.plats), arena_alloc)
+        for plat, idx in stone.plats {
+            plat_names[idx] = platform_name(plat)
+        }
+
+        append(
+            &state.entries,
+            Entry {
+                phase = phase,
+                platform = strings.join(plat_names, " ", arena_alloc),
+                arena_used = stone.arena.total_used,
+                arena_capacity = stone.arena.total_capacity,
+                types = len(stone.types.data),
+                symbols = len(stone.symbols.data),
+                constants = len(stone.constants.data),
+                externs = len(stone.externs.data),
+            },
+        )
+    }
+}
+
+add_cursors_visited :: proc(plat: runic.Platform, count: int) {
+    if !state.enabled do return
+
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    name := platform_name(plat)
+    state.cursors[name] = state.cursors[name] + count
+}
+
+// Returns all statistics recorded so far. The report is valid until destroy is called
+report :: proc() -> Report {
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    return Report {
+        entries = state.entries[:],
+        cursors_visited = state.cursors,
+        peak_rss = peak_rss(),
+    }
+}
+
+// Prints the statistics as a human readable table
+print :: proc(wd: io.Writer) {
+    r := report()
+
+    fmt.wprintfln(
+        wd,
+        "{:-20s} {:-20s} {:>12s} {:>12s} {:>8s} {:>8s} {:>9s} {:>8s}",
+        "phase",
+        "platform",
+        "arena used",
+        "arena cap",
+        "types",
+        "symbols",
+        "constants",
+        "externs",
+    )
+    for e in r.entries {
+        fmt.wprintfln(
+            wd,
+            "{:-20s} {:-20s} {:>12d} {:>12d} {:>8d} {:>8d} {:>9d} {:>8d}",
+            e.phase,
+            e.platform,
+            e.arena_used,
+            e.arena_capacity,
+            e.types,
+            e.symbols,
+            e.constants,
+            e.externs,
+        )
+    }
+
+    // Sorted, so that the platforms are always printed in the same order
+    plats, _ := slice.map_keys(r.cursors_visited, context.temp_allocator)
+    slice.sort(plats)
+    for plat in plats {
+        fmt.wprintfln(
+            wd,
+            "cursors visited {}: {}",
+            plat,
+            r.cursors_visited[plat],
+        )
+    }
+
+    if r.peak_rss != 0 {
+        fmt.wprintfln(wd, "peak rss: {}B", r.peak_rss)
+    }
+}
+
+// Writes the statistics as JSON into file_path
+write_json :: proc(file_path: string) -> errors.Error {
+    data, marshal_err := json.marshal(
+        report(),
+        {
+            pretty = true,
+            use_spaces = true,
+            spaces = 2,
+            sort_maps_by_key = true,
+        },
+    )
+    if marshal_err != nil {
+        return errors.message("failed to marshal stats: {}", marshal_err)
+    }
+    defer delete(data)
+
+    return runic.write_file_atomic(file_path, data)
+}
+
+destroy :: proc() {
+    state.enabled = false
+    state.entries = nil
+    state.cursors = nil
+    runtime.arena_destroy(&state.arena)
+}
+
+@(private)
+platform_name :: proc(plat: runic.Platform) -> string {
+    return fmt.aprintf(
+        "{}.{}",
+        plat.os,
+        plat.arch,
+        allocator = runtime.arena_allocator(&state.arena),
+    )
+}
@@ -0,0 +1,62 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package stats
+
+import "core:testing"
+import om "root:ordered_map"
+import "root:runic"
+
+@(test)
+test_stats :: proc(t: ^testing.T) {
+    using testing
+
+    rs: runic.Runestone
+    runic.init_runestone(&rs)
+    defer runic.runestone_destroy(&rs)
+    rs.platform = {.Linux, .x86_64}
+
+    om.insert(&rs.types, "foo", runic.Type{spec = runic.Builtin.SInt32})
+    om.insert(
+        &rs.constants,
+        "BAR",
+        runic.Constant{value = i64(5), type = {spec = runic.Builtin.SInt64}},
+    )
+
+    // Nothing is recorded before enable
+    record_runestone("generate", rs)
+    expect_value(t, len(report().entries), 0)
+
+    enable()
+    defer destroy()
+
+    record_runestone("generate", rs)
+    add_cursors_visited(rs.platform, 3)
+    add_cursors_visited(rs.platform, 2)
+
+    r := report()
+    if !expect_value(t, len(r.entries), 1) do return
+
+    e := r.entries[0]
+    expect_value(t, e.phase, "generate")
+    expect_value(t, e.platform, "Linux.x86_64")
+    expect_value(t, e.types, 1)
+    expect_value(t, e.constants, 1)
+    expect_value(t, e.symbols, 0)
+    expect(t, e.arena_used <= e.arena_capacity)
+    expect_value(t, r.cursors_visited["Linux.x86_64"], 5)
+}
@@ -6,6 +6,9 @@
 #define B 2
 #define C 3
 
+#define SHIFTED (1 << A + B)
+#define UNSIGNED 10u
+
 #ifdef __linux__
 #define ODIN_LINUX
 #elif defined(_WIN32)
@@ -0,0 +1,173 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+// Records the time spent in the different phases of runic as spans and writes them
+// as Chrome trace_event JSON (viewable in chrome://tracing or https://ui.perfetto.dev).
+// If tracing has not been enabled a span costs one branch. Building with -define:RUNIC_TRACE=false
+// removes all spans at compile time.
+package trace
+
+import "base:runtime"
+import "core:encoding/json"
+import "core:fmt"
+import "core:os"
+import "core:strings"
+import "core:sync"
+import "core:time"
+import "root:errors"
+
+RUNIC_TRACE :: #config(RUNIC_TRACE, true)
+
+Span :: struct {
+    name:   string,
+    detail: string,
+    start:  time.Tick,
+}
+
+@(private)
+Event :: struct {
+    name: string,
+    cat:  string,
+    ph:   string,
+    ts:   f64,
+    dur:  f64,
+    pid:  int,
+    tid:  int,
+    args: struct {
+        detail: string,
+    },
+}
+
+@(private)
+State :: struct {
+    enabled: bool,
+    start:   time.Tick,
+    mutex:   sync.Mutex,
+    arena:   runtime.Arena,
+    events:  [dynamic]Event,
+}
+
+@(private)
+state: State
+
+// Starts recording spans. Needs to be called before any threads are started
+enable :: proc() {
+    when RUNIC_TRACE {
+        state.enabled = true
+        state.start = time.tick_now()
+        state.events = make(
+            [dynamic]Event,
+            runtime.arena_allocator(&state.arena),
+        )
+    }
+}
+
+enabled :: #force_inline proc "contextless" () -> bool {
+    when RUNIC_TRACE {
+        return state.enabled
+    } else {
+        return false
+    }
+}
+
+// Records a span from now until the end of the scope of the caller. args are formatted into the detail of the span
+@(deferred_out = end)
+scope :: proc(name: string, args: ..any) -> (span: Span) {
+    when RUNIC_TRACE {
+        if !state.enabled do return
+        span = begin(name, ..args)
+    }
+    return
+}
+
+begin :: proc(name: string, args: ..any) -> (span: Span) {
+    when RUNIC_TRACE {
+        if !state.enabled do return
+
+        span.name = name
+        if len(args) != 0 {
+            span.detail = fmt.aprint(..args, sep = "")
+        }
+        span.start = time.tick_now()
+    }
+    return
+}
+
+end :: #force_inline proc(span: Span) {
+    when RUNIC_TRACE {
+        if !state.enabled || len(span.name) == 0 do return
+        record(span, time.tick_now())
+    }
+}
+
+// Writes all recorded spans as Chrome trace_event JSON into file_path
+write :: proc(file_path: string) -> errors.Error {
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    Trace :: struct {
+        traceEvents:     []Event,
+        displayTimeUnit: string,
+    }
+
+    data, marshal_err := json.marshal(
+        Trace{traceEvents = state.events[:], displayTimeUnit = "ms"},
+    )
+    if marshal_err != nil {
+        return errors.message("failed to marshal trace: {}", marshal_err)
+    }
+    defer delete(data)
+
+    if !os.write_entire_file(file_path, data) {
+        return errors.message("failed to write trace \"{}\"", file_path)
+    }
+
+    return nil
+}
+
+destroy :: proc() {
+    state.enabled = false
+    runtime.arena_destroy(&state.arena)
+    state.events = nil
+}
+
+@(private)
+record :: proc(span: Span, end_tick: time.Tick) {
+    sync.mutex_lock(&state.mutex)
+    defer sync.mutex_unlock(&state.mutex)
+
+    arena_alloc := runtime.arena_allocator(&state.arena)
+
+    ts := time.tick_diff(state.start, span.start)
+    dur := time.tick_diff(span.start, end_tick)
+
+    event := Event {
+        name = span.name,
+        cat  = "runic",
+        ph   = "X",
+        ts   = time.duration_microseconds(ts),
+        dur  = time.duration_microseconds(dur),
+        pid  = 1,
+        tid  = sync.current_thread_id(),
+    }
+    if len(span.detail) != 0 {
+        event.args.detail = strings.clone(span.detail, arena_alloc)
+        delete(span.detail)
+    }
+
+    append(&state.events, event)
+}
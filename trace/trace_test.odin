@@ -0,0 +1,74 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package trace
+
+import "core:encoding/json"
+import "core:os"
+import "core:testing"
+
+@(test)
+test_trace :: proc(t: ^testing.T) {
+    using testing
+
+    TRACE_PATH :: "test_data/trace_test.json"
+    defer os.remove(TRACE_PATH)
+
+    {
+        // Spans are not recorded before tracing is enabled
+        scope("disabled")
+    }
+
+    enable()
+    defer destroy()
+
+    {
+        scope("outer", "linux", ".", "x86_64")
+        span := begin("inner")
+        end(span)
+    }
+
+    if !expect_value(t, write(TRACE_PATH), nil) do return
+
+    data, ok := os.read_entire_file(TRACE_PATH)
+    if !expect(t, ok) do return
+    defer delete(data)
+
+    Trace :: struct {
+        traceEvents: []Event,
+    }
+    tr: Trace
+    if !expect_value(t, json.unmarshal(data, &tr), nil) do return
+    defer {
+        for ev in tr.traceEvents {
+            delete(ev.name)
+            delete(ev.cat)
+            delete(ev.ph)
+            delete(ev.args.detail)
+        }
+        delete(tr.traceEvents)
+    }
+
+    if !expect_value(t, len(tr.traceEvents), 2) do return
+
+    // Spans are recorded when they end
+    expect_value(t, tr.traceEvents[0].name, "inner")
+    expect_value(t, tr.traceEvents[1].name, "outer")
+    expect_value(t, tr.traceEvents[1].args.detail, "linux.x86_64")
+    expect_value(t, tr.traceEvents[1].ph, "X")
+    expect(t, tr.traceEvents[1].dur >= tr.traceEvents[0].dur)
+}
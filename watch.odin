@@ -0,0 +1,389 @@
+/*
+This file is part of runic.
+
+Runic is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License version 2
+as published by the Free Software Foundation.
+
+Runic is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with runic.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+package main
+
+import "base:runtime"
+import "core:fmt"
+import "core:os"
+import "core:slice"
+import "core:strings"
+import "core:time"
+import cppcdg "cpp/codegen"
+import "runic"
+
+WATCH_INTERVAL :: 500 * time.Millisecond
+
+@(private = "file")
+WatchPlatform :: struct {
+    parser:       cppcdg.Parser,
+    // Set if parser_init succeeded. Otherwise it is retried whenever a watched file changes
+    initialized:  bool,
+    // Set if the last generation failed. It is retried whenever a watched file changes
+    failed:       bool,
+    deps_arena:   runtime.Arena,
+    dependencies: []string,
+    // The postprocessed runestone of the last successful generation
+    runestone:    runic.Runestone,
+    // The text encoding of runestone, used to check whether it changed
+    snapshot:     string,
+}
+
+@(private = "file")
+Watcher :: struct {
+    arena: runtime.Arena,
+    files: map[string]os.File_Time,
+}
+
+// Regenerates the outputs of the rune whenever the rune or one of the files it depends on changes.
+// For c headers the libclang state of every platform is kept alive, so that only the platforms
+// which include a changed file are reparsed. The outputs are only rewritten if a runestone changed.
+// Wrappers are not generated in watch mode.
+watch :: proc(rune_file_name: string, jobs: int) -> ! {
+    fmt.eprintfln("Watching \"{}\" ...", rune_file_name)
+
+    for {
+        watch_rune(rune_file_name, jobs)
+        free_all(context.temp_allocator)
+
+        fmt.eprintfln("Reloading \"{}\" ...", rune_file_name)
+    }
+}
+
+// Regenerates the outputs until the rune file changes
+@(private = "file")
+watch_rune :: proc(rune_file_name: string, jobs: int) {
+    w: Watcher
+    defer watcher_destroy(&w)
+    watcher_add(&w, rune_file_name)
+
+    rune, rune_ok := load_rune(rune_file_name)
+    defer runic.rune_destroy(&rune)
+    if !rune_ok {
+        for {
+            changed := watcher_wait(&w)
+            if slice.contains(changed, rune_file_name) do return
+        }
+    }
+
+    plats := rune_platforms(rune, rune_arena_allocator(&rune))
+
+    from, from_ok := rune.from.(runic.From)
+    is_c := false
+    if from_ok {
+        switch strings.to_lower(from.language, context.temp_allocator) {
+        case "c", "cpp", "cxx", "c++":
+            is_c = true
+        }
+    }
+
+    if !is_c {
+        watch_runestones(&w, rune, rune_file_name, plats, jobs)
+        return
+    }
+
+    platforms := make([]WatchPlatform, len(plats))
+    defer delete(platforms)
+    defer for &wp in platforms {
+        cppcdg.parser_destroy(&wp.parser)
+        runtime.arena_destroy(&wp.deps_arena)
+        if len(wp.snapshot) != 0 do runic.runestone_destroy(&wp.runestone)
+        delete(wp.snapshot)
+    }
+
+    for plat in plats {
+        // The headers are watched from the start, so that a platform whose headers
+        // could not be parsed is generated again as soon as they are fixed
+        headers := runic.platform_value_get([]string, from.headers, plat)
+        for header in headers {
+            watcher_add(&w, header)
+        }
+    }
+
+    dirty := make([]bool, len(platforms))
+    defer delete(dirty)
+    slice.fill(dirty, true)
+
+    generate_jobs := make([dynamic]GenerateJob)
+    defer delete(generate_jobs)
+
+    for {
+        clear(&generate_jobs)
+        for &wp, idx in platforms {
+            if !dirty[idx] do continue
+            if !wp.initialized {
+                wp.initialized = init_watch_platform(
+                    &wp,
+                    plats[idx],
+                    rune_file_name,
+                    from,
+                )
+                if !wp.initialized do continue
+            }
+
+            append(
+                &generate_jobs,
+                GenerateJob {
+                    plat = plats[idx],
+                    rune_file_name = rune_file_name,
+                    from = from,
+                    parser = &wp.parser,
+                },
+            )
+        }
+
+        run_generate_jobs(generate_jobs[:], jobs)
+
+        any_changed := false
+        for &job in generate_jobs {
+            idx, _ := slice.linear_search(plats, job.plat)
+            wp := &platforms[idx]
+
+            wp.failed = job.err != nil
+            if job.err == nil {
+                snapshot := runestone_snapshot(job.rs, rune_file_name)
+                if snapshot != wp.snapshot {
+                    if len(wp.snapshot) != 0 {
+                        runic.runestone_destroy(&wp.runestone)
+                    }
+                    delete(wp.snapshot)
+                    wp.runestone = job.rs
+                    wp.snapshot = snapshot
+                    any_changed = true
+                } else {
+                    delete(snapshot)
+                    runic.runestone_destroy(&job.rs)
+                }
+            }
+
+            runtime.arena_free_all(&wp.deps_arena)
+            wp.dependencies = cppcdg.parser_dependencies(
+                &wp.parser,
+                runtime.arena_allocator(&wp.deps_arena),
+            )
+            for dep in wp.dependencies {
+                watcher_add(&w, dep)
+            }
+        }
+
+        if any_changed {
+            write_snapshots(rune, rune_file_name, platforms, jobs)
+        } else {
+            fmt.eprintln("Runestones did not change")
+        }
+
+        free_all(context.temp_allocator)
+        slice.fill(dirty, false)
+
+        for {
+            changed := watcher_wait(&w)
+            if slice.contains(changed, rune_file_name) do return
+
+            for &wp, idx in platforms {
+                // It is not known which files a failed platform depends on
+                if !wp.initialized || wp.failed {
+                    dirty[idx] = true
+                    continue
+                }
+
+                for file_name in changed {
+                    if slice.contains(wp.dependencies, file_name) {
+                        dirty[idx] = true
+                        break
+                    }
+                }
+            }
+
+            if slice.contains(dirty, true) do break
+        }
+    }
+}
+
+// Initializes the parser of the platform and prints if it failed
+@(private = "file")
+init_watch_platform :: proc(
+    wp: ^WatchPlatform,
+    plat: runic.Platform,
+    rune_file_name: string,
+    from: runic.From,
+) -> bool {
+    err := cppcdg.parser_init(&wp.parser, plat, rune_file_name, from)
+    if err == nil do return true
+
+    fmt.eprintfln(
+        "\"{}\" Runestone {}.{} Failed: {}",
+        from.language,
+        plat.os,
+        plat.arch,
+        err,
+    )
+    // The parser may have been initialized partially
+    cppcdg.parser_destroy(&wp.parser)
+    wp.parser = {}
+    return false
+}
+
+// Loads the runestones of rune and writes the outputs every time the rune or the input runestones change.
+// Used for everything that is not generated from c headers
+@(private = "file")
+watch_runestones :: proc(
+    w: ^Watcher,
+    rune: runic.Rune,
+    rune_file_name: string,
+    plats: []runic.Platform,
+    jobs: int,
+) {
+    switch from in rune.from {
+    case runic.From:
+    case string:
+        if from != "stdin" {
+            watcher_add(
+                w,
+                runic.relative_to_file(
+                    rune_file_name,
+                    from,
+                    context.temp_allocator,
+                ),
+            )
+        }
+    case [dynamic]string:
+        for file_path in from {
+            watcher_add(
+                w,
+                runic.relative_to_file(
+                    rune_file_name,
+                    file_path,
+                    context.temp_allocator,
+                ),
+            )
+        }
+    }
+
+    for {
+        runestones := make([dynamic]runic.Runestone, context.temp_allocator)
+        file_paths := make([dynamic]string, context.temp_allocator)
+
+        if load_runestones(
+            rune,
+            rune_file_name,
+            plats,
+            jobs,
+            nil,
+            &runestones,
+            &file_paths,
+        ) {
+            write_outputs(
+                rune,
+                rune_file_name,
+                runestones[:],
+                file_paths[:],
+                jobs,
+            )
+        }
+
+        for &rs in runestones {
+            runic.runestone_destroy(&rs)
+        }
+        free_all(context.temp_allocator)
+
+        changed := watcher_wait(w)
+        if slice.contains(changed, rune_file_name) do return
+    }
+}
+
+// The outputs are written from clones of the runestones, since preprocessing and crossing the runes modifies them
+@(private = "file")
+write_snapshots :: proc(
+    rune: runic.Rune,
+    rune_file_name: string,
+    platforms: []WatchPlatform,
+    jobs: int,
+) {
+    runestones := make([dynamic]runic.Runestone, context.temp_allocator)
+    file_paths := make([dynamic]string, context.temp_allocator)
+    defer for &rs in runestones {
+        runic.runestone_destroy(&rs)
+    }
+
+    for wp in platforms {
+        // The platform never succeeded to generate
+        if len(wp.snapshot) == 0 do continue
+
+        append(&runestones, runic.runestone_clone(wp.runestone))
+        append(&file_paths, "")
+    }
+
+    if len(runestones) == 0 do return
+
+    write_outputs(rune, rune_file_name, runestones[:], file_paths[:], jobs)
+}
+
+@(private = "file")
+runestone_snapshot :: proc(
+    rs: runic.Runestone,
+    rune_file_name: string,
+    allocator := context.allocator,
+) -> string {
+    snapshot: strings.Builder
+    strings.builder_init(&snapshot, allocator)
+    runic.write_runestone(rs, strings.to_writer(&snapshot), rune_file_name)
+    return strings.to_string(snapshot)
+}
+
+@(private = "file")
+rune_arena_allocator :: proc(rune: ^runic.Rune) -> runtime.Allocator {
+    return runtime.arena_allocator(&rune.arena)
+}
+
+@(private = "file")
+watcher_add :: proc(w: ^Watcher, file_name: string) {
+    if file_name in w.files do return
+
+    mod_time, _ := os.last_write_time_by_name(file_name)
+    w.files[strings.clone(file_name, runtime.arena_allocator(&w.arena))] =
+        mod_time
+}
+
+// Blocks until at least one of the watched files changed and returns all changed files
+@(private = "file")
+watcher_wait :: proc(w: ^Watcher) -> []string {
+    changed := make([dynamic]string, context.temp_allocator)
+
+    for len(changed) == 0 {
+        time.sleep(WATCH_INTERVAL)
+
+        for file_name, &mod_time in w.files {
+            new_mod_time, _ := os.last_write_time_by_name(file_name)
+            if new_mod_time != mod_time {
+                mod_time = new_mod_time
+                append(&changed, file_name)
+            }
+        }
+    }
+
+    for file_name in changed {
+        fmt.eprintfln("\"{}\" changed", file_name)
+    }
+
+    return changed[:]
+}
+
+@(private = "file")
+watcher_destroy :: proc(w: ^Watcher) {
+    delete(w.files)
+    runtime.arena_destroy(&w.arena)
+}